@@ -1,11 +1,18 @@
 import zerorpc
 import numpy as np
 import time
+from streaming import StateSubscriber, PoseSender
 
 class FrankaClient:
-    def __init__(self, server_ip='localhost', port=4242, connection_timeout=5.0, heartbeat_timeout=20):
+    def __init__(self, server_ip='localhost', port=4242, connection_timeout=5.0, heartbeat_timeout=20,
+                 state_port=4243, pose_port=4244, pose_ack_port=4245):
         self.server_ip = server_ip
         self.port = port
+        self.state_port = state_port
+        self.state_subscriber = None
+        self.pose_port = pose_port
+        self.pose_ack_port = pose_ack_port
+        self.pose_sender = None
         self.connection_timeout = connection_timeout
         self.heartbeat_timeout = heartbeat_timeout
         self.server = None
@@ -57,10 +64,48 @@ class FrankaClient:
     def update_desired_ee_pose(self, pose: np.ndarray):
         self._safe_call('update_desired_ee_pose', pose.tolist())
 
+    def update_desired_ee_pose_oneway(self, pose: np.ndarray, stamp=None):
+        """
+        Non-blocking pose update over the one-way pose stream. Returns the target's
+        sequence number; the server applies only the newest target it has received.
+        `stamp` is the time the pose was sampled (used by server-side upsampling).
+        """
+        if self.pose_sender is None:
+            ack_endpoint = f"tcp://{self.server_ip}:{self.pose_ack_port}" if self.pose_ack_port else None
+            self.pose_sender = PoseSender(f"tcp://{self.server_ip}:{self.pose_port}", ack_endpoint)
+        return self.pose_sender.send(pose, stamp)
+
+    def pose_stream_ack(self, timeout=0.0):
+        """Latest pose stream ack from the server (None until one arrives or if acks are disabled)."""
+        if self.pose_sender is None:
+            return None
+        return self.pose_sender.ack(timeout)
+
+    def get_latency_summary(self):
+        return self._safe_call('get_latency_summary')
+
+    def export_latency_trace(self, path):
+        return self._safe_call('export_latency_trace', path)
+
     def terminate_current_policy(self):
         self._safe_call('terminate_current_policy')
 
+    def subscribe_state(self):
+        """
+        Subscribe to the server's state stream. The returned subscriber's latest()
+        yields the newest published sample without issuing any RPC.
+        """
+        if self.state_subscriber is None:
+            self.state_subscriber = StateSubscriber(f"tcp://{self.server_ip}:{self.state_port}")
+        return self.state_subscriber
+
     def close(self):
+        if self.state_subscriber:
+            self.state_subscriber.close()
+            self.state_subscriber = None
+        if self.pose_sender is not None:
+            self.pose_sender.close()
+            self.pose_sender = None
         if self.server:
             try:
                 self.server.close()
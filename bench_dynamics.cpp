@@ -0,0 +1,320 @@
+// Validation and benchmark for panda_dynamics.h. The checks compare the RNEA and CRBA results
+// against fixed reference values (gravity, torques and mass matrix at a few configurations from
+// dynamics_reference.py, an independent model built from franka_description's joint origins),
+// and for consistency: the mass matrix against RNEA columns, gravity against the
+// Jacobian-transpose of the link weights, the power balance dq . tau = d(T + V)/dt along a
+// trajectory, and every batch lane against the scalar code. Then evaluations/s are measured for
+// scalar and batched RNEA and CRBA. The exit status is non-zero if a check fails.
+// Build with build_dance.sh, run: ./bench_dynamics [evaluations]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "panda_dynamics.h"
+#include "panda_kinematics.h"
+
+namespace {
+
+using Joints = panda::JointVector<double>;
+
+std::vector<Joints> randomStates(std::size_t n, double scale, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<Joints> states(n);
+    for (Joints& state : states) {
+        for (std::size_t i = 0; i < 7; i++) {
+            double low = scale > 0.0 ? -scale : panda::kJointPositionMin[i];
+            double high = scale > 0.0 ? scale : panda::kJointPositionMax[i];
+            state[i] = std::uniform_real_distribution<double>(low, high)(rng);
+        }
+    }
+    return states;
+}
+
+// Reference gravity g(q), torques tau(q, kReferenceVelocity, kReferenceAcceleration) and mass
+// matrix (row-major) at fixed configurations
+struct Reference {
+    Joints q;
+    Joints gravity;
+    Joints tau;
+    std::array<double, 49> mass;
+};
+
+constexpr Joints kReferenceVelocity{{0.6, -0.8, 1.0, 0.5, -1.2, 1.5, -2.0}};
+constexpr Joints kReferenceAcceleration{{2.0, -1.5, 3.0, -2.5, 4.0, -3.5, 5.0}};
+
+const Reference kReference[] = {
+    // Generated by dynamics_reference.py
+    {{{0, -0.7853981634, 0, -2.35619449, 0, 1.570796327, 0.7853981634}},
+     {{0, -3.918472926, -0.6798068197, 21.90308595, 0.6844842234, 2.273241092, 8.073291637e-19}},
+     {{3.405930091, -7.355301046, 3.803309828, 20.11012857, 1.201881214, 1.558238521, -0.01067760846}},
+     {{0.528535786, -0.02373027068, 0.4818297756, 0.001292530173, 0.05275036947, 0.0009567638797, -0.007455822245,
+       -0.02373027068, 1.550039562, -0.01966207448, -0.6934234643, -0.0135965679, -0.04200573882, 0.001556605451,
+       0.4818297756, -0.01966207448, 0.982096895, -0.01568356997, 0.04636934648, 0.0003316634579, -0.005859005401,
+       0.001292530173, -0.6934234643, -0.01568356997, 0.9504498635, 0.0251169351, 0.1278428835, -0.001020233483,
+       0.05275036947, -0.0135965679, 0.04636934648, 0.0251169351, 0.04334248634, 0.0004877209194, -8.769789703e-05,
+       0.0009567638797, -0.04200573882, 0.0003316634579, 0.1278428835, 0.0004877209194, 0.05278926915, -0.0008631947824,
+       -0.007455822245, 0.001556605451, -0.005859005401, -0.001020233483, -8.769789703e-05, -0.0008631947824, 0.006682651967}}},
+    {{{0, 0, 0, -0.1, 0, 0.1, 0}},
+     {{0, -5.980415943, 0, -1.302047027, 0.0695330838, 2.252798199, 7.219568465e-19}},
+     {{0.3013944706, -9.302775466, 0.2283092501, 0.0118839671, 0.2196713613, 1.83677629, -0.02643758916}},
+     {{0.1456926774, -0.06052441894, 0.1083552289, 0.02402307331, 0.05024234214, 0.0006419282037, -0.006737848886,
+       -0.06052441894, 2.927044071, -0.05975548283, -1.230724669, -0.04862366567, 0.05796472363, 0.002757325501,
+       0.1083552289, -0.05975548283, 0.1083552289, 0.02402307331, 0.05024234214, 0.0006419282037, -0.006737848886,
+       0.02402307331, -1.230724669, 0.02402307331, 0.6480477645, 0.0257156004, -0.02355597927, -0.001769054605,
+       0.05024234214, -0.04862366567, 0.05024234214, 0.0257156004, 0.04256062721, 0.0006163931978, -0.006754524016,
+       0.0006419282037, 0.05796472363, 0.0006419282037, -0.02355597927, 0.0006163931978, 0.05239364255, -0.0005483591064,
+       -0.006737848886, 0.002757325501, -0.006737848886, -0.001769054605, -0.006754524016, -0.0005483591064, 0.006682651967}}},
+    {{{0.8, 0.4, -0.6, -1.9, 1.1, 2.2, -1.3}},
+     {{0, -35.53743419, -6.540715233, 20.83954362, 0.3040765794, 1.487600169, 0.01455885283}},
+     {{8.390429529, -37.63412666, 0.2993356882, 20.27660402, 0.3503699397, 0.4675726792, 0.03228146378}},
+     {{2.016622168, 0.1848430708, 1.637074275, 0.2466238953, -0.04238557105, -0.152711496, -0.004798223068,
+       0.1848430708, 1.998448682, 0.4785418223, -0.972987459, -0.03935095343, -0.08642227209, 0.002348034363,
+       1.637074275, 0.4785418223, 1.471521217, -0.006498187996, -0.03404660564, -0.1636502643, -0.00356042227,
+       0.2466238953, -0.972987459, -0.006498187996, 1.023345634, 0.01700174315, 0.07262494416, -0.003739136398,
+       -0.04238557105, -0.03935095343, -0.03404660564, 0.01700174315, 0.02690226969, 0.0003423995775, 0.003210111698,
+       -0.152711496, -0.08642227209, -0.1636502643, 0.07262494416, 0.0003423995775, 0.05279807675, 0.0005011943989,
+       -0.004798223068, 0.002348034363, -0.00356042227, -0.003739136398, 0.003210111698, 0.0005011943989, 0.006682651967}}},
+    {{{-1.5, -1.2, 2, -2.6, -2.2, 0.9, 2.4}},
+     {{0, 20.09210093, -20.572393, 0.2952464957, 1.195644503, -1.82826401, -0.01013979172}},
+     {{2.110031193, 17.93766652, -16.13163161, -3.414018546, 1.357507229, -1.800413416, -0.01070064973}},
+     {{1.287161954, 0.1253161447, 0.3987371069, 0.5080033778, -0.07692452651, -0.1042971757, 0.006328711618,
+       0.1253161447, 0.6389134956, -0.2161554553, 0.1446458519, 0.006086241187, -0.02099232314, 0.003230410839,
+       0.3987371069, -0.2161554553, 0.8417681067, 0.06704966079, -0.08526275613, 0.04410654216, 0.005659253698,
+       0.5080033778, 0.1446458519, 0.06704966079, 0.8540428945, -0.09934101669, -0.07185200378, 0.005155629986,
+       -0.07692452651, 0.006086241187, -0.08526275613, -0.09934101669, 0.05460045597, -0.0005293114471, -0.003573469374,
+       -0.1042971757, -0.02099232314, 0.04410654216, -0.07185200378, -0.0005293114471, 0.05341274229, -4.981317235e-05,
+       0.006328711618, 0.003230410839, 0.005659253698, 0.005155629986, -0.003573469374, -4.981317235e-05, 0.006682651967}}},
+};
+
+bool check(const char* name, double error, double tolerance) {
+    bool ok = error <= tolerance;
+    std::cout << "| " << name << " | " << std::scientific << std::setprecision(2) << error << " | "
+              << tolerance << " | " << (ok ? "OK" : "FAIL") << " |" << std::endl;
+    return ok;
+}
+
+// Potential energy of the links (and load) at q
+double potentialEnergy(const panda::Dynamics<double>& dynamics, const Joints& q) {
+    panda::Kinematics k = panda::forwardKinematics(q);
+    double energy = 0.0;
+    for (std::size_t i = 0; i < 7; i++) {
+        const auto& body = dynamics.bodies()[i];
+        const panda::Frame& frame = k.frames[i];
+        double z = frame.p[2] + frame.R[6] * body.com[0] + frame.R[7] * body.com[1] + frame.R[8] * body.com[2];
+        energy += body.mass * panda::kGravity * z;
+    }
+    return energy;
+}
+
+double kineticEnergy(const panda::Dynamics<double>& dynamics, const Joints& q, const Joints& dq) {
+    std::array<double, 49> M = dynamics.massMatrix(q);
+    double energy = 0.0;
+    for (std::size_t r = 0; r < 7; r++) {
+        for (std::size_t c = 0; c < 7; c++) energy += 0.5 * dq[r] * M[7 * r + c] * dq[c];
+    }
+    return energy;
+}
+
+template <typename F>
+void run(const char* name, std::size_t evaluations, std::size_t lanes, F&& body) {
+    double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < evaluations / lanes; i++) sink += body(i);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "| " << name << " | " << std::fixed << std::setprecision(0) << evaluations / seconds
+              << " evals/s | " << std::setprecision(1) << seconds * 1e9 / evaluations << " ns/eval | (checksum "
+              << std::setprecision(3) << sink << ")" << std::endl;
+}
+
+// Packs states into batches of N lanes (the remainder is dropped)
+template <std::size_t N>
+std::vector<panda::JointVector<panda::Batch<N>>> pack(const std::vector<Joints>& states) {
+    std::vector<panda::JointVector<panda::Batch<N>>> batches(states.size() / N);
+    for (std::size_t b = 0; b < batches.size(); b++) {
+        for (std::size_t i = 0; i < 7; i++) {
+            for (std::size_t k = 0; k < N; k++) batches[b][i].lane[k] = states[b * N + k][i];
+        }
+    }
+    return batches;
+}
+
+// Largest difference between any batch lane and the scalar result (torques and mass matrix)
+template <std::size_t N>
+double batchLaneError(const panda::Dynamics<double>& dynamics, const std::vector<Joints>& q,
+                      const std::vector<Joints>& dq, const std::vector<Joints>& ddq) {
+    panda::Dynamics<panda::Batch<N>> batch_dynamics;
+    auto bq = pack<N>(q), bdq = pack<N>(dq), bddq = pack<N>(ddq);
+    double error = 0.0;
+    for (std::size_t b = 0; b < bq.size(); b++) {
+        auto btau = batch_dynamics.inverseDynamics(bq[b], bdq[b], bddq[b]);
+        auto bM = batch_dynamics.massMatrix(bq[b]);
+        for (std::size_t k = 0; k < N; k++) {
+            std::size_t s = b * N + k;
+            Joints tau = dynamics.inverseDynamics(q[s], dq[s], ddq[s]);
+            std::array<double, 49> M = dynamics.massMatrix(q[s]);
+            for (std::size_t i = 0; i < 7; i++) error = std::max(error, std::abs(btau[i].lane[k] - tau[i]));
+            for (std::size_t i = 0; i < 49; i++) error = std::max(error, std::abs(bM[i].lane[k] - M[i]));
+        }
+    }
+    return error;
+}
+
+template <std::size_t N>
+void runBatch(const std::string& algorithm, std::size_t evaluations, const std::vector<Joints>& q,
+              const std::vector<Joints>& dq, const std::vector<Joints>& ddq) {
+    panda::Dynamics<panda::Batch<N>> dynamics;
+    auto bq = pack<N>(q), bdq = pack<N>(dq), bddq = pack<N>(ddq);
+    std::string name = algorithm + " Batch<" + std::to_string(N) + ">";
+    if (algorithm == "RNEA") {
+        run(name.c_str(), evaluations, N, [&](std::size_t i) {
+            std::size_t b = i % bq.size();
+            return dynamics.inverseDynamics(bq[b], bdq[b], bddq[b])[1].lane[0];
+        });
+    } else {
+        run(name.c_str(), evaluations, N, [&](std::size_t i) {
+            return dynamics.massMatrix(bq[i % bq.size()])[8].lane[0];
+        });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t evaluations = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    panda::Dynamics<double> dynamics;
+    std::vector<Joints> q = randomStates(1000, 0.0, 1);
+    std::vector<Joints> dq = randomStates(1000, 2.0, 2);
+    std::vector<Joints> ddq = randomStates(1000, 10.0, 3);
+    bool ok = true;
+
+    std::cout << "Dynamics checks" << std::endl;
+    std::cout << "| Check | Max error | Tolerance | Result |" << std::endl;
+
+    // Fixed reference values (tolerances cover their 10 printed digits and the finite differences
+    // behind the reference Coriolis terms)
+    double reference_gravity = 0.0, reference_tau = 0.0, reference_mass = 0.0;
+    for (const Reference& reference : kReference) {
+        Joints g = dynamics.gravity(reference.q);
+        Joints tau = dynamics.inverseDynamics(reference.q, kReferenceVelocity, kReferenceAcceleration);
+        std::array<double, 49> M = dynamics.massMatrix(reference.q);
+        for (std::size_t i = 0; i < 7; i++) {
+            reference_gravity = std::max(reference_gravity, std::abs(g[i] - reference.gravity[i]));
+            reference_tau = std::max(reference_tau, std::abs(tau[i] - reference.tau[i]));
+        }
+        for (std::size_t i = 0; i < 49; i++) {
+            reference_mass = std::max(reference_mass, std::abs(M[i] - reference.mass[i]));
+        }
+    }
+    ok &= check("Gravity vs reference values (Nm)", reference_gravity, 1e-7);
+    ok &= check("RNEA torques vs reference values (Nm)", reference_tau, 1e-6);
+    ok &= check("Mass matrix vs reference values (kg m^2)", reference_mass, 1e-7);
+
+    // CRBA vs mass matrix columns from RNEA with unit accelerations
+    double mass_error = 0.0, min_pivot = INFINITY;
+    for (std::size_t s = 0; s < q.size(); s++) {
+        std::array<double, 49> M = dynamics.massMatrix(q[s]);
+        Joints zero{};
+        for (std::size_t j = 0; j < 7; j++) {
+            Joints unit{};
+            unit[j] = 1.0;
+            Joints column = dynamics.inverseDynamics(q[s], zero, unit, false);
+            for (std::size_t i = 0; i < 7; i++) mass_error = std::max(mass_error, std::abs(column[i] - M[7 * i + j]));
+        }
+        // Positive definite: every Cholesky pivot is positive
+        std::array<double, 49> L = M;
+        for (std::size_t j = 0; j < 7; j++) {
+            for (std::size_t k = 0; k < j; k++) L[7 * j + j] -= L[7 * j + k] * L[7 * j + k];
+            min_pivot = std::min(min_pivot, L[7 * j + j]);
+            L[7 * j + j] = std::sqrt(std::max(L[7 * j + j], 0.0));
+            for (std::size_t r = j + 1; r < 7; r++) {
+                for (std::size_t k = 0; k < j; k++) L[7 * r + j] -= L[7 * r + k] * L[7 * j + k];
+                L[7 * r + j] /= L[7 * j + j];
+            }
+        }
+    }
+    ok &= check("CRBA mass matrix vs RNEA columns (Nm)", mass_error, 1e-10);
+    ok &= check("Mass matrix positive definite (-min pivot)", -min_pivot, 0.0);
+
+    // Gravity vs J^T of the link weights: tau_i = z_i . sum_k (c_k - o_i) x (m_k g e_z)
+    double gravity_error = 0.0;
+    for (const Joints& state : q) {
+        Joints tau = dynamics.gravity(state);
+        panda::Kinematics k = panda::forwardKinematics(state);
+        for (std::size_t i = 0; i < 7; i++) {
+            const panda::Frame& joint = k.frames[i];
+            double reference = 0.0;
+            for (std::size_t b = i; b < 7; b++) {
+                const auto& body = dynamics.bodies()[b];
+                const panda::Frame& frame = k.frames[b];
+                std::array<double, 3> r;
+                for (std::size_t a = 0; a < 3; a++) {
+                    r[a] = frame.p[a] + frame.R[3 * a] * body.com[0] + frame.R[3 * a + 1] * body.com[1] +
+                           frame.R[3 * a + 2] * body.com[2] - joint.p[a];
+                }
+                double weight = body.mass * panda::kGravity;
+                // (r x (0, 0, weight)) . z_i
+                reference += weight * (r[1] * joint.R[2] - r[0] * joint.R[5]);
+            }
+            gravity_error = std::max(gravity_error, std::abs(tau[i] - reference));
+        }
+    }
+    ok &= check("Gravity vs Jacobian-transpose of weights (Nm)", gravity_error, 1e-10);
+
+    // Power balance along q(t) = q0 + A sin(w t): dq . tau = d(T + V)/dt (central differences)
+    double power_error = 0.0;
+    for (std::size_t s = 0; s < 50; s++) {
+        auto at = [&](double t, Joints& pos, Joints& vel, Joints& acc) {
+            for (std::size_t i = 0; i < 7; i++) {
+                double w = 1.0 + 0.3 * i;
+                pos[i] = q[s][i] + 0.3 * std::sin(w * t);
+                vel[i] = 0.3 * w * std::cos(w * t);
+                acc[i] = -0.3 * w * w * std::sin(w * t);
+            }
+        };
+        auto energy = [&](double t) {
+            Joints pos, vel, acc;
+            at(t, pos, vel, acc);
+            return kineticEnergy(dynamics, pos, vel) + potentialEnergy(dynamics, pos);
+        };
+        double t = 0.1 * s, h = 1e-5;
+        Joints pos, vel, acc;
+        at(t, pos, vel, acc);
+        Joints tau = dynamics.inverseDynamics(pos, vel, acc);
+        double power = 0.0;
+        for (std::size_t i = 0; i < 7; i++) power += vel[i] * tau[i];
+        power_error = std::max(power_error, std::abs(power - (energy(t + h) - energy(t - h)) / (2 * h)));
+    }
+    ok &= check("Power balance dq.tau vs d(T+V)/dt (W)", power_error, 1e-5);
+
+    // Batch lanes vs scalar
+    ok &= check("Batch<4> lanes vs scalar", batchLaneError<4>(dynamics, q, dq, ddq), 1e-9);
+    ok &= check("Batch<8> lanes vs scalar", batchLaneError<8>(dynamics, q, dq, ddq), 1e-9);
+
+    Joints home{{0.0, -M_PI_4, 0.0, -3 * M_PI_4, 0.0, M_PI_2, M_PI_4}};
+    Joints g = dynamics.gravity(home);
+    std::cout << std::fixed << std::setprecision(3) << "Gravity torques at home (Nm):";
+    for (double tau : g) std::cout << " " << tau;
+    std::cout << std::endl;
+
+    std::cout << "\nDynamics benchmark (" << evaluations << " evaluations)" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    run("RNEA double", evaluations, 1, [&](std::size_t i) {
+        std::size_t s = i % q.size();
+        return dynamics.inverseDynamics(q[s], dq[s], ddq[s])[1];
+    });
+    runBatch<4>("RNEA", evaluations, q, dq, ddq);
+    runBatch<8>("RNEA", evaluations, q, dq, ddq);
+    run("CRBA double", evaluations, 1, [&](std::size_t i) {
+        return dynamics.massMatrix(q[i % q.size()])[8];
+    });
+    runBatch<4>("CRBA", evaluations, q, dq, ddq);
+    runBatch<8>("CRBA", evaluations, q, dq, ddq);
+    std::cout << "----------------------------" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,84 @@
+// Microbenchmark for the native teleop filters: ns/sample of the One-Euro position and
+// quaternion filters, the pose predictor and the pose interpolator.
+// Build with build_native.sh, run: ./bench_filters [samples]
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include "one_euro_filter.h"
+#include "pose_interpolator.h"
+#include "pose_predictor.h"
+
+namespace {
+
+struct Sample {
+    double t;
+    so3::Vec3 p;
+    so3::Quat q;
+};
+
+// Pre-generated 60 Hz phone-like stream so the timed loops only run the filters
+std::vector<Sample> makeStream(std::size_t n) {
+    std::vector<Sample> stream(n);
+    for (std::size_t i = 0; i < n; i++) {
+        double t = i / 60.0;
+        stream[i].t = t;
+        stream[i].p = {0.05 * std::sin(1.3 * t), 0.12 * std::sin(0.9 * t), 0.08 * std::sin(1.7 * t)};
+        stream[i].q = so3::quatExp({0.3 * std::sin(0.8 * t), 0.2 * std::sin(1.1 * t), 0.25 * std::sin(0.6 * t)});
+    }
+    return stream;
+}
+
+template <typename F>
+void run(const char* name, std::size_t n, F&& body) {
+    double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n; i++) {
+        sink += body(i);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count() / n;
+    std::cout << "| " << name << " | " << ns << " ns/sample | (checksum " << sink << ")\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000000;
+    std::vector<Sample> stream = makeStream(n);
+
+    std::cout << "Native filter benchmark (" << n << " samples)" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+
+    OneEuroFilter<3> position(1.0, 10.0, 1.0);
+    run("One-Euro position (3 lanes)", n, [&](std::size_t i) {
+        return position.filter(stream[i].t, stream[i].p)[0];
+    });
+
+    QuaternionOneEuroFilter orientation(1.0, 2.0, 1.0);
+    run("One-Euro quaternion", n, [&](std::size_t i) {
+        return orientation.filter(stream[i].t, stream[i].q)[3];
+    });
+
+    PosePredictor predictor(0.5, 0.1, 0.005, 0.15);
+    run("Pose predictor update+predict", n, [&](std::size_t i) {
+        predictor.update(stream[i].t, stream[i].p, stream[i].q);
+        so3::Vec3 p{};
+        so3::Quat q{};
+        predictor.predict(stream[i].t + 0.05, p, q);
+        return p[0] + q[3];
+    });
+
+    PoseInterpolator interpolator(0.05, 0.03);
+    run("Pose interpolator push+sample", n, [&](std::size_t i) {
+        interpolator.push(stream[i].t, stream[i].p, stream[i].q);
+        so3::Vec3 p{};
+        so3::Quat q{};
+        interpolator.sample(stream[i].t - 0.01, p, q);
+        return p[0] + q[3];
+    });
+
+    std::cout << "----------------------------" << std::endl;
+    return 0;
+}
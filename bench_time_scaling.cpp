@@ -0,0 +1,134 @@
+// Benchmark and comparison of the time_scaling.h families. First ns/eval of the position
+// (the ScalingFunction the control callbacks call every tick) and of position, velocity and
+// acceleration together, with the previous std::pow form of the quintic for reference. Then one
+// joint segment is played with each family on the (non-real-time) simulated robot, once at a
+// common duration and once at the family's minimum duration under 90% of the Panda limits
+// (dance_optimizer.h), reporting the peak command derivatives at 1 kHz, the tracking error and
+// the settle time.
+// Build with build_dance.sh, run: ./bench_time_scaling [evaluations]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "dance_optimizer.h"
+#include "joint_motion.h"
+#include "simulated_robot.h"
+#include "time_scaling.h"
+
+namespace {
+
+// quinticPath as it was before the Horner form
+double quinticPathPow(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+
+    double normalized_t = t / T;
+    return 10 * std::pow(normalized_t, 3) - 15 * std::pow(normalized_t, 4) + 6 * std::pow(normalized_t, 5);
+}
+
+template <typename F>
+void run(const std::string& name, const std::vector<double>& times, F&& body) {
+    double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (double t : times) sink += body(t);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "| " << name << " | " << std::fixed << std::setprecision(2) << seconds * 1e9 / times.size()
+              << " ns/eval | (checksum " << std::setprecision(3) << sink << ")" << std::endl;
+}
+
+struct Tracking {
+    double duration = 0.0;
+    std::array<double, 3> peak{};  // Max over joints of |dq|, |ddq|, |dddq| of the command
+    double tracking_error = 0.0;   // Max |q_d - q| (rad)
+    double settle_time = 0.0;      // s
+};
+
+Tracking simulate(const std::array<double, 7>& q_start, const std::array<double, 7>& q_target, double duration,
+                  TimeScaling scaling) {
+    SimulatedRobot::Options sim_options;
+    sim_options.real_time = false;
+    SimulatedRobot robot(q_start, sim_options);
+    QuinticJointMotion motion(q_start, q_target, duration, scalingFunction(scaling));
+    SettlingMotion<QuinticJointMotion> settling(motion, SettleOptions());
+    Tracking result;
+    result.duration = duration;
+    std::vector<std::array<double, 7>> commands;
+    robot.control([&](const franka::RobotState& state, franka::Duration period) {
+        commands.push_back(state.q_d);
+        for (size_t i = 0; i < 7; i++) {
+            result.tracking_error = std::max(result.tracking_error, std::abs(state.q_d[i] - state.q[i]));
+        }
+        return settling(state, period);
+    });
+    result.settle_time = settling.settleTime();
+
+    constexpr double h = 0.001;
+    for (size_t k = 1; k + 2 < commands.size(); k++) {
+        for (size_t i = 0; i < 7; i++) {
+            const double q0 = commands[k - 1][i], q1 = commands[k][i], q2 = commands[k + 1][i], q3 = commands[k + 2][i];
+            result.peak[0] = std::max(result.peak[0], std::abs(q2 - q1) / h);
+            result.peak[1] = std::max(result.peak[1], std::abs(q2 - 2.0 * q1 + q0) / (h * h));
+            result.peak[2] = std::max(result.peak[2], std::abs(q3 - 3.0 * q2 + 3.0 * q1 - q0) / (h * h * h));
+        }
+    }
+    return result;
+}
+
+void printTracking(TimeScaling scaling, const Tracking& tracking) {
+    std::cout << "| " << timeScalingName(scaling) << " | " << std::setprecision(3) << tracking.duration << " | "
+              << std::setprecision(2) << tracking.peak[0] << " | " << tracking.peak[1] << " | "
+              << std::setprecision(0) << tracking.peak[2] << " | " << std::setprecision(2)
+              << tracking.tracking_error * 1000.0 << " | " << std::setprecision(0) << tracking.settle_time * 1000.0
+              << " |" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000;
+    // Times spread over a 1 s segment and a little past both ends, in a shuffled order so
+    // the piecewise families cannot ride the branch predictor
+    std::vector<double> times(n);
+    for (std::size_t i = 0; i < n; i++) times[i] = -0.01 + 1.02 * ((i * 7919) % n) / static_cast<double>(n);
+
+    std::cout << "Time scaling evaluation (" << n << " evaluations)" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    run("quintic, std::pow form", times, [](double t) { return quinticPathPow(t, 1.0); });
+    for (TimeScaling scaling : kTimeScalings) {
+        ScalingFunction path = scalingFunction(scaling);
+        run(std::string(timeScalingName(scaling)) + " s", times, [path](double t) { return path(t, 1.0); });
+    }
+    for (TimeScaling scaling : kTimeScalings) {
+        run(std::string(timeScalingName(scaling)) + " s, ds, dds", times, [scaling](double t) {
+            ScalingSample sample = scalingSample(scaling, t);
+            return sample.s + sample.ds + sample.dds;
+        });
+    }
+
+    const std::array<double, 7> q_start = kPandaHome;
+    std::array<double, 7> q_target = kPandaHome;
+    const std::array<double, 7> delta{{1.0, 0.4, -0.6, 0.8, 0.5, -0.4, 0.9}};
+    for (size_t i = 0; i < 7; i++) q_target[i] += delta[i];
+    const double common_duration = 1.5;
+    JointLimits limits = JointLimits::panda(0.9);
+
+    std::cout << "\nSimulated tracking, same segment at " << common_duration << " s" << std::endl;
+    std::cout << "| Scaling | Duration s | Peak dq rad/s | Peak ddq rad/s^2 | Peak dddq rad/s^3 | Tracking mrad | Settle ms |"
+              << std::endl;
+    for (TimeScaling scaling : kTimeScalings) {
+        printTracking(scaling, simulate(q_start, q_target, common_duration, scaling));
+    }
+
+    std::cout << "\nSimulated tracking at the minimum duration within 90% of the limits" << std::endl;
+    std::cout << "| Scaling | Duration s | Peak dq rad/s | Peak ddq rad/s^2 | Peak dddq rad/s^3 | Tracking mrad | Settle ms |"
+              << std::endl;
+    for (TimeScaling scaling : kTimeScalings) {
+        double duration = minQuinticTime(q_start, q_target, limits, {}, 1e-3, scaling).duration;
+        printTracking(scaling, simulate(q_start, q_target, duration, scaling));
+    }
+    return 0;
+}
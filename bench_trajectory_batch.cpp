@@ -0,0 +1,182 @@
+// Check and benchmark for trajectory_batch.h. The AVX2 kernel is checked against the scalar
+// kernel, and both against the time_scaling.h path functions, for every scaling. Then joint
+// samples/s (one sample = the 7 joints of one segment at one time) are measured for the scalar
+// quinticPath loop the planners use (samplePlan), and for both kernels with positions only and
+// with velocities and accelerations. The exit status is non-zero if a check fails.
+// Build with build_dance.sh (no -march flag, the kernel is picked at runtime), run:
+// ./bench_trajectory_batch [segments]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "time_scaling.h"
+#include "trajectory_batch.h"
+
+namespace {
+
+constexpr size_t kBlock = 2;  // Segments per kernel call, so the output stays in cache
+
+bool check(const std::string& name, double error, double tolerance) {
+    bool ok = error <= tolerance;
+    std::cout << "| " << name << " | " << std::scientific << std::setprecision(2) << error << " | " << tolerance
+              << " | " << (ok ? "OK" : "FAIL") << " |" << std::endl;
+    return ok;
+}
+
+struct Segments {
+    std::vector<std::array<double, 7>> q_start, q_target;
+    std::vector<double> duration;
+    SegmentBatch batch;
+};
+
+Segments randomSegments(size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> joint(-1.5, 1.5), duration(0.5, 2.5);
+    Segments segments;
+    for (size_t g = 0; g < n; g++) {
+        std::array<double, 7> a, b;
+        for (size_t i = 0; i < 7; i++) {
+            a[i] = joint(rng);
+            b[i] = joint(rng);
+        }
+        segments.q_start.push_back(a);
+        segments.q_target.push_back(b);
+        segments.duration.push_back(duration(rng));
+        segments.batch.add(a, b, segments.duration.back());
+    }
+    return segments;
+}
+
+// Largest difference between two kernels, and between a kernel's positions and the path function
+double kernelError(BatchKernel a, BatchKernel b, const Segments& segments, TimeScaling scaling,
+                   const std::vector<double>& t) {
+    size_t n = segments.batch.size();
+    BatchSamples x, y;
+    x.resize(n, t.size());
+    y.resize(n, t.size());
+    a(segments.batch, 0, n, scaling, t.data(), t.size(), x);
+    b(segments.batch, 0, n, scaling, t.data(), t.size(), y);
+    double error = 0.0;
+    for (size_t r = 0; r < x.q.size(); r++) {
+        for (size_t i = 0; i < 8; i++) {
+            error = std::max({error, std::abs(x.q[r].lane[i] - y.q[r].lane[i]),
+                              std::abs(x.dq[r].lane[i] - y.dq[r].lane[i]), std::abs(x.ddq[r].lane[i] - y.ddq[r].lane[i])});
+        }
+    }
+    return error;
+}
+
+double pathError(BatchKernel kernel, const Segments& segments, TimeScaling scaling, const std::vector<double>& t) {
+    size_t n = segments.batch.size();
+    BatchSamples out;
+    out.resize(n, t.size());
+    kernel(segments.batch, 0, n, scaling, t.data(), t.size(), out);
+    ScalingFunction path = scalingFunction(scaling);
+    double error = 0.0;
+    for (size_t g = 0; g < n; g++) {
+        for (size_t k = 0; k < t.size(); k++) {
+            double s = path(t[k], segments.duration[g]);
+            for (size_t i = 0; i < 7; i++) {
+                double q = segments.q_start[g][i] + s * (segments.q_target[g][i] - segments.q_start[g][i]);
+                error = std::max(error, std::abs(q - out.q[g * t.size() + k].lane[i]));
+            }
+            if (out.q[g * t.size() + k].lane[7] != 0.0) error = INFINITY;  // Padding lane stays zero
+        }
+    }
+    return error;
+}
+
+template <typename F>
+void run(const std::string& name, size_t samples, F&& body) {
+    auto start = std::chrono::steady_clock::now();
+    double sink = body();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "| " << name << " | " << std::fixed << std::setprecision(1) << samples / seconds / 1e6
+              << " M samples/s | " << std::setprecision(2) << seconds * 1e9 / samples << " ns/sample | (checksum "
+              << std::setprecision(3) << sink << ")" << std::endl;
+}
+
+void runKernel(const std::string& name, BatchKernel kernel, const Segments& segments, TimeScaling scaling,
+               const std::vector<double>& t, bool derivatives) {
+    BatchSamples out;
+    out.resize(kBlock, t.size(), derivatives);
+    size_t n = segments.batch.size() / kBlock * kBlock;
+    run(name, n * t.size(), [&] {
+        double sink = 0.0;
+        for (size_t first = 0; first < n; first += kBlock) {
+            kernel(segments.batch, first, kBlock, scaling, t.data(), t.size(), out);
+            sink += out.q[t.size() / 2].lane[0] + (derivatives ? out.ddq[t.size() / 3].lane[1] : 0.0);
+        }
+        return sink;
+    });
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t segment_count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    BatchKernel selected = selectBatchKernel();
+    std::cout << "Selected batch kernel: " << batchKernelName(selected) << std::endl;
+
+    // Checks on a few segments, including times before the start and past the end
+    Segments small = randomSegments(16, 1);
+    std::vector<double> check_times;
+    for (int k = -5; k <= 2600; k++) check_times.push_back(k * 0.001);
+    bool ok = true;
+    std::cout << "\nBatch kernel checks" << std::endl;
+    std::cout << "| Check | Max error | Tolerance | Result |" << std::endl;
+    for (TimeScaling scaling : kTimeScalings) {
+        std::string name = timeScalingName(scaling);
+        ok &= check(name + " scalar kernel vs path function (rad)",
+                    pathError(evaluateBatchScalar, small, scaling, check_times), 1e-12);
+#if TRAJECTORY_BATCH_AVX2
+        if (selected == evaluateBatchAvx2) {
+            ok &= check(name + " AVX2 vs scalar kernel",
+                        kernelError(evaluateBatchAvx2, evaluateBatchScalar, small, scaling, check_times), 1e-9);
+        }
+#endif
+    }
+
+    // Dense 1 kHz sampling over the longest segment
+    Segments segments = randomSegments(segment_count, 2);
+    std::vector<double> t(2501);
+    for (size_t k = 0; k < t.size(); k++) t[k] = k * 0.001;
+    size_t samples = segments.batch.size() / kBlock * kBlock * t.size();
+
+    std::cout << "\nBatch evaluation benchmark (" << segment_count << " segments x " << t.size()
+              << " samples at 1 kHz)" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    std::vector<std::array<double, 7>> path(t.size());
+    run("quinticPath loop, positions", samples, [&] {
+        double sink = 0.0;
+        for (size_t g = 0; g < samples / t.size(); g++) {
+            const std::array<double, 7>& a = segments.q_start[g];
+            const std::array<double, 7>& b = segments.q_target[g];
+            for (size_t k = 0; k < t.size(); k++) {
+                double s = quinticPath(t[k], segments.duration[g]);
+                for (size_t i = 0; i < 7; i++) path[k][i] = a[i] + s * (b[i] - a[i]);
+            }
+            sink += path[t.size() / 2][0];
+        }
+        return sink;
+    });
+    runKernel("scalar kernel quintic, positions", evaluateBatchScalar, segments, TimeScaling::kQuintic, t, false);
+    runKernel("scalar kernel quintic, q dq ddq", evaluateBatchScalar, segments, TimeScaling::kQuintic, t, true);
+#if TRAJECTORY_BATCH_AVX2
+    if (selected == evaluateBatchAvx2) {
+        runKernel("AVX2 kernel quintic, positions", evaluateBatchAvx2, segments, TimeScaling::kQuintic, t, false);
+        for (TimeScaling scaling : kTimeScalings) {
+            std::string name = std::string("AVX2 kernel ") + timeScalingName(scaling) + ", q dq ddq";
+            runKernel(name, evaluateBatchAvx2, segments, scaling, t, true);
+        }
+    }
+#endif
+    std::cout << "----------------------------" << std::endl;
+    return ok ? 0 : 1;
+}
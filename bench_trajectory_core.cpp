@@ -0,0 +1,178 @@
+// Check and benchmark for trajectory_core.h on the 1-DOF gripper, the 7-DOF arm and the 9-DOF
+// arm with fingers, in float and double. The checks compare float against double (durations
+// and sampled plans) and the 9-DOF bound against the arm and finger bounds taken separately. The benchmark reports ns per
+// segment for planning (minimum duration within the limits and the peak derivatives) and ns
+// per sample for 1 kHz path sampling (interpolate, scaling values precomputed). The exit status
+// is non-zero if a check fails.
+// Build with build_dance.sh, run: ./bench_trajectory_core [segments]
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "time_scaling.h"
+#include "trajectory_core.h"
+
+namespace {
+
+template <size_t DOF, typename Scalar>
+struct Segments {
+    std::vector<trajectory::Vector<DOF, Scalar>> start, end;
+};
+
+// Random segments within the position limits, the same values for every scalar type
+template <size_t DOF, typename Scalar>
+Segments<DOF, Scalar> randomSegments(size_t n, const trajectory::Limits<DOF>& limits, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    Segments<DOF, Scalar> segments;
+    auto point = [&] {
+        trajectory::Vector<DOF, Scalar> q;
+        for (size_t i = 0; i < DOF; i++) {
+            q[i] = static_cast<Scalar>(
+                std::uniform_real_distribution<double>(limits.position_min[i], limits.position_max[i])(rng));
+        }
+        return q;
+    };
+    for (size_t g = 0; g < n; g++) {
+        segments.start.push_back(point());
+        segments.end.push_back(point());
+    }
+    return segments;
+}
+
+bool check(const std::string& name, double error, double tolerance) {
+    bool ok = error <= tolerance;
+    std::cout << "| " << name << " | " << std::scientific << std::setprecision(2) << error << " | " << tolerance
+              << " | " << (ok ? "OK" : "FAIL") << " |" << std::endl;
+    return ok;
+}
+
+// Largest difference (s) of the float minimum durations from the double ones
+template <size_t DOF>
+double floatError(const trajectory::Limits<DOF>& limits, const ScalingPeaks& peaks) {
+    auto d = randomSegments<DOF, double>(1000, limits, 1);
+    auto f = randomSegments<DOF, float>(1000, limits, 1);
+    double error = 0.0;
+    for (size_t g = 0; g < d.start.size(); g++) {
+        double a = trajectory::minScaledTime(d.start[g], d.end[g], limits, peaks).duration;
+        double b = trajectory::minScaledTime(f.start[g], f.end[g], limits, peaks).duration;
+        error = std::max(error, std::abs(a - b));
+    }
+    return error;
+}
+
+// Largest difference (rad or m) of a float sampled plan (the runner's SegmentPlan, any DOF)
+// from the double one
+template <size_t DOF>
+double floatPlanError(const trajectory::Limits<DOF>& limits) {
+    auto d = randomSegments<DOF, double>(20, limits, 4);
+    auto f = randomSegments<DOF, float>(20, limits, 4);
+    double error = 0.0;
+    for (size_t g = 0; g < d.start.size(); g++) {
+        trajectory::SegmentPlan<DOF, double> plan_d;
+        trajectory::SegmentPlan<DOF, float> plan_f;
+        plan_d.q_start = d.start[g];
+        plan_d.q_target = d.end[g];
+        plan_f.q_start = f.start[g];
+        plan_f.q_target = f.end[g];
+        plan_d.safe_duration = plan_f.safe_duration = 1.0;
+        trajectory::samplePlan(plan_d, quinticPath);
+        trajectory::samplePlan(plan_f, quinticPath);
+        for (size_t k = 0; k < plan_d.samples.size(); k++) {
+            for (size_t i = 0; i < DOF; i++) {
+                error = std::max(error, std::abs(plan_d.samples[k][i] - static_cast<double>(plan_f.samples[k][i])));
+            }
+        }
+    }
+    return error;
+}
+
+template <size_t DOF, typename Scalar>
+void benchmark(const std::string& name, const trajectory::Limits<DOF>& limits, size_t n) {
+    Segments<DOF, Scalar> segments = randomSegments<DOF, Scalar>(n, limits, 2);
+    ScalingPeaks peaks = scalingPeaks(TimeScaling::kQuintic);
+
+    double sink = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (size_t g = 0; g < n; g++) {
+        Scalar T = trajectory::minScaledTime(segments.start[g], segments.end[g], limits, peaks).duration;
+        T = std::max(T, trajectory::minTravelTime(segments.start[g], segments.end[g], limits.velocity));
+        sink += trajectory::segmentPeaks(segments.start[g], segments.end[g], T, peaks).acceleration[DOF - 1];
+    }
+    double plan_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // 1 kHz path of a 1 s quintic segment, the scaling values precomputed
+    constexpr size_t kSamples = 1000;
+    std::vector<Scalar> scaling(kSamples);
+    for (size_t k = 0; k < kSamples; k++) scaling[k] = static_cast<Scalar>(quinticPath(k * 0.001, 1.0));
+    std::vector<trajectory::Vector<DOF, Scalar>> path(kSamples);
+    size_t paths = std::max<size_t>(1, n / 10);
+    start = std::chrono::steady_clock::now();
+    for (size_t g = 0; g < paths; g++) {
+        for (size_t k = 0; k < kSamples; k++) {
+            trajectory::interpolate(segments.start[g], segments.end[g], scaling[k], path[k]);
+        }
+        sink += path[kSamples / 2][0];
+    }
+    double sample_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "| " << name << " | " << std::fixed << std::setprecision(1) << plan_seconds * 1e9 / n
+              << " ns/segment | " << std::setprecision(2) << sample_seconds * 1e9 / (paths * kSamples)
+              << " ns/sample | (checksum " << std::setprecision(3) << sink << ")" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    ScalingPeaks peaks = scalingPeaks(TimeScaling::kQuintic);
+    bool ok = true;
+
+    std::cout << "Trajectory core checks" << std::endl;
+    std::cout << "| Check | Max error | Tolerance | Result |" << std::endl;
+    // Float keeps the durations within 1% of a 1 ms control tick
+    ok &= check("float vs double min duration, 1 DOF (s)", floatError(trajectory::kPandaGripper, peaks), 1e-5);
+    ok &= check("float vs double min duration, 7 DOF (s)", floatError(trajectory::kPandaArm, peaks), 1e-5);
+    ok &= check("float vs double min duration, 9 DOF (s)",
+                floatError(trajectory::kPandaArmWithFingers, peaks), 1e-5);
+
+    // Single-precision rounding of positions up to ~3.8 rad
+    ok &= check("float vs double sampled plan, 9 DOF (rad)", floatPlanError(trajectory::kPandaArmWithFingers), 2e-6);
+
+    // The combined bound is the larger of the arm's and the fingers'
+    auto combined = randomSegments<9, double>(1000, trajectory::kPandaArmWithFingers, 3);
+    double split_error = 0.0;
+    for (size_t g = 0; g < combined.start.size(); g++) {
+        trajectory::Vector<7> arm_start, arm_end;
+        trajectory::Vector<1> finger_start[2], finger_end[2];
+        std::copy_n(combined.start[g].begin(), 7, arm_start.begin());
+        std::copy_n(combined.end[g].begin(), 7, arm_end.begin());
+        double split = trajectory::minScaledTime(arm_start, arm_end, trajectory::kPandaArm, peaks).duration;
+        for (size_t f = 0; f < 2; f++) {
+            finger_start[f][0] = combined.start[g][7 + f];
+            finger_end[f][0] = combined.end[g][7 + f];
+            split = std::max(split, trajectory::minScaledTime(finger_start[f], finger_end[f], trajectory::kPandaFinger,
+                                                              peaks).duration);
+        }
+        double joint = trajectory::minScaledTime(combined.start[g], combined.end[g], trajectory::kPandaArmWithFingers,
+                                                 peaks).duration;
+        split_error = std::max(split_error, std::abs(joint - split));
+    }
+    ok &= check("9 DOF vs arm and fingers separately (s)", split_error, 0.0);
+
+    std::cout << "\nTrajectory core benchmark (" << n << " segments)" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    benchmark<1, float>("gripper (1 DOF) float", trajectory::kPandaGripper, n);
+    benchmark<1, double>("gripper (1 DOF) double", trajectory::kPandaGripper, n);
+    benchmark<7, float>("arm (7 DOF) float", trajectory::kPandaArm, n);
+    benchmark<7, double>("arm (7 DOF) double", trajectory::kPandaArm, n);
+    benchmark<9, float>("arm + fingers (9 DOF) float", trajectory::kPandaArmWithFingers, n);
+    benchmark<9, double>("arm + fingers (9 DOF) double", trajectory::kPandaArmWithFingers, n);
+    std::cout << "----------------------------" << std::endl;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+// Benchmark for the waypoint reordering optimizer: for random joint-space point sets of 20 to
+// 2000 waypoints, the cost-matrix and solve times and the predicted cycle time in file order,
+// nearest-neighbour order and optimized order.
+// Build with build_dance.sh, run: ./bench_waypoint_order [max_points] [restarts]
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "panda_limits.h"
+#include "waypoint_order.h"
+
+namespace {
+
+// Uniform samples inside the joint limits, shrunk by 10% of each range
+std::vector<std::array<double, 7>> randomWaypoints(std::size_t n, uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::vector<std::array<double, 7>> points(n);
+    for (std::array<double, 7>& point : points) {
+        for (std::size_t i = 0; i < 7; i++) {
+            double margin = 0.1 * (panda::kJointPositionMax[i] - panda::kJointPositionMin[i]);
+            point[i] = std::uniform_real_distribution<double>(panda::kJointPositionMin[i] + margin,
+                                                              panda::kJointPositionMax[i] - margin)(rng);
+        }
+    }
+    return points;
+}
+
+// Cycle time as random_points runs it: each session lasts 1.01 x the segment time, then settles
+double cycleTime(double tour_cost, std::size_t waypoints) {
+    return 1.01 * tour_cost + panda::kSettleTime * waypoints;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t max_points = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+    TourOptions options;
+    if (argc > 2) options.restarts = std::strtoul(argv[2], nullptr, 10);
+
+    std::cout << "Waypoint reordering benchmark (" << options.threads << " threads, " << options.restarts
+              << " restarts)" << std::endl;
+    std::cout << "| Points | Matrix ms | Solve ms | File order s | Nearest neighbour s | Optimized s | Gain vs file | Gain vs NN |"
+              << std::endl;
+    std::cout << std::fixed;
+    for (std::size_t n : {20, 50, 100, 200, 500, 1000, 2000}) {
+        if (n > max_points) break;
+        std::vector<std::array<double, 7>> points = randomWaypoints(n, n);
+        auto start = std::chrono::steady_clock::now();
+        SegmentCostMatrix costs(points, JointLimits::panda(), {}, options.threads);
+        double matrix_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        TourResult result = optimizeWaypointOrder(costs, options);
+
+        double file_order = cycleTime(result.identity_cost, n);
+        double nearest = cycleTime(result.nearest_neighbor_cost, n);
+        double optimized = cycleTime(result.cost, n);
+        std::cout << "| " << n << " | " << std::setprecision(1) << matrix_ms << " | " << result.seconds * 1000.0
+                  << " | " << std::setprecision(2) << file_order << " | " << nearest << " | " << optimized << " | "
+                  << std::setprecision(1) << 100.0 * (file_order - optimized) / file_order << "% | "
+                  << 100.0 * (nearest - optimized) / nearest << "% |" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,43 @@
+#!/bin/bash
+
+# Build the libfranka dance runner and its offline tools
+cd "$(dirname "$0")"
+
+echo "Building random_points..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra random_points.cpp -o random_points -lfranka -pthread
+
+echo "Building replay_harness..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra replay_harness.cpp -o replay_harness -lfranka -pthread
+
+echo "Building dance_validator..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra dance_validator.cpp -o dance_validator -lfranka -pthread
+
+echo "Building bench_waypoint_order..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra bench_waypoint_order.cpp -o bench_waypoint_order -lfranka -pthread
+
+echo "Building random_dance_generator..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra random_dance_generator.cpp -o random_dance_generator -lfranka -pthread
+
+echo "Building bench_dynamics..."
+${CXX:-g++} -std=c++17 -O3 -march=native -Wall -Wextra bench_dynamics.cpp -o bench_dynamics
+
+echo "Building bench_time_scaling..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra bench_time_scaling.cpp -o bench_time_scaling -lfranka -pthread
+
+echo "Building bench_trajectory_batch..."
+${CXX:-g++} -std=c++17 -O3 -Wall -Wextra bench_trajectory_batch.cpp -o bench_trajectory_batch
+
+echo "Building bench_trajectory_core..."
+${CXX:-g++} -std=c++17 -O3 -Wall -Wextra bench_trajectory_core.cpp -o bench_trajectory_core
+
+echo "Building dance_codegen..."
+${CXX:-g++} -std=c++17 -O2 -Wall -Wextra dance_codegen.cpp -o dance_codegen
+
+# Fixed-dance runner: DANCE_CONFIG=<config file> [DANCE_INTERP=<scaling>] ./build_dance.sh
+if [ -n "$DANCE_CONFIG" ]; then
+    echo "Generating embedded_dance_table.h from $DANCE_CONFIG..."
+    ./dance_codegen "$DANCE_CONFIG" embedded_dance_table.h ${DANCE_INTERP:+--interp "$DANCE_INTERP"} || exit 1
+
+    echo "Building embedded_dance..."
+    ${CXX:-g++} -std=c++17 -O2 -Wall -Wextra embedded_dance.cpp -o embedded_dance -lfranka -pthread
+fi
@@ -0,0 +1,11 @@
+#!/bin/bash
+
+# Build the native teleop filters loaded by franka_ar_native.py and their benchmark
+cd "$(dirname "$0")"
+
+echo "Building libfranka_ar_native.so..."
+${CXX:-g++} -std=c++17 -O3 -march=native -Wall -Wextra -shared -fPIC \
+    franka_ar_native.cpp -o libfranka_ar_native.so
+
+echo "Building bench_filters..."
+${CXX:-g++} -std=c++17 -O3 -march=native -Wall -Wextra bench_filters.cpp -o bench_filters
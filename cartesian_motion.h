@@ -0,0 +1,202 @@
+// Cartesian-space dance moves for random_points.cpp: a straight-line translation with SLERP
+// orientation from the current hand pose to a target pose, under the same time scalings as the
+// joint moves (time_scaling.h), played through a franka::CartesianPose control callback. Targets are
+// position plus rotation vector in the base frame, the 6-vector pose format of the Python pose
+// lists (test.py, tele_random.py). The per-tick kernel works on fixed-size arrays only and never
+// allocates in the control loop.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <franka/control_types.h>
+#include <franka/duration.h>
+#include <franka/exception.h>
+#include <franka/robot_state.h>
+#include "joint_motion.h"
+#include "so3.h"
+
+// Hand pose target: x, y, z (m) and rotation vector rx, ry, rz (rad) in the base frame
+using CartesianTarget = std::array<double, 6>;
+
+// Average-speed caps for Cartesian moves, the counterpart of MAX_JOINT_VELOCITY
+constexpr double MAX_CARTESIAN_VELOCITY = 0.5;          // m/s
+constexpr double MAX_CARTESIAN_ANGULAR_VELOCITY = 1.0;  // rad/s
+
+struct HandPose {
+    so3::Vec3 position;
+    so3::Quat orientation;  // {x, y, z, w}
+};
+
+inline HandPose handPoseFromTarget(const CartesianTarget& target) {
+    return {{target[0], target[1], target[2]}, so3::quatExp({target[3], target[4], target[5]})};
+}
+
+// Column-major homogeneous transform (franka's O_T_EE layout) to a hand pose
+inline HandPose handPoseFromMatrix(const std::array<double, 16>& T) {
+    // Shepperd's method: divide by the largest of the four quaternion magnitudes
+    double m00 = T[0], m11 = T[5], m22 = T[10];
+    double trace = m00 + m11 + m22;
+    so3::Quat q;
+    if (trace > 0.0) {
+        double s = 2.0 * std::sqrt(1.0 + trace);
+        q = {(T[6] - T[9]) / s, (T[8] - T[2]) / s, (T[1] - T[4]) / s, 0.25 * s};
+    } else if (m00 > m11 && m00 > m22) {
+        double s = 2.0 * std::sqrt(1.0 + m00 - m11 - m22);
+        q = {0.25 * s, (T[4] + T[1]) / s, (T[8] + T[2]) / s, (T[6] - T[9]) / s};
+    } else if (m11 > m22) {
+        double s = 2.0 * std::sqrt(1.0 + m11 - m00 - m22);
+        q = {(T[4] + T[1]) / s, 0.25 * s, (T[9] + T[6]) / s, (T[8] - T[2]) / s};
+    } else {
+        double s = 2.0 * std::sqrt(1.0 + m22 - m00 - m11);
+        q = {(T[8] + T[2]) / s, (T[9] + T[6]) / s, 0.25 * s, (T[1] - T[4]) / s};
+    }
+    return {{T[12], T[13], T[14]}, so3::quatNormalize(q)};
+}
+
+// Hand pose to a column-major homogeneous transform, written into T
+inline void handPoseToMatrix(const HandPose& pose, std::array<double, 16>& T) {
+    const so3::Quat& q = pose.orientation;
+    double x = q[0], y = q[1], z = q[2], w = q[3];
+    T[0] = 1.0 - 2.0 * (y * y + z * z);
+    T[1] = 2.0 * (x * y + z * w);
+    T[2] = 2.0 * (x * z - y * w);
+    T[3] = 0.0;
+    T[4] = 2.0 * (x * y - z * w);
+    T[5] = 1.0 - 2.0 * (x * x + z * z);
+    T[6] = 2.0 * (y * z + x * w);
+    T[7] = 0.0;
+    T[8] = 2.0 * (x * z + y * w);
+    T[9] = 2.0 * (y * z - x * w);
+    T[10] = 1.0 - 2.0 * (x * x + y * y);
+    T[11] = 0.0;
+    T[12] = pose.position[0];
+    T[13] = pose.position[1];
+    T[14] = pose.position[2];
+    T[15] = 1.0;
+}
+
+// Translation distance (m) and rotation angle (rad) between two hand poses
+inline double translationDistance(const HandPose& a, const HandPose& b) {
+    double dx = b.position[0] - a.position[0], dy = b.position[1] - a.position[1], dz = b.position[2] - a.position[2];
+    return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+inline double rotationAngle(const HandPose& a, const HandPose& b) {
+    so3::Vec3 d = so3::boxMinus(b.orientation, a.orientation);
+    return std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
+
+// Shortest duration for start -> target under the average translation and rotation speed caps
+inline double minSafeCartesianTime(const HandPose& start, const HandPose& target) {
+    return std::max(translationDistance(start, target) / MAX_CARTESIAN_VELOCITY,
+                    rotationAngle(start, target) / MAX_CARTESIAN_ANGULAR_VELOCITY);
+}
+
+// Cartesian counterpart of getSafeMovementTime
+inline double getSafeCartesianMovementTime(const HandPose& start, const HandPose& target, double desired_time) {
+    double min_safe_time = minSafeCartesianTime(start, target);
+    if (desired_time >= min_safe_time) {
+        return desired_time;
+    }
+    std::cout << "WARNING: Requested time (" << desired_time << "s) is too fast!" << std::endl;
+    std::cout << "The hand would need to move " << translationDistance(start, target) << " m and rotate "
+              << rotationAngle(start, target) << " rad (limits: " << MAX_CARTESIAN_VELOCITY << " m/s, "
+              << MAX_CARTESIAN_ANGULAR_VELOCITY << " rad/s)" << std::endl;
+    std::cout << "Automatically increasing time to " << min_safe_time << "s for safety\n";
+    return min_safe_time;
+}
+
+// Control callback of one Cartesian move: straight line and SLERP from the commanded pose at
+// the first tick (O_T_EE_c, so the command starts continuous) to the target over duration
+// seconds of accumulated callback periods, finishing at 1.01 x duration.
+class CartesianLinearMotion {
+public:
+    CartesianLinearMotion(const HandPose& target, double duration, ScalingFunction scaling = quinticPath)
+        : target_(target), duration_(duration), scaling_(scaling) {}
+
+    franka::CartesianPose operator()(const franka::RobotState& state, franka::Duration period) {
+        if (!started_) {
+            start(handPoseFromMatrix(state.O_T_EE_c));
+        }
+        time_total_ += period.toSec();
+        poseAt(scaling_(time_total_, duration_), pose_);
+        if (time_total_ >= duration_ * 1.01) {
+            return franka::MotionFinished(franka::CartesianPose(pose_));
+        }
+        return franka::CartesianPose(pose_);
+    }
+
+    // Fixes the start pose (done by the first callback unless called before)
+    void start(const HandPose& pose) {
+        start_ = pose;
+        for (size_t i = 0; i < 3; i++) translation_[i] = target_.position[i] - start_.position[i];
+        rotation_ = so3::boxMinus(target_.orientation, start_.orientation);
+        started_ = true;
+    }
+
+    // Interpolated pose at path parameter s in [0, 1] as a column-major transform
+    void poseAt(double s, std::array<double, 16>& T) const {
+        HandPose pose;
+        for (size_t i = 0; i < 3; i++) pose.position[i] = start_.position[i] + s * translation_[i];
+        pose.orientation = so3::boxPlus(start_.orientation, {rotation_[0] * s, rotation_[1] * s, rotation_[2] * s});
+        handPoseToMatrix(pose, T);
+    }
+
+    double elapsed() const { return time_total_; }
+    double duration() const { return duration_; }
+
+private:
+    HandPose target_;
+    double duration_;
+    ScalingFunction scaling_;
+    HandPose start_{};
+    so3::Vec3 translation_{};
+    so3::Vec3 rotation_{};
+    std::array<double, 16> pose_{};
+    double time_total_ = 0.0;
+    bool started_ = false;
+};
+
+// Moves the hand to a target pose over the desired duration (see CartesianLinearMotion), with the
+// same timing options, recording, post-mortem and recovery handling as moveJoints. The flight
+// recorder segment has the start configuration as q_target, since the joint target is up to the
+// robot's IK.
+template <typename Robot>
+MoveResult moveCartesian(Robot& robot, const CartesianTarget& target, double desired_duration,
+                         MoveContext& context, const MoveTiming& timing = MoveTiming(),
+                         bool recover_on_error = true) {
+    MoveResult result;
+    result.desired_duration = desired_duration;
+    try {
+        franka::RobotState state = robot.readOnce();
+        HandPose goal = handPoseFromTarget(target);
+        double safe_duration = getSafeCartesianMovementTime(handPoseFromMatrix(state.O_T_EE), goal, desired_duration) /
+                               timing.velocity_scale;
+        flight_recorder::SegmentRecord segment =
+            segmentRecord(state.q, state.q, desired_duration, safe_duration, timing, context);
+        segment.motion = static_cast<double>(flight_recorder::SegmentMotion::kCartesian);
+        context.recorder.beginSegment(segment);
+        result.safe_duration = safe_duration;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+        CartesianLinearMotion motion(goal, safe_duration, scalingFunction(timing.scaling));
+        double max_tracking_error = runMotion(robot, motion, context, result);
+        std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start_time;
+        completeMove(result, elapsed.count(), max_tracking_error, timing.dwell);
+        return result;
+    } catch (const franka::Exception& e) {
+        std::cerr << "Franka exception during Cartesian motion: " << e.what() << std::endl;
+        dumpPostmortem(context.recorder, context.postmortem_dir, context.postmortem_seconds);
+        if (recover_on_error) {
+            std::cout << "Attempting to recover and retry..." << std::endl;
+            recoverRobot(robot);
+            MoveResult retry = moveCartesian(robot, target, desired_duration, context, timing, false);
+            retry.recoveries += 1;
+            return retry;
+        }
+        return result;
+    }
+}
@@ -10,6 +10,48 @@ SERVER_IP = '127.0.0.1'
 SERVER_PORT = 4242
 AR_CONNECTOR_PORT = 8888
 
+# State Streaming Configuration
+STATE_PUBLISH_PORT = 4243
+STATE_PUBLISH_RATE = 500  # Hz - up to 1000; subscribers are conflated to the latest sample
+
+# One-way Pose Stream Configuration
+POSE_STREAM_ENABLED = True   # Send impedance targets fire-and-forget instead of blocking RPC
+POSE_STREAM_PORT = 4244
+POSE_ACK_PORT = 4245
+POSE_ACK_INTERVAL = 0.1      # seconds - 0 disables server acks
+POSE_ACK_TIMEOUT = 1.0       # seconds without an ack before the link is reported as down
+
+# Target Upsampling Configuration (server side, needs libfranka_ar_native.so from build_native.sh)
+# When enabled (requires POSE_STREAM_ENABLED) the client sends each AR sample once and the
+# server interpolates to UPSAMPLING_RATE
+POSE_UPSAMPLING_ENABLED = False
+UPSAMPLING_RATE = 1000                      # Hz
+UPSAMPLING_PLAYOUT_DELAY = 0.02             # seconds - roughly one ARKit period plus jitter
+UPSAMPLING_MAX_EXTRAPOLATION = 0.05         # seconds past the newest sample before holding
+UPSAMPLING_MAX_EXTRAPOLATION_DISTANCE = 0.03  # meters
+
+# Latency Compensation Configuration (server side, needs libfranka_ar_native.so)
+# Latency is measured from sample timestamps: client and server clocks must agree
+PREDICTION_ENABLED = False
+PREDICTOR_ALPHA = 0.5              # alpha-beta-gamma gain; beta/gamma follow from it
+PREDICTOR_MAX_LEAD = 0.15          # seconds - never predict further ahead than this
+PREDICTION_EXTRA_LATENCY = 0.01    # seconds - unmeasured stages (ARKit capture, robot controller)
+LATENCY_SMOOTHING = 0.05           # EWMA factor for the online latency estimate
+
+# One-Euro Filter Configuration (phone pose jitter; needs libfranka_ar_native.so)
+# Cutoff = MIN_CUTOFF + BETA * speed: low cutoff removes jitter at rest, BETA limits lag in motion
+ONE_EURO_ENABLED = False
+ONE_EURO_POS_MIN_CUTOFF = 1.0      # Hz
+ONE_EURO_POS_BETA = 10.0           # Hz per m/s
+ONE_EURO_ROT_MIN_CUTOFF = 1.0      # Hz
+ONE_EURO_ROT_BETA = 2.0            # Hz per rad/s
+ONE_EURO_D_CUTOFF = 1.0            # Hz - cutoff of the speed estimate
+
+# Latency Tracing Configuration (server side)
+# Per-stage histograms of pose target age; timestamps from client and server must share a clock
+LATENCY_TRACING_ENABLED = True
+LATENCY_TRACE_MAX_SPANS = 200000   # recent spans kept for Chrome/Perfetto export
+
 # Control Loop Configuration
 CONTROL_FREQUENCY = 200  # Hz - Reduced from 1000 for better performance
 AR_DEBUG = False
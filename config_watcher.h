@@ -0,0 +1,124 @@
+// Hot reload of the dance configuration. A background thread watches the config file's
+// directory with inotify (so editors that save via rename are seen too), strictly parses the new
+// file, checks its joint targets against the position limits, and publishes it as the pending
+// dance. The dance loop picks it up with takeUpdate() at the next cycle boundary; the running
+// dance is never modified in place. Invalid files are rejected with their diagnostics and the
+// current dance keeps running.
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "dance_config.h"
+
+using DanceMoves = std::vector<DanceMove>;
+
+class DanceConfigWatcher {
+public:
+    // Reloaded moves start from defaults, like the initial load (see readDanceMovesFromConfig)
+    explicit DanceConfigWatcher(const std::string& config_file_path, const MoveTiming& defaults = MoveTiming())
+        : path_(std::filesystem::absolute(config_file_path)), defaults_(defaults) {}
+
+    DanceConfigWatcher(const DanceConfigWatcher&) = delete;
+    DanceConfigWatcher& operator=(const DanceConfigWatcher&) = delete;
+    ~DanceConfigWatcher() { stop(); }
+
+    // Starts watching; returns false if inotify is unavailable
+    bool start() {
+        fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd_ < 0) return false;
+        std::string directory = path_.parent_path().string();
+        if (inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+            close(fd_);
+            fd_ = -1;
+            return false;
+        }
+        running_ = true;
+        thread_ = std::thread(&DanceConfigWatcher::run, this);
+        return true;
+    }
+
+    void stop() {
+        if (!thread_.joinable()) return;
+        running_ = false;
+        thread_.join();
+        close(fd_);
+        fd_ = -1;
+    }
+
+    // Returns the newest valid dance published since the last call, or nullptr
+    std::shared_ptr<const DanceMoves> takeUpdate() {
+        return std::atomic_exchange(&pending_, std::shared_ptr<const DanceMoves>());
+    }
+
+    uint64_t accepted() const { return accepted_; }
+    uint64_t rejected() const { return rejected_; }
+
+private:
+    static constexpr auto kPollInterval = std::chrono::milliseconds(100);
+    // Editors write in several steps; wait for the file to be quiet this long before parsing
+    static constexpr auto kDebounce = std::chrono::milliseconds(50);
+
+    void run() {
+        alignas(inotify_event) char buffer[4096];
+        bool dirty = false;
+        std::chrono::steady_clock::time_point last_event;
+        while (running_) {
+            pollfd pfd{fd_, POLLIN, 0};
+            int ready = poll(&pfd, 1, static_cast<int>(kPollInterval.count()));
+            if (ready > 0) {
+                ssize_t length;
+                while ((length = read(fd_, buffer, sizeof(buffer))) > 0) {
+                    for (char* p = buffer; p < buffer + length;) {
+                        const inotify_event* event = reinterpret_cast<const inotify_event*>(p);
+                        if (event->len > 0 && path_.filename() == event->name) {
+                            dirty = true;
+                            last_event = std::chrono::steady_clock::now();
+                        }
+                        p += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+            if (dirty && std::chrono::steady_clock::now() - last_event >= kDebounce) {
+                dirty = false;
+                reload();
+            }
+        }
+    }
+
+    void reload() {
+        std::vector<std::string> errors;
+        auto moves = std::make_shared<DanceMoves>(loadDanceMovesStrict(path_.string(), errors, defaults_));
+        // A dance that parses can still leave the arm's range; check it like dance_codegen does
+        checkPositionLimits(*moves, path_.string(), errors);
+        if (!errors.empty()) {
+            rejected_++;
+            std::cerr << "Rejected dance configuration " << path_.string() << " (keeping the current dance):\n";
+            for (const std::string& error : errors) std::cerr << "  " << error << "\n";
+            std::cerr.flush();
+            return;
+        }
+        accepted_++;
+        std::cout << "Validated new dance configuration (" << moves->size()
+                  << " moves), switching at the next cycle boundary" << std::endl;
+        std::atomic_store(&pending_, std::shared_ptr<const DanceMoves>(std::move(moves)));
+    }
+
+    std::filesystem::path path_;
+    MoveTiming defaults_;
+    int fd_ = -1;
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+    std::shared_ptr<const DanceMoves> pending_;
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> rejected_{0};
+};
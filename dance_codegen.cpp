@@ -0,0 +1,109 @@
+// Compiles a dance file into a C++ header for embedded_dance.cpp: the moves become a constexpr
+// DanceMove table, so the embedded runner has no config to parse or allocate at start-up and
+// the compiler sees every target and timing as a constant. The file is parsed strictly (the
+// hot-reload rules of dance_config.h, including the joint position limits), so a bad dance
+// fails the build instead of losing lines at run time. Numbers are written in their shortest
+// round-trip form, so the table holds exactly the values the runtime parser produces.
+// Build with build_dance.sh, run: ./dance_codegen <config-file-path> <header> [--interp NAME]
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dance_config.h"
+#include "time_scaling.h"
+
+namespace {
+
+// Shortest decimal form that reads back as the same double
+std::string literal(double value) {
+    std::array<char, 32> buffer;
+    std::to_chars_result result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+    return std::string(buffer.data(), result.ptr);
+}
+
+template <size_t N>
+std::string literal(const std::array<double, N>& values) {
+    std::string text = "{{";
+    for (size_t i = 0; i < N; i++) text += (i ? ", " : "") + literal(values[i]);
+    return text + "}}";
+}
+
+const char* scalingEnumerator(TimeScaling scaling) {
+    switch (scaling) {
+        case TimeScaling::kSeptic: return "TimeScaling::kSeptic";
+        case TimeScaling::kCubic: return "TimeScaling::kCubic";
+        case TimeScaling::kTrapezoid: return "TimeScaling::kTrapezoid";
+        case TimeScaling::kDoubleS: return "TimeScaling::kDoubleS";
+        default: return "TimeScaling::kQuintic";
+    }
+}
+
+std::string literal(const MoveTiming& timing) {
+    return std::string("{") + scalingEnumerator(timing.scaling) + ", " + literal(timing.velocity_scale) + ", " +
+           literal(timing.dwell) + "}";
+}
+
+std::string quoted(const std::string& text) {
+    std::string result = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') result += '\\';
+        result += c;
+    }
+    return result + "\"";
+}
+
+// One aggregate initializer per move, in DanceMove's member order
+void writeHeader(std::ostream& out, const std::vector<DanceMove>& moves, const std::string& source,
+                 const MoveTiming& defaults) {
+    out << "// Generated by dance_codegen from " << source << "; do not edit, rebuild with build_dance.sh\n"
+        << "#pragma once\n\n"
+        << "#include \"dance_config.h\"\n\n"
+        << "constexpr char kEmbeddedDanceSource[] = " << quoted(source) << ";\n"
+        << "constexpr MoveTiming kEmbeddedDanceDefaults" << literal(defaults) << ";\n\n"
+        << "constexpr DanceMove kEmbeddedDance[] = {\n";
+    for (const DanceMove& move : moves) {
+        out << "    {" << move.move_index << ", " << literal(move.joints) << ", " << literal(move.move_time) << ", "
+            << (move.type == MoveType::kCartesian ? "MoveType::kCartesian" : "MoveType::kJoint") << ", "
+            << literal(move.pose) << ", " << literal(move.timing) << ", " << literal(move.blend_radius) << "},\n";
+    }
+    out << "};\n";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    MoveTiming defaults;
+    bool usage = argc < 3;
+    for (int i = 3; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--interp" && i + 1 < argc && parseTimeScaling(argv[i + 1], defaults.scaling)) {
+            i++;
+        } else {
+            usage = true;
+        }
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " <config-file-path> <header>"
+                  << " [--interp quintic|septic|cubic|trapezoid|double_s]" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::string> errors;
+    std::vector<DanceMove> moves = loadDanceMovesStrict(argv[1], errors, defaults);
+    checkPositionLimits(moves, argv[1], errors);
+    if (!errors.empty()) {
+        for (const std::string& error : errors) std::cerr << error << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(argv[2]);
+    writeHeader(out, moves, argv[1], defaults);
+    if (!out.good()) {
+        std::cerr << "Failed to write " << argv[2] << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << moves.size() << " moves from " << argv[1] << " to " << argv[2] << std::endl;
+    return 0;
+}
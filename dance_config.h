@@ -0,0 +1,334 @@
+// Dance configuration: one DanceMove per line, either a joint-space target
+// "<index> [joint] <7 joint positions> <move time>" or a Cartesian hand pose target
+// "<index> cart <x y z (m)> <rotation vector rx ry rz (rad)> <move time>"; both can be mixed.
+// Optional per-move settings follow the move time as key=value tokens:
+//   dwell_ms=<ms>           pause after the arm has settled at the pose (default 0)
+//   velocity_scale=<k>      0 < k <= 1: the move takes 1/k times its safe duration
+//   blend_radius=<r>        distance from the pose (rad, or m for cart moves) at which the next
+//                           move may take over; validated and carried, moves still stop
+//   interp=<name>           time scaling of the move: quintic (min_jerk), septic (min_snap),
+//                           cubic, trapezoid or double_s (time_scaling.h)
+// Lines without settings are the original format. Lines are tokenized in place with
+// string_view and from_chars, so parsing allocates nothing per line besides the line buffer.
+#pragma once
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include "panda_limits.h"
+#include "time_scaling.h"
+
+enum class MoveType { kJoint, kCartesian };
+
+// Structure to define a dance move (a joint configuration or a hand pose)
+struct DanceMove {
+    int move_index;                                // Index of the move (1, 2, 3, ...)
+    std::array<double, panda::kJoints> joints{};   // Joint configuration for this move (kJoint)
+    double move_time;                              // Time to take for moving to this position (in seconds)
+    MoveType type = MoveType::kJoint;
+    std::array<double, 6> pose{};                  // Hand position and rotation vector in the base frame (kCartesian)
+    MoveTiming timing;                             // interp=, velocity_scale= and dwell_ms=
+    double blend_radius = 0.0;                     // blend_radius= (rad for joint moves, m for Cartesian ones)
+};
+
+// Non-owning view of a dance's moves: a loaded vector or a table compiled into the binary
+// (dance_codegen.cpp)
+class DanceView {
+public:
+    DanceView() = default;
+    DanceView(const std::vector<DanceMove>& moves) : moves_(moves.data()), count_(moves.size()) {}
+    template <size_t N>
+    constexpr DanceView(const DanceMove (&moves)[N]) : moves_(moves), count_(N) {}
+
+    const DanceMove& operator[](size_t i) const { return moves_[i]; }
+    size_t size() const { return count_; }
+    const DanceMove* begin() const { return moves_; }
+    const DanceMove* end() const { return moves_ + count_; }
+
+private:
+    const DanceMove* moves_ = nullptr;
+    size_t count_ = 0;
+};
+
+namespace dance_config_detail {
+
+// Splits the next whitespace-separated token off line; empty at the end or at a # comment
+inline std::string_view nextToken(std::string_view& line) {
+    size_t begin = line.find_first_not_of(" \t\r");
+    if (begin == std::string_view::npos || line[begin] == '#') {
+        line = {};
+        return {};
+    }
+    size_t end = line.find_first_of(" \t\r", begin);
+    if (end == std::string_view::npos) end = line.size();
+    std::string_view token = line.substr(begin, end - begin);
+    line.remove_prefix(end);
+    return token;
+}
+
+// Parses the whole token as a number (a leading '+' is accepted, as operator>> does)
+template <typename T>
+bool parseNumber(std::string_view token, T& value) {
+    if (token.size() > 1 && token[0] == '+') token.remove_prefix(1);
+    const char* end = token.data() + token.size();
+    std::from_chars_result result = std::from_chars(token.data(), end, value);
+    return !token.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+constexpr std::array<std::string_view, 4> kSettingKeys{{"dwell_ms", "velocity_scale", "blend_radius", "interp"}};
+
+inline size_t settingIndex(std::string_view key) {
+    size_t index = 0;
+    while (index < kSettingKeys.size() && kSettingKeys[index] != key) index++;
+    return index;
+}
+
+// Applies one key=value setting to move; false with a message in error for unknown keys and
+// out-of-range values
+inline bool applySetting(std::string_view key, std::string_view value, DanceMove& move, std::string& error) {
+    double number = 0.0;
+    bool numeric = parseNumber(value, number) && std::isfinite(number);
+    if (key == "dwell_ms") {
+        if (numeric && number >= 0.0) {
+            move.timing.dwell = number / 1000.0;
+            return true;
+        }
+        error = "dwell_ms must be a non-negative number of milliseconds";
+    } else if (key == "velocity_scale") {
+        if (numeric && number > 0.0 && number <= 1.0) {
+            move.timing.velocity_scale = number;
+            return true;
+        }
+        error = "velocity_scale must be in (0, 1]";
+    } else if (key == "blend_radius") {
+        if (numeric && number >= 0.0) {
+            move.blend_radius = number;
+            return true;
+        }
+        error = "blend_radius must be a non-negative distance";
+    } else if (key == "interp") {
+        if (parseTimeScaling(value, move.timing.scaling)) return true;
+        error = "interp must be quintic, septic, cubic, trapezoid, double_s, min_jerk or min_snap";
+    } else {
+        error = "unknown setting '" + std::string(key) + "'";
+        return false;
+    }
+    error += ", got '" + std::string(value) + "'";
+    return false;
+}
+
+}  // namespace dance_config_detail
+
+// Parses one move line (not blank, not a comment). Returns false with a message in error.
+// Non-finite values, non-positive move times and repeated settings are errors; trailing tokens
+// are too with strict, and otherwise ignored as they always were.
+inline bool parseMoveLine(std::string_view line, DanceMove& move, bool strict, std::string& error) {
+    using dance_config_detail::nextToken;
+    using dance_config_detail::parseNumber;
+    if (!parseNumber(nextToken(line), move.move_index)) {
+        error = "expected an integer move index";
+        return false;
+    }
+
+    // Target: optional "joint" or "cart" keyword, then 7 joint positions or 6 pose values
+    std::string_view token = nextToken(line);
+    move.type = MoveType::kJoint;
+    if (token == "cart" || token == "joint") {
+        if (token == "cart") move.type = MoveType::kCartesian;
+        token = nextToken(line);
+    }
+    bool cartesian = move.type == MoveType::kCartesian;
+    double* values = cartesian ? move.pose.data() : move.joints.data();
+    size_t count = cartesian ? move.pose.size() : move.joints.size();
+    for (size_t i = 0; i < count; ++i, token = nextToken(line)) {
+        if (!parseNumber(token, values[i])) {
+            error = cartesian ? "expected 6 pose values after 'cart' (x y z rx ry rz), got " + std::to_string(i)
+                              : "expected 7 joint positions, got " + std::to_string(i);
+            return false;
+        }
+        if (!std::isfinite(values[i])) {
+            error = (cartesian ? "pose value " : "joint ") + std::to_string(i + 1) + " is not finite";
+            return false;
+        }
+    }
+
+    if (!parseNumber(token, move.move_time)) {
+        error = cartesian ? "expected a move time after the pose" : "expected a move time after the joint positions";
+        return false;
+    }
+    if (!std::isfinite(move.move_time) || move.move_time <= 0.0) {
+        error = "move time must be a positive number of seconds";
+        return false;
+    }
+
+    // Settings
+    unsigned seen = 0;
+    for (token = nextToken(line); !token.empty(); token = nextToken(line)) {
+        size_t equals = token.find('=');
+        if (equals == std::string_view::npos) {
+            if (!strict) break;
+            error = "unexpected trailing token '" + std::string(token) + "'";
+            return false;
+        }
+        std::string_view key = token.substr(0, equals);
+        if (!dance_config_detail::applySetting(key, token.substr(equals + 1), move, error)) return false;
+        unsigned bit = 1u << dance_config_detail::settingIndex(key);
+        if (seen & bit) {
+            error = "setting '" + std::string(key) + "' given twice";
+            return false;
+        }
+        seen |= bit;
+    }
+    return true;
+}
+
+// Parses a command line option's value of the dance tools with from_chars, as move lines are
+// parsed; NaN, infinities and values outside [min, max] are rejected with a message
+template <typename T>
+bool parseOptionValue(const std::string& option, const char* text, T& value, T min = T(0),
+                      T max = std::numeric_limits<T>::max()) {
+    T parsed;
+    if (!dance_config_detail::parseNumber(text, parsed) || !(parsed >= min && parsed <= max)) {
+        std::cerr << "Invalid value for " << option << ": " << text << std::endl;
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// True for lines that hold no move: blank lines and comments (lines starting with #)
+inline bool isBlankOrComment(std::string_view line) {
+    size_t first = line.find_first_not_of(" \t\r");
+    return first == std::string_view::npos || line[first] == '#';
+}
+
+// Function to read dance moves from a configuration file. Moves start from the timing in
+// defaults (e.g. a --interp choice), which their own settings override. Lines that fail to
+// parse are reported and skipped; the caller checks the position limits (checkPositionLimits).
+inline std::vector<DanceMove> readDanceMovesFromConfig(const std::string& config_file_path,
+                                                       const MoveTiming& defaults = MoveTiming()) {
+    std::vector<DanceMove> dance_moves;
+    std::ifstream config_file(config_file_path);
+
+    if (!config_file.is_open()) {
+        throw std::runtime_error("Failed to open configuration file: " + config_file_path);
+    }
+
+    std::string line;
+    std::string error;
+    while (std::getline(config_file, line)) {
+        // Skip empty lines and comments
+        if (isBlankOrComment(line)) {
+            continue;
+        }
+
+        DanceMove move;
+        move.timing = defaults;
+        if (!parseMoveLine(line, move, false, error)) {
+            std::cerr << "Error parsing line (" << error << "): " << line << std::endl;
+            continue;
+        }
+
+        dance_moves.push_back(move);
+        std::cout << "Loaded move " << move.move_index << " with move time " << move.move_time << "s" << std::endl;
+    }
+
+    if (dance_moves.empty()) {
+        throw std::runtime_error("No valid dance moves found in configuration file");
+    }
+
+    return dance_moves;
+}
+
+// Strict parse used for hot reload: every problem is reported as "<source>:<line>: message"
+// in errors, and the caller should reject the file if any were found. Unlike
+// readDanceMovesFromConfig, trailing tokens and duplicate move indices are errors. Moves start
+// from defaults, as in readDanceMovesFromConfig.
+inline std::vector<DanceMove> parseDanceMovesStrict(std::istream& in, const std::string& source,
+                                                    std::vector<std::string>& errors,
+                                                    const MoveTiming& defaults = MoveTiming()) {
+    std::vector<DanceMove> dance_moves;
+    std::string line;
+    std::string problem;
+    int line_number = 0;
+    auto error = [&](const std::string& message) {
+        errors.push_back(source + ":" + std::to_string(line_number) + ": " + message);
+    };
+
+    while (std::getline(in, line)) {
+        line_number++;
+        if (isBlankOrComment(line)) {
+            continue;
+        }
+
+        DanceMove move;
+        move.timing = defaults;
+        if (!parseMoveLine(line, move, true, problem)) {
+            error(problem);
+            continue;
+        }
+        bool ok = true;
+        for (const DanceMove& other : dance_moves) {
+            if (other.move_index == move.move_index) {
+                error("duplicate move index " + std::to_string(move.move_index));
+                ok = false;
+                break;
+            }
+        }
+        if (ok) dance_moves.push_back(move);
+    }
+
+    if (dance_moves.empty() && errors.empty()) {
+        errors.push_back(source + ": no dance moves");
+    }
+    return dance_moves;
+}
+
+// Strictly parses config_file_path; an unreadable file is reported in errors
+inline std::vector<DanceMove> loadDanceMovesStrict(const std::string& config_file_path,
+                                                   std::vector<std::string>& errors,
+                                                   const MoveTiming& defaults = MoveTiming()) {
+    std::ifstream config_file(config_file_path);
+    if (!config_file.is_open()) {
+        errors.push_back(config_file_path + ": cannot open file");
+        return {};
+    }
+    return parseDanceMovesStrict(config_file, config_file_path, errors, defaults);
+}
+
+// Whether a joint target lies within the Panda's position limits; Cartesian targets are
+// resolved by the IK when they are played
+constexpr bool withinPositionLimits(const DanceMove& move) {
+    if (move.type == MoveType::kCartesian) return true;
+    for (size_t i = 0; i < panda::kJoints; i++) {
+        if (move.joints[i] < panda::kJointPositionMin[i] || move.joints[i] > panda::kJointPositionMax[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Appends an error for every joint target outside the position limits; run on strictly parsed
+// dances before they are accepted (hot reload, dance_codegen)
+inline void checkPositionLimits(const std::vector<DanceMove>& moves, const std::string& source,
+                                std::vector<std::string>& errors) {
+    for (const DanceMove& move : moves) {
+        if (withinPositionLimits(move)) continue;
+        for (size_t i = 0; i < panda::kJoints; i++) {
+            double q = move.joints[i];
+            if (q >= panda::kJointPositionMin[i] && q <= panda::kJointPositionMax[i]) continue;
+            errors.push_back(source + ": move " + std::to_string(move.move_index) + ": joint " +
+                             std::to_string(i + 1) + " target " + std::to_string(q) + " outside its limits [" +
+                             std::to_string(panda::kJointPositionMin[i]) + ", " +
+                             std::to_string(panda::kJointPositionMax[i]) + "]");
+        }
+    }
+}
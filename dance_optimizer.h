@@ -0,0 +1,152 @@
+// Cycle-time optimization for dance configs: the minimum feasible move_time of a quintic (or
+// other time_scaling.h) joint-space segment under per-joint velocity/acceleration/jerk limits (times a safety
+// margin), optionally tightened by pluggable feasibility checks (e.g. torqueBudgetCheck in
+// torque_retiming.h), and
+// a rewrite of the config file that only touches the move-time column.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "joint_motion.h"
+#include "panda_limits.h"
+#include "trajectory_core.h"
+
+struct JointLimits : trajectory::Limits<panda::kJoints> {
+    // Panda limits scaled by `scale` (e.g. 0.9 for a 10% safety margin)
+    static JointLimits panda(double scale = 1.0) { return {trajectory::scaled(trajectory::kPandaArm, scale)}; }
+};
+
+// Extra constraint on a candidate segment duration; must be monotone (feasible at T implies
+// feasible at any longer T)
+using FeasibilityCheck = std::function<bool(const trajectory::ArmVector& q_start,
+                                            const trajectory::ArmVector& q_end, double duration)>;
+
+enum class TimeLimit { kNone, kVelocity, kAcceleration, kJerk, kCheck };
+
+inline const char* timeLimitName(TimeLimit limit) {
+    switch (limit) {
+        case TimeLimit::kVelocity: return "velocity";
+        case TimeLimit::kAcceleration: return "acceleration";
+        case TimeLimit::kJerk: return "jerk";
+        case TimeLimit::kCheck: return "check";
+        default: return "none";
+    }
+}
+
+struct SegmentTiming {
+    double duration = 0.0;
+    TimeLimit limit = TimeLimit::kNone;  // What determined the duration
+    int joint = -1;                      // Limiting joint (0-based) for kinematic limits
+    bool feasible = true;                // False if a check still failed at kMaxCheckedDuration
+};
+
+// Longest duration tried for a check; a segment that fails beyond it (e.g. a pose where gravity
+// alone exceeds the torque budget) never passes
+constexpr double kMaxCheckedDuration = 120.0;
+
+// Minimum duration (rounded up to `resolution`) of a quintic (or `scaling`) segment within
+// `limits` that passes every check. The kinematic bound is closed-form
+// (trajectory::minScaledTime); checks are then satisfied by doubling and bisection. If no
+// duration up to kMaxCheckedDuration passes, that duration is returned with feasible = false.
+inline SegmentTiming minQuinticTime(const trajectory::ArmVector& q_start, const trajectory::ArmVector& q_end,
+                                    const JointLimits& limits, const std::vector<FeasibilityCheck>& checks = {},
+                                    double resolution = 1e-3, TimeScaling scaling = TimeScaling::kQuintic) {
+    trajectory::TimeBound<double> bound = trajectory::minScaledTime(q_start, q_end, limits, scalingPeaks(scaling));
+    SegmentTiming timing;
+    timing.duration = resolution;
+    if (bound.duration > resolution) {
+        constexpr TimeLimit kLimits[] = {TimeLimit::kNone, TimeLimit::kVelocity, TimeLimit::kAcceleration,
+                                         TimeLimit::kJerk};
+        timing.duration = bound.duration;
+        timing.limit = kLimits[bound.derivative];
+        timing.joint = bound.joint;
+    }
+    timing.duration = std::ceil(timing.duration / resolution - 1e-9) * resolution;
+
+    auto feasible = [&](double duration) {
+        for (const FeasibilityCheck& check : checks) {
+            if (!check(q_start, q_end, duration)) return false;
+        }
+        return true;
+    };
+    if (feasible(timing.duration)) return timing;
+
+    double low = timing.duration, high = 2.0 * timing.duration;
+    while (!feasible(high)) {
+        if (high >= kMaxCheckedDuration) {
+            timing.duration = kMaxCheckedDuration;
+            timing.limit = TimeLimit::kCheck;
+            timing.joint = -1;
+            timing.feasible = false;
+            return timing;
+        }
+        low = high;
+        high = std::min(2.0 * high, kMaxCheckedDuration);
+    }
+    while (high - low > resolution) {
+        double mid = 0.5 * (low + high);
+        (feasible(mid) ? high : low) = mid;
+    }
+    timing.duration = std::ceil(high / resolution - 1e-9) * resolution;
+    timing.limit = TimeLimit::kCheck;
+    timing.joint = -1;
+    return timing;
+}
+
+// Token spans (begin, end) of a move line "<index> [joint] <7 joints> <time> [settings]" (the
+// "joint" keyword is skipped); false for comments, blank lines and lines with fewer tokens
+inline bool moveLineTokens(const std::string& line, std::array<std::pair<size_t, size_t>, 9>& tokens) {
+    size_t pos = line.find_first_not_of(" \t\r");
+    if (pos == std::string::npos || line[pos] == '#') return false;
+    for (size_t count = 0; count < 9; count++) {
+        if (pos == std::string::npos || line[pos] == '#') return false;
+        size_t end = line.find_first_of(" \t\r", pos);
+        if (end == std::string::npos) end = line.size();
+        tokens[count] = {pos, end};
+        pos = line.find_first_not_of(" \t\r", end);
+        if (count == 0 && pos != std::string::npos && line.compare(pos, 5, "joint") == 0 &&
+            (pos + 5 == line.size() || line.find_first_of(" \t\r", pos) == pos + 5)) {
+            pos = line.find_first_not_of(" \t\r", pos + 5);
+        }
+    }
+    return true;
+}
+
+// Replaces token `token` of a move line whose spans are `tokens`
+inline void replaceMoveToken(std::string& line, const std::array<std::pair<size_t, size_t>, 9>& tokens,
+                             size_t token, const std::string& value) {
+    line.replace(tokens[token].first, tokens[token].second - tokens[token].first, value);
+}
+
+inline std::string formatMoveTime(double seconds, int precision = 3) {
+    std::ostringstream time;
+    time << std::fixed << std::setprecision(precision) << seconds;
+    return time.str();
+}
+
+// Copies a dance config from in to out, replacing the move time (9th token) of each move
+// listed in move_times (by move index). Comments, blank lines and spacing are preserved.
+inline void rewriteMoveTimes(std::istream& in, std::ostream& out, const std::map<int, double>& move_times,
+                             int precision = 3) {
+    std::string line;
+    std::array<std::pair<size_t, size_t>, 9> tokens;
+    while (std::getline(in, line)) {
+        if (moveLineTokens(line, tokens)) {
+            auto found = move_times.find(std::atoi(line.c_str() + tokens[0].first));
+            if (found != move_times.end()) {
+                replaceMoveToken(line, tokens, 8, formatMoveTime(found->second, precision));
+            }
+        }
+        out << line << '\n';
+    }
+}
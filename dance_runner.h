@@ -0,0 +1,352 @@
+// The dance loop of random_points.cpp, shared with embedded_dance.cpp: command line options,
+// the cycle loop with hot reload, statistics reports and the robot (or simulator) connection.
+// The dance comes either from a config file loaded at start or from a table compiled into the
+// binary (dance_codegen.cpp); both run through the same moves and control callbacks.
+#pragma once
+
+#include <iostream>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <vector>
+#include <string>
+#include <memory>
+#include <csignal>
+#include <franka/robot.h>
+#include <franka/exception.h>
+#include <franka/duration.h>
+#include <franka/model.h>
+#include "cartesian_motion.h"
+#include "config_watcher.h"
+#include "dance_config.h"
+#include "flight_recorder.h"
+#include "joint_motion.h"
+#include "segment_stats.h"
+#include "simulated_robot.h"
+#include "torque_retiming.h"
+
+// Set by SIGUSR1; the dance loop writes the statistics report after the current segment
+inline volatile std::sig_atomic_t report_requested = 0;
+
+inline void onReportSignal(int) { report_requested = 1; }
+
+// Set by SIGINT in the non-interactive modes; the dance stops after the current segment.
+// A second SIGINT falls back to the default handler and terminates immediately.
+inline volatile std::sig_atomic_t stop_requested = 0;
+
+inline void onStopSignal(int) {
+    stop_requested = 1;
+    std::signal(SIGINT, SIG_DFL);
+}
+
+// Command line options following the positional arguments
+struct Options {
+    std::string record_dir;          // Continuous flight recording (empty: ring only)
+    double postmortem_seconds = 10;  // History dumped after a control exception
+    bool simulate = false;           // Run against SimulatedRobot instead of the hostname
+    double sim_missed_ticks = 0.0;   // Simulated packet loss rate (exercises missed-tick handling)
+    std::string stats_json;          // Segment statistics report paths (end of run and SIGUSR1)
+    std::string stats_csv;
+    int cycles = 0;                  // Non-interactive: run exactly this many cycles
+    double run_seconds = 0.0;        // Non-interactive: start no cycle that would end past this budget
+    bool until_signal = false;       // Non-interactive: cycle until SIGINT
+    bool watch_config = false;       // Hot-reload the config file at cycle boundaries
+    size_t plan_cache_size = 0;      // Cached segment plans (0: plan every move)
+    bool torque_retiming = true;     // Stretch segments whose predicted torques would trip the reflex
+    double torque_model_error = TorqueBudget().model_error;
+    SettleOptions settle;            // End-of-move settle detection thresholds and timeout
+    MoveTiming defaults;             // Timing of moves without their own settings (--interp)
+
+    bool interactive() const { return cycles <= 0 && run_seconds <= 0.0 && !until_signal; }
+};
+
+// Parses the options listed in the usage message from argv[first] on; returns false on unknown
+// options and invalid (non-numeric, negative or non-finite) values
+inline bool parseOptions(int argc, char** argv, int first, Options& options) {
+    for (int i = first; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--record-dir" && i + 1 < argc) {
+            options.record_dir = argv[++i];
+        } else if (arg == "--postmortem-seconds" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.postmortem_seconds)) return false;
+        } else if (arg == "--simulate") {
+            options.simulate = true;
+        } else if (arg == "--sim-missed-ticks" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.sim_missed_ticks, 0.0, 1.0)) return false;
+        } else if (arg == "--stats-json" && i + 1 < argc) {
+            options.stats_json = argv[++i];
+        } else if (arg == "--stats-csv" && i + 1 < argc) {
+            options.stats_csv = argv[++i];
+        } else if (arg == "--cycles" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.cycles)) return false;
+        } else if (arg == "--duration" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.run_seconds)) return false;
+        } else if (arg == "--until-signal") {
+            options.until_signal = true;
+        } else if (arg == "--watch-config") {
+            options.watch_config = true;
+        } else if (arg == "--plan-cache" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.plan_cache_size)) return false;
+        } else if (arg == "--no-torque-retiming") {
+            options.torque_retiming = false;
+        } else if (arg == "--torque-model-error" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.torque_model_error)) return false;
+        } else if (arg == "--settle-timeout" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.settle.timeout)) return false;
+        } else if (arg == "--settle-velocity" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.settle.velocity)) return false;
+        } else if (arg == "--settle-position" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.settle.position)) return false;
+        } else if (arg == "--interp" && i + 1 < argc) {
+            if (!parseTimeScaling(argv[++i], options.defaults.scaling)) {
+                std::cerr << "Unknown time scaling: " << argv[i] << std::endl;
+                return false;
+            }
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Prints the segment statistics and writes the requested JSON/CSV reports
+inline void writeReport(const SegmentStats& stats, const Options& options) {
+    stats.printTable(std::cout);
+    if (!options.stats_json.empty() && !stats.writeJson(options.stats_json)) {
+        std::cerr << "Failed to write " << options.stats_json << std::endl;
+    }
+    if (!options.stats_csv.empty() && !stats.writeCsv(options.stats_csv)) {
+        std::cerr << "Failed to write " << options.stats_csv << std::endl;
+    }
+    std::cout.flush();
+}
+
+// Moves to a dance move's target, in joint or Cartesian space, with its timing settings
+template <typename Robot>
+MoveResult moveTo(Robot& robot, const DanceMove& move, double desired_duration, MoveContext& context) {
+    if (move.type == MoveType::kCartesian) {
+        return moveCartesian(robot, move.pose, desired_duration, context, move.timing);
+    }
+    return moveJoints(robot, move.joints, desired_duration, context, move.timing);
+}
+
+// Every move is its own control session, so the arm comes to rest at each pose; a blend radius
+// is accepted (dance_validator reports it) but not acted on here
+inline void noteBlendRadius(DanceView moves) {
+    for (const DanceMove& move : moves) {
+        if (move.blend_radius > 0.0) {
+            std::cout << "Note: blend_radius is not executed yet, every move still stops at its pose" << std::endl;
+            return;
+        }
+    }
+}
+
+// Runs the dance on a connected robot (franka::Robot or SimulatedRobot): the embedded moves, or
+// with none the moves loaded from config_file_path
+template <typename Robot>
+int runDance(Robot& robot, const std::string& config_file_path, DanceView embedded,
+             flight_recorder::FlightRecorder& recorder, const std::string& postmortem_dir, const Options& options) {
+    std::unique_ptr<PlanCache> plan_cache;
+    if (options.plan_cache_size > 0) {
+        plan_cache = std::make_unique<PlanCache>(options.plan_cache_size);
+    }
+    PlanCache::Planner planner;
+    if (options.torque_retiming) {
+        TorqueBudget budget;
+        budget.model_error = options.torque_model_error;
+        planner = torqueAwarePlanner(budget);
+    }
+    MoveContext context{recorder, postmortem_dir, options.postmortem_seconds, plan_cache.get(), planner,
+                        options.settle, options.torque_retiming ? options.torque_model_error : NAN};
+    std::signal(SIGUSR1, onReportSignal);
+    if (!options.interactive()) {
+        std::signal(SIGINT, onStopSignal);
+    }
+    
+    // Read dance moves from configuration file, unless they are compiled in
+    std::vector<DanceMove> loaded_moves;
+    std::shared_ptr<const DanceMoves> reloaded_moves;
+    DanceView dance_moves = embedded;
+    if (embedded.size() > 0) {
+        std::cout << "Using the embedded dance compiled from " << config_file_path << " (" << embedded.size()
+                  << " moves)" << std::endl;
+    } else {
+        std::cout << "Reading dance moves from configuration file: " << config_file_path << std::endl;
+        loaded_moves = readDanceMovesFromConfig(config_file_path, options.defaults);
+        // Checked like a hot reload (config_watcher.h)
+        std::vector<std::string> errors;
+        checkPositionLimits(loaded_moves, config_file_path, errors);
+        if (!errors.empty()) {
+            for (const std::string& error : errors) std::cerr << error << std::endl;
+            return 1;
+        }
+        dance_moves = loaded_moves;
+    }
+    noteBlendRadius(dance_moves);
+    
+    std::unique_ptr<DanceConfigWatcher> watcher;
+    if (options.watch_config) {
+        watcher = std::make_unique<DanceConfigWatcher>(config_file_path, options.defaults);
+        if (watcher->start()) {
+            std::cout << "Watching " << config_file_path << " for changes" << std::endl;
+        } else {
+            std::cerr << "Failed to watch " << config_file_path << ", hot reload disabled" << std::endl;
+            watcher.reset();
+        }
+    }
+    
+    std::cout << "Dance sequence starting..." << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    std::cout << "| From | To | Desired | Actual |" << std::endl;
+    std::cout << "----------------------------" << std::endl;
+    
+    // Move to the first dance pose as the starting position.
+    std::cout << "Moving to initial dance pose (Move " << dance_moves[0].move_index << ")..." << std::endl;
+    MoveResult initial_move = moveTo(robot, dance_moves[0], dance_moves[0].move_time,
+                                     context);  // Use time from config
+    if (!initial_move.success) {
+        std::cerr << "Failed to move to initial pose. Exiting." << std::endl;
+        return 1;
+    }
+    
+    SegmentStats stats;
+    
+    auto run_start = std::chrono::steady_clock::now();
+    size_t completed_cycles = 0;  // Across reloads; stats restart with every new dance
+    bool repeat = true;
+    // Repeat the dance cycle until the run mode says stop (cycle count, time budget, SIGINT or the user).
+    while (repeat) {
+        // Switch to a reloaded dance at the cycle boundary, starting with a move to its first pose
+        std::shared_ptr<const DanceMoves> update = watcher ? watcher->takeUpdate() : nullptr;
+        if (update) {
+            if (stats.cycles() > 0) {
+                writeReport(stats, options);
+            }
+            stats = SegmentStats();
+            reloaded_moves = update;
+            dance_moves = *reloaded_moves;
+            noteBlendRadius(dance_moves);
+            std::cout << "Switching to the reloaded dance, moving to its first pose (Move "
+                      << dance_moves[0].move_index << ")..." << std::endl;
+            MoveResult transition = moveTo(robot, dance_moves[0], dance_moves[0].move_time, context);
+            if (!transition.success) {
+                recoverRobot(robot);
+            }
+        }
+        
+        auto cycle_start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < dance_moves.size() && !stop_requested; i++) {
+            // Calculate the next index (wraps back to the first pose at the end).
+            size_t next_index = (i + 1) % dance_moves.size();
+            int from_move = dance_moves[i].move_index;
+            int to_move = dance_moves[next_index].move_index;
+            double desired_time = dance_moves[next_index].move_time;
+            
+            std::cout << "Moving from pose " << from_move << " to pose " << to_move 
+                      << " (Target: " << desired_time << "s)..." << std::endl;
+            MoveResult move = moveTo(robot, dance_moves[next_index], desired_time, context);
+            std::cout << "| " << from_move << " | " << to_move 
+                      << " | " << desired_time << "s | " 
+                      << (move.success ? std::to_string(move.actual_duration) + "s" : "FAILED") 
+                      << " |" << std::endl;
+            
+            if (!move.success) {
+                recoverRobot(robot);
+                move.recoveries += 1;
+            }
+            stats.add(i, from_move, to_move, move);
+            
+            if (report_requested) {
+                report_requested = 0;
+                writeReport(stats, options);
+            }
+        }
+        if (stop_requested) {
+            std::cout << "\nStop requested, ending after the current segment." << std::endl;
+            break;
+        }
+        auto cycle_end = std::chrono::steady_clock::now();
+        std::chrono::duration<double> cycle_time = cycle_end - cycle_start;
+        std::chrono::duration<double> run_time = cycle_end - run_start;
+        stats.endCycle(cycle_time.count());
+        completed_cycles++;
+        std::cout << "Completed cycle " << completed_cycles << " in " << cycle_time.count() << "s" << std::endl;
+        
+        if (options.cycles > 0) {
+            repeat = completed_cycles < static_cast<size_t>(options.cycles);
+        } else if (options.run_seconds > 0.0) {
+            // Only start another cycle if it should finish within the budget
+            repeat = run_time.count() + cycle_time.count() <= options.run_seconds;
+        } else if (!options.until_signal) {
+            std::cout << "\nCompleted one full dance cycle. Continue? (y/n): ";
+            char response;
+            std::cin >> response;
+            if(response != 'y' && response != 'Y') {
+                repeat = false;
+            }
+        }
+    }
+    
+    writeReport(stats, options);
+    if (plan_cache) {
+        const PlanCache::Counters& counters = plan_cache->counters();
+        std::cout << "Plan cache: " << counters.hits << " hits, " << counters.misses << " misses, "
+                  << counters.evictions << " evictions; "
+                  << (counters.misses ? counters.plan_seconds / counters.misses * 1e6 : 0.0) << " us/plan, "
+                  << (counters.hits ? counters.lookup_seconds / counters.hits * 1e6 : 0.0) << " us/hit" << std::endl;
+    }
+    std::cout << "Dance sequence completed!" << std::endl;
+    return 0;
+}
+
+// Sets up the flight recorder, connects to the robot at hostname (or starts the simulated robot
+// with --simulate) and runs the dance (see runDance); returns the process exit code
+inline int connectAndRunDance(const std::string& hostname, const std::string& config_file_path, DanceView embedded,
+                              const Options& options) {
+    // Always-on flight recorder; with --record-dir every tick is also flushed to DIR/*.npy
+    flight_recorder::FlightRecorder recorder(std::max(30.0, options.postmortem_seconds));
+    std::string postmortem_dir = options.record_dir.empty() ? "." : options.record_dir;
+    if (!options.record_dir.empty()) {
+        if (!recorder.startFlushing(options.record_dir)) {
+            std::cerr << "Failed to open flight recorder output in " << options.record_dir << std::endl;
+            return 1;
+        }
+        std::cout << "Recording control ticks to " << options.record_dir << std::endl;
+    }
+    
+    try {
+        if (options.simulate) {
+            std::cout << "Using simulated robot (no connection to " << hostname << ")" << std::endl;
+            SimulatedRobot::Options sim_options;
+            sim_options.missed_tick_rate = options.sim_missed_ticks;
+            SimulatedRobot robot(kPandaHome, sim_options);
+            return runDance(robot, config_file_path, embedded, recorder, postmortem_dir, options);
+        }
+        
+        // Connect to the robot.
+        std::cout << "Connecting to robot at " << hostname << "..." << std::endl;
+        franka::Robot robot(hostname);
+        
+        // Load the robot model.
+        std::cout << "Loading robot model..." << std::endl;
+        franka::Model model = robot.loadModel();
+        
+        // Set the default collision behavior (using conservative limits).
+        std::cout << "Setting collision behavior..." << std::endl;
+        robot.setCollisionBehavior(panda::kJointContactTorque, panda::kJointCollisionTorque,
+                                   panda::kCartesianContactForce, panda::kCartesianCollisionForce);
+        
+        return runDance(robot, config_file_path, embedded, recorder, postmortem_dir, options);
+        
+    } catch (const franka::Exception& e) {
+        std::cerr << "Franka exception: " << e.what() << std::endl;
+        return 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Exception: " << e.what() << std::endl;
+        return 1;
+    }
+    
+    return 0;
+}
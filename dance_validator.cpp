@@ -0,0 +1,718 @@
+// Offline dance validator: vets dance configs before they reach the robot.
+// For every segment of the cycle (as random_points runs it, wrapping back to the first move)
+// it reports the effective time after getSafeMovementTime's scaling and the move's velocity_scale,
+// the analytic peak joint velocity/acceleration/jerk of its time scaling against the Panda limits,
+// the joint-limit
+// margin, the peak predicted torque against the collision budget (torque_retiming.h) and the
+// tracking error, session length and end-of-move settle time (SettlingMotion, as random_points
+// runs it) on the simulated robot. Segments over the torque budget
+// are simulated retimed, as random_points plays them; with --no-torque-retiming they count as
+// violations instead. The cycle time includes every move's dwell, and a blend radius over half
+// of an adjacent segment is a violation. Files are validated in parallel; the exit status is
+// non-zero if any file has a violation.
+//
+// Cartesian moves are simulated with the robot's IK stand-in (simulated_robot.h) from the
+// joint configuration the previous move ends in, starting from the ready pose; their joint
+// peaks and margins come from the simulated command stream, plus the Cartesian speed limits
+// and whether the IK reaches the target pose. --optimize and --reorder are joint-space only.
+//
+// With --optimize, each file's move times are instead set to the minimum feasible time per
+// segment under the limits scaled by (1 - margin), and the predicted cycle time before and after
+// is reported. The result is written to <file>.optimized (or in place); only the move-time
+// column changes, comments are kept.
+//
+// With --reorder, the waypoints are additionally visited in the order that minimizes the cycle
+// time (see waypoint_order.h), for dances where only the set of poses matters. The first move
+// stays first; the result is written to <file>.reordered (or in place).
+//
+// Usage: ./dance_validator [-j THREADS] [--limit-scale S] [--per-joint]
+//            [--no-torque-retiming] [--torque-model-error F] [--interp NAME] dance.cfg [more.cfg ...]
+//        ./dance_validator --optimize [--margin 0.1] [--in-place] dance.cfg [more.cfg ...]
+//        ./dance_validator --reorder [--margin 0.1] [--in-place] dance.cfg [more.cfg ...]
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cartesian_motion.h"
+#include "dance_config.h"
+#include "dance_optimizer.h"
+#include "joint_motion.h"
+#include "panda_kinematics.h"
+#include "panda_limits.h"
+#include "simulated_robot.h"
+#include "torque_retiming.h"
+#include "trajectory_core.h"
+#include "waypoint_order.h"
+
+namespace {
+
+enum class Mode { kValidate, kOptimize, kReorder };
+
+struct Options {
+    Mode mode = Mode::kValidate;
+    std::vector<std::string> files;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double limit_scale = 1.0;  // Fraction of the Panda vel/acc/jerk limits allowed
+    bool per_joint = false;
+    double margin = 0.1;       // Optimizer: stay this fraction below the limits
+    bool in_place = false;
+    bool torque_retiming = true;  // Predict segments as random_points retimes them
+    TorqueBudget torque_budget;
+    MoveTiming defaults;          // --interp: time scaling of moves without interp=
+};
+
+struct SegmentReport {
+    int from = 0;
+    int to = 0;
+    bool cartesian = false;
+    std::string settings;         // Non-default move settings, for the table
+    double desired = 0.0;
+    double effective = 0.0;
+    std::array<double, 7> peak_dq{}, peak_ddq{}, peak_dddq{};
+    double min_margin = 0.0;      // Smallest distance to a joint position limit (rad)
+    int min_margin_joint = 0;
+    double torque_peak = 0.0;     // Predicted torque / budget before retiming
+    int torque_joint = 0;
+    double retimed = 0.0;         // Duration after torque retiming
+    bool torque_ok = true;        // Within the torque budget as played (retimed or not)
+    double session_time = 0.0;    // Simulated control session length, settling included (s)
+    double settle_time = 0.0;     // Simulated hold until settled (s)
+    double dwell = 0.0;           // Pause after the move (s)
+    double tracking_error = 0.0;  // Simulated max |q_d - q| (rad)
+    std::vector<std::string> violations;
+};
+
+// Peak derivatives of a straight segment in the given time scaling, per joint (acceleration
+// steps of the cubic and trapezoid count as jerk over one tick)
+void segmentPeaks(const std::array<double, 7>& q_start, const std::array<double, 7>& q_end, double T,
+                  TimeScaling scaling, SegmentReport& report) {
+    trajectory::SegmentPeaks<7, double> peaks = trajectory::segmentPeaks(q_start, q_end, T, scalingPeaks(scaling));
+    report.peak_dq = peaks.velocity;
+    report.peak_ddq = peaks.acceleration;
+    report.peak_dddq = peaks.jerk;
+}
+
+// Straight joint-space paths reach their extremes at the endpoints
+void limitMargins(const std::array<double, 7>& q_start, const std::array<double, 7>& q_end, SegmentReport& report) {
+    int end_joint = 0;
+    double end_margin = trajectory::limitMargin(q_end, trajectory::kPandaArm, &end_joint);
+    report.min_margin = trajectory::limitMargin(q_start, trajectory::kPandaArm, &report.min_margin_joint);
+    if (end_margin < report.min_margin) {
+        report.min_margin = end_margin;
+        report.min_margin_joint = end_joint;
+    }
+}
+
+// Samples the segment over T in the given time scaling and, unless disabled, retimes it for the
+// torque budget
+SegmentPlan planSegment(const std::array<double, 7>& q_start, const std::array<double, 7>& q_end, double T,
+                        TimeScaling scaling, const Options& options, SegmentReport& report) {
+    SegmentPlan plan;
+    plan.q_start = q_start;
+    plan.q_target = q_end;
+    plan.desired_duration = plan.safe_duration = T;
+    plan.scaling = scaling;
+    samplePlan(plan, scalingFunction(scaling));
+    if (options.torque_retiming) {
+        RetimeResult retime = retimeForTorque(plan, options.torque_budget);
+        report.torque_peak = retime.peak_before;
+        report.torque_joint = retime.worst_joint;
+        report.torque_ok = retime.converged;
+    } else {
+        std::vector<double> ratios = torqueBudgetRatios(plan.samples, options.torque_budget, &report.torque_joint);
+        report.torque_peak = *std::max_element(ratios.begin(), ratios.end());
+        report.torque_ok = report.torque_peak <= 1.0;
+    }
+    report.retimed = plan.safe_duration;
+    return plan;
+}
+
+// Runs the segment's control callback on a (non-real-time) simulated robot
+void simulate(const SegmentPlan& plan, SegmentReport& report) {
+    SimulatedRobot::Options sim_options;
+    sim_options.real_time = false;
+    SimulatedRobot robot(plan.q_start, sim_options);
+    SampledJointMotion motion(plan, plan.q_start);
+    SettlingMotion<SampledJointMotion> settling(motion, SettleOptions());
+    double tracking_error = 0.0;
+    robot.control([&](const franka::RobotState& state, franka::Duration period) {
+        for (size_t i = 0; i < 7; i++) {
+            tracking_error = std::max(tracking_error, std::abs(state.q_d[i] - state.q[i]));
+        }
+        return settling(state, period);
+    });
+    report.session_time = robot.state().time.toSec();
+    report.settle_time = settling.settleTime();
+    report.tracking_error = tracking_error;
+}
+
+// Peak joint derivatives and the smallest joint-limit margin of a commanded stream at 1 kHz
+void sampledPeaks(const std::vector<std::array<double, 7>>& samples, SegmentReport& report) {
+    constexpr double h = 0.001;
+    report.min_margin = INFINITY;
+    for (size_t k = 0; k < samples.size(); k++) {
+        for (size_t i = 0; i < 7; i++) {
+            double q = samples[k][i];
+            double margin = std::min(q - panda::kJointPositionMin[i], panda::kJointPositionMax[i] - q);
+            if (margin < report.min_margin) {
+                report.min_margin = margin;
+                report.min_margin_joint = i;
+            }
+            if (k + 1 < samples.size()) {
+                report.peak_dq[i] = std::max(report.peak_dq[i], std::abs(samples[k + 1][i] - q) / h);
+            }
+            if (k >= 1 && k + 1 < samples.size()) {
+                double ddq = (samples[k + 1][i] - 2.0 * q + samples[k - 1][i]) / (h * h);
+                report.peak_ddq[i] = std::max(report.peak_ddq[i], std::abs(ddq));
+            }
+            if (k >= 1 && k + 2 < samples.size()) {
+                double dddq = (samples[k + 2][i] - 3.0 * samples[k + 1][i] + 3.0 * q - samples[k - 1][i]) / (h * h * h);
+                report.peak_dddq[i] = std::max(report.peak_dddq[i], std::abs(dddq));
+            }
+        }
+    }
+}
+
+// Simulates a Cartesian move from joint configuration q_start (see cartesian_motion.h); fills in
+// the report from the commanded joint stream, checks the Cartesian limits and the IK, and
+// returns the configuration the move ends in
+std::array<double, 7> simulateCartesian(const std::array<double, 7>& q_start, const DanceMove& to,
+                                        const Options& options, SegmentReport& report) {
+    SimulatedRobot::Options sim_options;
+    sim_options.real_time = false;
+    SimulatedRobot robot(q_start, sim_options);
+    HandPose start = handPoseFromMatrix(robot.state().O_T_EE);
+    HandPose goal = handPoseFromTarget(to.pose);
+    report.effective = std::max(to.move_time, minSafeCartesianTime(start, goal)) / to.timing.velocity_scale;
+    CartesianLinearMotion motion(goal, report.effective, scalingFunction(to.timing.scaling));
+    SettlingMotion<CartesianLinearMotion> settling(motion, SettleOptions());
+    std::vector<std::array<double, 7>> samples;
+    samples.reserve(static_cast<size_t>(report.effective * 1010.0) + 2);
+    double tracking_error = 0.0;
+    robot.control([&](const franka::RobotState& state, franka::Duration period) {
+        samples.push_back(state.q_d);
+        for (size_t i = 0; i < 7; i++) {
+            tracking_error = std::max(tracking_error, std::abs(state.q_d[i] - state.q[i]));
+        }
+        return settling(state, period);
+    });
+    samples.push_back(robot.state().q_d);
+    report.session_time = robot.state().time.toSec();
+    report.settle_time = settling.settleTime();
+    report.tracking_error = tracking_error;
+    report.retimed = report.effective;
+    // Past the reachable workspace the IK jumps between branches, so the joint peaks mean nothing
+    HandPose reached = handPoseFromMatrix(robot.state().O_T_EE_c);
+    if (translationDistance(reached, goal) > 1e-4 || rotationAngle(reached, goal) > 1e-3) {
+        std::ostringstream message;
+        message << "target pose not reachable: IK stops " << translationDistance(reached, goal) * 1000.0
+                << " mm / " << rotationAngle(reached, goal) << " rad away";
+        report.violations.push_back(message.str());
+        return robot.state().q_d;
+    }
+    sampledPeaks(samples, report);
+    std::vector<double> ratios = torqueBudgetRatios(samples, options.torque_budget, &report.torque_joint);
+    report.torque_peak = *std::max_element(ratios.begin(), ratios.end());
+    report.torque_ok = report.torque_peak <= 1.0;
+
+    auto limit = [&](const char* name, double peak, double max, const char* unit) {
+        if (peak <= max * options.limit_scale) return;
+        std::ostringstream message;
+        message << "hand peak " << name << " " << peak << " " << unit << " exceeds " << max * options.limit_scale
+                << " " << unit;
+        report.violations.push_back(message.str());
+    };
+    double T = report.effective, distance = translationDistance(start, goal), angle = rotationAngle(start, goal);
+    ScalingPeaks peaks = scalingPeaks(to.timing.scaling);
+    limit("velocity", peaks.velocity * distance / T, panda::kCartesianVelocityMax, "m/s");
+    limit("acceleration", peaks.acceleration * distance / (T * T), panda::kCartesianAccelerationMax, "m/s^2");
+    limit("angular velocity", peaks.velocity * angle / T, panda::kCartesianAngularVelocityMax, "rad/s");
+    limit("angular acceleration", peaks.acceleration * angle / (T * T), panda::kCartesianAngularAccelerationMax,
+          "rad/s^2");
+    return robot.state().q_d;
+}
+
+// Joint configuration each move ends in: joint moves are their targets, Cartesian moves are
+// simulated from the previous move. Starts from the ready pose and goes around the cycle twice,
+// so a leading Cartesian move starts where the cycle ends.
+std::vector<std::array<double, 7>> resolveJoints(const std::vector<DanceMove>& moves, const Options& options) {
+    std::vector<std::array<double, 7>> joints(moves.size());
+    std::array<double, 7> q = kPandaHome;
+    for (size_t pass = 0; pass < 2; pass++) {
+        for (size_t i = 0; i < moves.size(); i++) {
+            if (moves[i].type == MoveType::kCartesian) {
+                SegmentReport scratch;
+                q = simulateCartesian(q, moves[i], options, scratch);
+            } else {
+                q = moves[i].joints;
+            }
+            joints[i] = q;
+        }
+    }
+    return joints;
+}
+
+bool hasCartesianMoves(const std::vector<DanceMove>& moves) {
+    return std::any_of(moves.begin(), moves.end(),
+                       [](const DanceMove& move) { return move.type == MoveType::kCartesian; });
+}
+
+// Non-default settings of a move, e.g. " septic, 50% speed, dwell 250 ms"
+std::string moveSettings(const DanceMove& move) {
+    std::ostringstream out;
+    const char* separator = " ";
+    if (move.timing.scaling != TimeScaling::kQuintic) {
+        out << separator << timeScalingName(move.timing.scaling);
+        separator = ", ";
+    }
+    if (move.timing.velocity_scale != 1.0) {
+        out << separator << std::setprecision(3) << 100.0 * move.timing.velocity_scale << "% speed";
+        separator = ", ";
+    }
+    if (move.timing.dwell != 0.0) {
+        out << separator << "dwell " << std::setprecision(4) << move.timing.dwell * 1000.0 << " ms";
+        separator = ", ";
+    }
+    if (move.blend_radius > 0.0) {
+        out << separator << "blend " << move.blend_radius;
+    }
+    return out.str();
+}
+
+// Distance between two resolved configurations in the move's blend units: joint-space norm
+// (rad) for joint moves, hand translation (m) for Cartesian ones
+double blendDistance(const DanceMove& move, const std::array<double, 7>& a, const std::array<double, 7>& b) {
+    if (move.type == MoveType::kCartesian) {
+        panda::Vec3 p = panda::forwardKinematics(a).tcp();
+        panda::Vec3 q = panda::forwardKinematics(b).tcp();
+        return std::sqrt((p[0] - q[0]) * (p[0] - q[0]) + (p[1] - q[1]) * (p[1] - q[1]) + (p[2] - q[2]) * (p[2] - q[2]));
+    }
+    double sum = 0.0;
+    for (size_t i = 0; i < 7; i++) sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return std::sqrt(sum);
+}
+
+// A blend radius must leave at least half of the segments into and out of the pose
+void checkBlendRadius(const std::vector<DanceMove>& moves, const std::vector<std::array<double, 7>>& joints,
+                      size_t index, std::vector<std::string>& violations) {
+    const DanceMove& move = moves[index];
+    if (move.blend_radius <= 0.0) return;
+    size_t n = moves.size();
+    double shorter = std::min(blendDistance(move, joints[(index + n - 1) % n], joints[index]),
+                              blendDistance(move, joints[index], joints[(index + 1) % n]));
+    if (move.blend_radius > 0.5 * shorter) {
+        std::ostringstream message;
+        message << "blend_radius " << move.blend_radius << " exceeds half of the shorter adjacent segment ("
+                << 0.5 * shorter << (move.type == MoveType::kCartesian ? " m)" : " rad)");
+        violations.push_back(message.str());
+    }
+}
+
+void checkLimits(const SegmentReport& segment, const Options& options, std::vector<std::string>& violations) {
+    double limit_scale = options.limit_scale;
+    auto check = [&](const char* name, const std::array<double, 7>& peak, const std::array<double, 7>& limit,
+                     const char* unit) {
+        for (size_t i = 0; i < 7; i++) {
+            if (peak[i] > limit[i] * limit_scale) {
+                std::ostringstream message;
+                message << "joint " << i + 1 << " peak " << name << " " << peak[i] << " " << unit << " exceeds "
+                        << limit[i] * limit_scale << " " << unit;
+                violations.push_back(message.str());
+            }
+        }
+    };
+    check("velocity", segment.peak_dq, panda::kJointVelocityMax, "rad/s");
+    check("acceleration", segment.peak_ddq, panda::kJointAccelerationMax, "rad/s^2");
+    check("jerk", segment.peak_dddq, panda::kJointJerkMax, "rad/s^3");
+    if (segment.min_margin < 0.0) {
+        std::ostringstream message;
+        message << "joint " << segment.min_margin_joint + 1 << " is " << -segment.min_margin
+                << " rad outside its position limits";
+        violations.push_back(message.str());
+    }
+    if (!segment.torque_ok) {
+        std::ostringstream message;
+        message << "joint " << segment.torque_joint + 1 << " predicted torque at " << std::fixed
+                << std::setprecision(0) << 100.0 * segment.torque_peak << "% of the torque budget"
+                << (options.torque_retiming && !segment.cartesian ? " even after retiming" : "");
+        violations.push_back(message.str());
+    }
+}
+
+// Index of the largest peak relative to its limit
+size_t worstJoint(const std::array<double, 7>& peak, const std::array<double, 7>& limit) {
+    size_t worst = 0;
+    for (size_t i = 1; i < 7; i++) {
+        if (peak[i] / limit[i] > peak[worst] / limit[worst]) worst = i;
+    }
+    return worst;
+}
+
+std::string formatPeak(const std::array<double, 7>& peak, const std::array<double, 7>& limit) {
+    size_t j = worstJoint(peak, limit);
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(2) << peak[j] << " (j" << j + 1 << " "
+        << std::setprecision(0) << 100.0 * peak[j] / limit[j] << "%)";
+    return out.str();
+}
+
+// Validates one file; returns its report text and sets `violations` to the number found
+std::string validateFile(const std::string& path, const Options& options, size_t& violations) {
+    std::ostringstream out;
+    std::vector<std::string> errors;
+    std::vector<DanceMove> moves = loadDanceMovesStrict(path, errors, options.defaults);
+    if (!errors.empty()) {
+        out << path << ": INVALID\n";
+        for (const std::string& error : errors) out << "  " << error << "\n";
+        violations = errors.size();
+        return out.str();
+    }
+
+    std::vector<std::array<double, 7>> joints = resolveJoints(moves, options);
+    std::vector<SegmentReport> segments;
+    for (size_t i = 0; i < moves.size(); i++) {
+        const std::array<double, 7>& from = joints[i];
+        const DanceMove& to = moves[(i + 1) % moves.size()];
+        SegmentReport segment;
+        segment.from = moves[i].move_index;
+        segment.to = to.move_index;
+        segment.desired = to.move_time;
+        segment.settings = moveSettings(to);
+        segment.dwell = to.timing.dwell;
+        if (to.type == MoveType::kCartesian) {
+            segment.cartesian = true;
+            simulateCartesian(from, to, options, segment);
+        } else {
+            segment.effective =
+                std::max(to.move_time, minSafeMovementTime(from, to.joints)) / to.timing.velocity_scale;
+            segmentPeaks(from, to.joints, segment.effective, to.timing.scaling, segment);
+            limitMargins(from, to.joints, segment);
+            simulate(planSegment(from, to.joints, segment.effective, to.timing.scaling, options, segment), segment);
+        }
+        checkLimits(segment, options, segment.violations);
+        checkBlendRadius(moves, joints, (i + 1) % moves.size(), segment.violations);
+        segments.push_back(segment);
+    }
+
+    double motion_time = 0.0, settle_time = 0.0, dwell_time = 0.0;
+    violations = 0;
+    for (const SegmentReport& segment : segments) {
+        motion_time += segment.session_time - segment.settle_time;
+        settle_time += segment.settle_time;
+        dwell_time += segment.dwell;
+        violations += segment.violations.size();
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << path << ": " << moves.size() << " moves, predicted cycle " << motion_time + settle_time + dwell_time
+        << " s (" << motion_time << " s motion + " << settle_time << " s settle + " << dwell_time << " s dwell), "
+        << (violations ? std::to_string(violations) + " violations" : std::string("OK")) << "\n";
+    out << "| From | To | Desired | Effective | Peak dq rad/s | Peak ddq rad/s^2 | Peak dddq rad/s^3"
+        << " | Limit margin rad | Torque budget | Retimed | Sim tracking mrad | Sim settle ms |\n";
+    for (const SegmentReport& s : segments) {
+        out << "| " << s.from << " | " << s.to << (s.cartesian ? " cart" : "") << s.settings << " | "
+            << std::setprecision(3)
+            << s.desired << " | " << s.effective
+            << " | " << formatPeak(s.peak_dq, panda::kJointVelocityMax)
+            << " | " << formatPeak(s.peak_ddq, panda::kJointAccelerationMax)
+            << " | " << formatPeak(s.peak_dddq, panda::kJointJerkMax)
+            << " | " << std::setprecision(3) << s.min_margin << " (j" << s.min_margin_joint + 1 << ")"
+            << " | " << std::setprecision(0) << 100.0 * s.torque_peak << "% (j" << s.torque_joint + 1 << ")"
+            << " | " << std::setprecision(3) << s.retimed
+            << " | " << std::setprecision(2) << s.tracking_error * 1000
+            << " | " << std::setprecision(0) << s.settle_time * 1000 << " |\n";
+        if (options.per_joint) {
+            out << std::setprecision(3);
+            for (size_t i = 0; i < 7; i++) {
+                out << "    j" << i + 1 << ": dq " << s.peak_dq[i] << " ddq " << s.peak_ddq[i]
+                    << " dddq " << s.peak_dddq[i] << "\n";
+            }
+        }
+        for (const std::string& violation : s.violations) {
+            out << "  VIOLATION " << s.from << " -> " << s.to << ": " << violation << "\n";
+        }
+    }
+    return out.str();
+}
+
+// Predicted cycle time on the simulated robot: control sessions plus dwell, for the given
+// velocity-limited time of each move (time to reach moves[i] from the previous move, before the
+// move's velocity scale). reports, if given, receives each segment's report indexed like times.
+double predictCycleTime(const std::vector<DanceMove>& moves, const std::vector<double>& times,
+                        const Options& options, std::vector<SegmentReport>* reports = nullptr) {
+    double cycle = 0.0;
+    if (reports != nullptr) reports->assign(moves.size(), SegmentReport());
+    for (size_t i = 0; i < moves.size(); i++) {
+        size_t next = (i + 1) % moves.size();
+        const MoveTiming& timing = moves[next].timing;
+        SegmentReport segment;
+        simulate(planSegment(moves[i].joints, moves[next].joints, times[next] / timing.velocity_scale,
+                             timing.scaling, options, segment),
+                 segment);
+        cycle += segment.session_time + timing.dwell;
+        if (reports != nullptr) (*reports)[next] = segment;
+    }
+    return cycle;
+}
+
+bool writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path);
+    return static_cast<bool>(file << contents);
+}
+
+// Assigns the minimum feasible move time to every move and writes the optimized config.
+// Move times are feasible for the kinematic limits and the torque budget (torqueBudgetCheck),
+// so they are played as optimized rather than stretched again by torque retiming; segments
+// that still exceed the budget are reported as violations. The first move's time is never
+// shortened: it is also used for the initial move from wherever the robot starts.
+std::string optimizeFile(const std::string& path, const Options& options, size_t& violations) {
+    std::ostringstream out;
+    std::vector<std::string> errors;
+    std::vector<DanceMove> moves = loadDanceMovesStrict(path, errors, options.defaults);
+    violations = errors.size();
+    if (!errors.empty()) {
+        out << path << ": INVALID, not optimized\n";
+        for (const std::string& error : errors) out << "  " << error << "\n";
+        return out.str();
+    }
+    if (hasCartesianMoves(moves)) {
+        out << path << ": not optimized, Cartesian moves are only validated\n";
+        violations = 1;
+        return out.str();
+    }
+
+    JointLimits limits = JointLimits::panda(1.0 - options.margin);
+    std::vector<double> current(moves.size()), optimized(moves.size());
+    std::vector<SegmentTiming> timings(moves.size());
+    std::map<int, double> move_times;
+    for (size_t i = 0; i < moves.size(); i++) {
+        size_t next = (i + 1) % moves.size();
+        const DanceMove& to = moves[next];
+        current[next] = std::max(to.move_time, minSafeMovementTime(moves[i].joints, to.joints));
+        timings[next] = minQuinticTime(moves[i].joints, to.joints, limits,
+                                       {torqueBudgetCheck(options.torque_budget, to.timing)}, 1e-3,
+                                       to.timing.scaling);
+        optimized[next] = next == 0 ? std::max(timings[next].duration, to.move_time) : timings[next].duration;
+        move_times[to.move_index] = optimized[next];
+    }
+
+    std::string output_path = options.in_place ? path : path + ".optimized";
+    std::ostringstream rewritten;
+    {
+        std::ifstream in(path);
+        rewriteMoveTimes(in, rewritten, move_times);
+    }
+    if (!writeFile(output_path, rewritten.str())) {
+        out << path << ": failed to write " << output_path << "\n";
+        violations = 1;
+        return out.str();
+    }
+
+    std::vector<SegmentReport> reports;
+    double before = predictCycleTime(moves, current, options);
+    double after = predictCycleTime(moves, optimized, options, &reports);
+    std::vector<std::string> torque_violations;
+    for (size_t i = 0; i < moves.size(); i++) {
+        size_t next = (i + 1) % moves.size();
+        if (reports[next].torque_peak <= 1.0) continue;
+        std::ostringstream message;
+        message << moves[i].move_index << " -> " << moves[next].move_index << ": joint "
+                << reports[next].torque_joint + 1 << " predicted torque at " << std::fixed << std::setprecision(0)
+                << 100.0 * reports[next].torque_peak << "% of the torque budget";
+        torque_violations.push_back(message.str());
+    }
+    violations = torque_violations.size();
+
+    out << std::fixed << std::setprecision(3);
+    out << path << ": predicted cycle " << before << " s -> " << after << " s ("
+        << std::setprecision(1) << 100.0 * (before - after) / before << "% shorter) at "
+        << 100.0 * (1.0 - options.margin) << "% of the limits, written to " << output_path
+        << (violations ? ", " + std::to_string(violations) + " segments over the torque budget" : std::string())
+        << "\n";
+    out << "| From | To | Current | Optimized | Limited by | Torque budget |\n";
+    for (size_t i = 0; i < moves.size(); i++) {
+        size_t next = (i + 1) % moves.size();
+        const SegmentTiming& timing = timings[next];
+        out << "| " << moves[i].move_index << " | " << moves[next].move_index << " | " << std::setprecision(3)
+            << current[next] << " | " << optimized[next] << " | ";
+        if (next == 0 && optimized[next] > timing.duration) {
+            out << "kept (initial move)";
+        } else if (timing.limit == TimeLimit::kCheck) {
+            out << (timing.feasible ? "torque" : "torque (not met)");
+        } else {
+            out << timeLimitName(timing.limit);
+            if (timing.joint >= 0) out << " j" << timing.joint + 1;
+        }
+        out << " | " << std::setprecision(0) << 100.0 * reports[next].torque_peak << "% (j"
+            << reports[next].torque_joint + 1 << ") |\n";
+    }
+    for (const std::string& violation : torque_violations) out << "  VIOLATION " << violation << "\n";
+    return out.str();
+}
+
+// Reorders the waypoints for the shortest cycle, with minimum feasible move times, and writes
+// the reordered config. As in optimizeFile the first move stays first and is not shortened, and
+// the tour is chosen on the same torque-feasible, per-move timed segments that are written.
+std::string reorderFile(const std::string& path, const Options& options, size_t& violations) {
+    std::ostringstream out;
+    std::vector<std::string> errors;
+    std::vector<DanceMove> moves = loadDanceMovesStrict(path, errors, options.defaults);
+    violations = errors.size();
+    if (!errors.empty()) {
+        out << path << ": INVALID, not reordered\n";
+        for (const std::string& error : errors) out << "  " << error << "\n";
+        return out.str();
+    }
+    if (hasCartesianMoves(moves)) {
+        out << path << ": not reordered, Cartesian moves are only validated\n";
+        violations = 1;
+        return out.str();
+    }
+
+    size_t n = moves.size();
+    std::vector<std::array<double, 7>> points(n);
+    std::vector<double> current(n);
+    for (size_t i = 0; i < n; i++) {
+        points[i] = moves[i].joints;
+        const DanceMove& from = moves[(i + n - 1) % n];
+        current[i] = std::max(moves[i].move_time, minSafeMovementTime(from.joints, moves[i].joints));
+    }
+    TourOptions tour_options;
+    tour_options.threads = options.threads;
+    JointLimits limits = JointLimits::panda(1.0 - options.margin);
+    // Segments into a waypoint are timed with its move settings and the torque check, as in
+    // optimizeFile; the tour minimizes the played times (move time / velocity scale)
+    std::vector<MoveTiming> timings(n);
+    std::vector<std::vector<FeasibilityCheck>> checks(n);
+    for (size_t i = 0; i < n; i++) {
+        timings[i] = moves[i].timing;
+        checks[i] = {torqueBudgetCheck(options.torque_budget, timings[i])};
+    }
+    SegmentCostMatrix costs(points, timings, limits, checks, options.threads);
+    TourResult tour = optimizeWaypointOrder(costs, tour_options);
+
+    std::vector<DanceMove> reordered(n);
+    std::vector<int> order(n);
+    std::vector<double> times(n);
+    for (size_t k = 0; k < n; k++) {
+        reordered[k] = moves[tour.order[k]];
+        order[k] = reordered[k].move_index;
+        times[k] = SegmentCostMatrix::moveTime(points, timings, limits, checks, tour.order[(k + n - 1) % n],
+                                               tour.order[k]);
+    }
+    times[0] = std::max(times[0], moves[0].move_time);
+
+    std::string output_path = options.in_place ? path : path + ".reordered";
+    std::ostringstream rewritten;
+    {
+        std::ifstream in(path);
+        writeReorderedMoves(in, rewritten, order, times);
+    }
+    if (!writeFile(output_path, rewritten.str())) {
+        out << path << ": failed to write " << output_path << "\n";
+        violations = 1;
+        return out.str();
+    }
+
+    double before = predictCycleTime(moves, current, options);
+    double after = predictCycleTime(reordered, times, options);
+    out << std::fixed << std::setprecision(3);
+    out << path << ": predicted cycle " << before << " s -> " << after << " s ("
+        << std::setprecision(1) << 100.0 * (before - after) / before << "% shorter) at "
+        << 100.0 * (1.0 - options.margin) << "% of the limits, solved in " << tour.seconds * 1000.0
+        << " ms, written to " << output_path << "\n";
+    out << "New order:";
+    for (int index : order) out << " " << index;
+    out << "\n";
+    return out.str();
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-j" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.threads, 1u)) return false;
+        } else if (arg == "--limit-scale" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.limit_scale, std::numeric_limits<double>::min())) {
+                return false;
+            }
+        } else if (arg == "--per-joint") {
+            options.per_joint = true;
+        } else if (arg == "--optimize") {
+            options.mode = Mode::kOptimize;
+        } else if (arg == "--reorder") {
+            options.mode = Mode::kReorder;
+        } else if (arg == "--margin" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.margin, 0.0, std::nextafter(1.0, 0.0))) return false;
+        } else if (arg == "--in-place") {
+            options.in_place = true;
+        } else if (arg == "--no-torque-retiming") {
+            options.torque_retiming = false;
+        } else if (arg == "--torque-model-error" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.torque_budget.model_error)) return false;
+        } else if (arg == "--interp" && i + 1 < argc) {
+            if (!parseTimeScaling(argv[++i], options.defaults.scaling)) {
+                std::cerr << "Unknown time scaling: " << argv[i] << std::endl;
+                return false;
+            }
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        } else {
+            options.files.push_back(arg);
+        }
+    }
+    return !options.files.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [-j THREADS] [--limit-scale S] [--per-joint]\n"
+                  << "           [--no-torque-retiming] [--torque-model-error F] [--interp NAME]\n"
+                  << "           dance.cfg [more.cfg ...]\n"
+                  << "       " << argv[0] << " --optimize [--margin M] [--in-place] dance.cfg [more.cfg ...]\n"
+                  << "       " << argv[0] << " --reorder [--margin M] [--in-place] dance.cfg [more.cfg ...]"
+                  << std::endl;
+        return 2;
+    }
+
+    // Files are claimed from a shared counter; reports are printed in argument order
+    std::vector<std::string> reports(options.files.size());
+    std::vector<size_t> violations(options.files.size(), 0);
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        for (size_t i; (i = next.fetch_add(1)) < options.files.size();) {
+            switch (options.mode) {
+                case Mode::kValidate: reports[i] = validateFile(options.files[i], options, violations[i]); break;
+                case Mode::kOptimize: reports[i] = optimizeFile(options.files[i], options, violations[i]); break;
+                case Mode::kReorder: reports[i] = reorderFile(options.files[i], options, violations[i]); break;
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    unsigned thread_count = std::min<unsigned>(options.threads, options.files.size());
+    for (unsigned t = 0; t < thread_count; t++) threads.emplace_back(worker);
+    for (std::thread& thread : threads) thread.join();
+
+    size_t failed = 0;
+    for (size_t i = 0; i < reports.size(); i++) {
+        std::cout << reports[i] << "\n";
+        failed += violations[i] > 0;
+    }
+    std::cout << options.files.size() - failed << "/" << options.files.size()
+              << (options.mode == Mode::kValidate ? " files passed" : " files rewritten") << std::endl;
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+"""
+Reference values for bench_dynamics.cpp, from a Panda model built independently of
+panda_dynamics.h / panda_kinematics.h:
+  - geometry from the joint origins of franka_description's panda_arm.xacro (xyz + rpy per
+    joint, full homogeneous transforms) instead of the DH table,
+  - the identified link parameters of Gaz et al. (RA-L 2019, Table of feasible parameters),
+    transcribed separately from panda_dynamics.h's kLinkInertia,
+  - the Franka Hand as its own rigid body in the flange frame (Desk's default load) instead of
+    being merged into link 7,
+  - energy-based formulas instead of RNEA/CRBA: M(q) = sum_k m Jv^T Jv + Jw^T R I R^T Jw,
+    g(q) = sum_k Jv^T (m g e_z), and the Coriolis term from the Christoffel symbols of M with
+    central differences.
+Prints the C++ initializers pasted into bench_dynamics.cpp (kReference). A wrong DH entry,
+inertia convention or parameter in panda_dynamics.h shows up as a mismatch there.
+
+Run: python dynamics_reference.py
+"""
+
+import numpy as np
+
+GRAVITY = 9.81
+
+# (xyz, rpy) of joints 1-7 and the flange (joint 8, fixed) in panda_arm.xacro
+JOINT_ORIGINS = [
+    ((0.0, 0.0, 0.333), (0.0, 0.0, 0.0)),
+    ((0.0, 0.0, 0.0), (-np.pi / 2, 0.0, 0.0)),
+    ((0.0, -0.316, 0.0), (np.pi / 2, 0.0, 0.0)),
+    ((0.0825, 0.0, 0.0), (np.pi / 2, 0.0, 0.0)),
+    ((-0.0825, 0.384, 0.0), (-np.pi / 2, 0.0, 0.0)),
+    ((0.0, 0.0, 0.0), (np.pi / 2, 0.0, 0.0)),
+    ((0.088, 0.0, 0.0), (np.pi / 2, 0.0, 0.0)),
+    ((0.0, 0.0, 0.107), (0.0, 0.0, 0.0)),
+]
+
+# Gaz et al.: mass (kg), centre of mass (m) and inertia about it (kg m^2) in the link frame,
+# as the full symmetric matrix
+LINKS = [
+    (4.970684, (3.875e-03, 2.081e-03, -4.762e-02),
+     ((7.0337e-01, -1.3900e-04, 6.7720e-03),
+      (-1.3900e-04, 7.0661e-01, 1.9169e-02),
+      (6.7720e-03, 1.9169e-02, 9.1170e-03))),
+    (0.646926, (-3.141e-03, -2.872e-02, 3.495e-03),
+     ((7.9620e-03, -3.9250e-03, 1.0254e-02),
+      (-3.9250e-03, 2.8110e-02, 7.0400e-04),
+      (1.0254e-02, 7.0400e-04, 2.5995e-02))),
+    (3.228604, (2.7518e-02, 3.9252e-02, -6.6502e-02),
+     ((3.7242e-02, -4.7610e-03, -1.1396e-02),
+      (-4.7610e-03, 3.6155e-02, -1.2805e-02),
+      (-1.1396e-02, -1.2805e-02, 1.0830e-02))),
+    (3.587895, (-5.317e-02, 1.04419e-01, 2.7454e-02),
+     ((2.5853e-02, 7.7960e-03, -1.3320e-03),
+      (7.7960e-03, 1.9552e-02, 8.6410e-03),
+      (-1.3320e-03, 8.6410e-03, 2.8323e-02))),
+    (1.225946, (-1.1953e-02, 4.1065e-02, -3.8437e-02),
+     ((3.5549e-02, -2.1170e-03, -4.0370e-03),
+      (-2.1170e-03, 2.9474e-02, 2.2900e-04),
+      (-4.0370e-03, 2.2900e-04, 8.6270e-03))),
+    (1.666555, (6.0149e-02, -1.4117e-02, -1.0517e-02),
+     ((1.9640e-03, 1.0900e-04, -1.1580e-03),
+      (1.0900e-04, 4.3540e-03, 3.4100e-04),
+      (-1.1580e-03, 3.4100e-04, 5.4330e-03))),
+    (7.35522e-01, (1.0517e-02, -4.252e-03, 6.1597e-02),
+     ((1.2516e-02, -4.2800e-04, -1.1960e-03),
+      (-4.2800e-04, 1.0027e-02, -7.4100e-04),
+      (-1.1960e-03, -7.4100e-04, 4.8150e-03))),
+]
+
+# Franka Hand as set in Desk, in the flange frame
+HAND = (0.73, (-0.01, 0.0, 0.03), np.diag([0.001, 0.0025, 0.0017]))
+
+# Configurations: the ready pose, near the zero pose, and two spread over the workspace
+CONFIGURATIONS = [
+    (0.0, -np.pi / 4, 0.0, -3 * np.pi / 4, 0.0, np.pi / 2, np.pi / 4),
+    (0.0, 0.0, 0.0, -0.1, 0.0, 0.1, 0.0),
+    (0.8, 0.4, -0.6, -1.9, 1.1, 2.2, -1.3),
+    (-1.5, -1.2, 2.0, -2.6, -2.2, 0.9, 2.4),
+]
+VELOCITY = (0.6, -0.8, 1.0, 0.5, -1.2, 1.5, -2.0)
+ACCELERATION = (2.0, -1.5, 3.0, -2.5, 4.0, -3.5, 5.0)
+
+
+def rpy_matrix(roll, pitch, yaw):
+    cr, sr, cp, sp, cy, sy = np.cos(roll), np.sin(roll), np.cos(pitch), np.sin(pitch), np.cos(yaw), np.sin(yaw)
+    rx = np.array([[1, 0, 0], [0, cr, -sr], [0, sr, cr]])
+    ry = np.array([[cp, 0, sp], [0, 1, 0], [-sp, 0, cp]])
+    rz = np.array([[cy, -sy, 0], [sy, cy, 0], [0, 0, 1]])
+    return rz @ ry @ rx
+
+
+def frames(q):
+    """World transforms of links 1-7 and the flange."""
+    transforms = []
+    T = np.eye(4)
+    for i, (xyz, rpy) in enumerate(JOINT_ORIGINS):
+        origin = np.eye(4)
+        origin[:3, :3] = rpy_matrix(*rpy)
+        origin[:3, 3] = xyz
+        T = T @ origin
+        if i < 7:
+            c, s = np.cos(q[i]), np.sin(q[i])
+            rotation = np.eye(4)
+            rotation[:2, :2] = [[c, -s], [s, c]]
+            T = T @ rotation
+        transforms.append(T.copy())
+    return transforms
+
+
+def bodies(q):
+    """(mass, world COM, world inertia about the COM, index of the last joint moving it) per body."""
+    transforms = frames(q)
+    result = []
+    for k, (mass, com, inertia) in enumerate(LINKS):
+        R, p = transforms[k][:3, :3], transforms[k][:3, 3]
+        result.append((mass, p + R @ com, R @ np.array(inertia) @ R.T, k))
+    R, p = transforms[7][:3, :3], transforms[7][:3, 3]
+    result.append((HAND[0], p + R @ HAND[1], R @ HAND[2] @ R.T, 6))
+    return result, transforms
+
+
+def mass_matrix(q):
+    body_list, transforms = bodies(q)
+    axes = [T[:3, 2] for T in transforms[:7]]
+    origins = [T[:3, 3] for T in transforms[:7]]
+    M = np.zeros((7, 7))
+    for mass, com, inertia, last in body_list:
+        Jv, Jw = np.zeros((3, 7)), np.zeros((3, 7))
+        for j in range(last + 1):
+            Jv[:, j] = np.cross(axes[j], com - origins[j])
+            Jw[:, j] = axes[j]
+        M += mass * Jv.T @ Jv + Jw.T @ inertia @ Jw
+    return M
+
+
+def gravity(q):
+    body_list, transforms = bodies(q)
+    tau = np.zeros(7)
+    for mass, com, _, last in body_list:
+        for j in range(last + 1):
+            axis, origin = transforms[j][:3, 2], transforms[j][:3, 3]
+            tau[j] += np.cross(axis, com - origin) @ np.array([0.0, 0.0, mass * GRAVITY])
+    return tau
+
+
+def inverse_dynamics(q, dq, ddq, h=1e-6):
+    """M ddq + C dq + g, with C dq = dM/dt dq - 1/2 d/dq (dq^T M dq)."""
+    q, dq, ddq = np.asarray(q), np.asarray(dq), np.asarray(ddq)
+    dM = []
+    for k in range(7):
+        step = np.zeros(7)
+        step[k] = h
+        dM.append((mass_matrix(q + step) - mass_matrix(q - step)) / (2 * h))
+    M_dot = sum(dM[k] * dq[k] for k in range(7))
+    coriolis = M_dot @ dq - 0.5 * np.array([dq @ dM[k] @ dq for k in range(7)])
+    return mass_matrix(q) @ ddq + coriolis + gravity(q)
+
+
+def cpp(values):
+    return "{{" + ", ".join(f"{v:.10g}" for v in values) + "}}"
+
+
+def main():
+    # tau uses VELOCITY and ACCELERATION, which bench_dynamics.cpp repeats as kReferenceVelocity/Acceleration
+    print("    // Generated by dynamics_reference.py")
+    for q in CONFIGURATIONS:
+        q = np.array(q)
+        print("    {" + cpp(q) + ",")
+        print("     " + cpp(gravity(q)) + ",")
+        print("     " + cpp(inverse_dynamics(q, VELOCITY, ACCELERATION)) + ",")
+        rows = [", ".join(f"{v:.10g}" for v in row) for row in mass_matrix(q)]
+        print("     {{" + ",\n       ".join(rows) + "}}},")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,87 @@
+// Dance runner with the dance compiled in, for cells that run one fixed dance. dance_codegen
+// turns the config file into embedded_dance_table.h (build_dance.sh does both when DANCE_CONFIG
+// is set), and this runs the same loop as random_points.cpp (dance_runner.h) on that constexpr
+// table: no config to read, parse or allocate at start-up. Joint targets are checked against the
+// position limits at compile time. --compare FILE loads a config file the way random_points does
+// and exits non-zero unless it gives exactly the compiled-in moves.
+#include <iostream>
+#include <string>
+#include <vector>
+#include "dance_runner.h"
+#include "embedded_dance_table.h"
+
+namespace {
+
+template <size_t N>
+constexpr bool withinPositionLimits(const DanceMove (&moves)[N]) {
+    for (const DanceMove& move : moves) {
+        if (!withinPositionLimits(move)) return false;
+    }
+    return true;
+}
+
+static_assert(withinPositionLimits(kEmbeddedDance), "embedded dance has a joint target outside the position limits");
+
+bool sameMove(const DanceMove& a, const DanceMove& b) {
+    return a.move_index == b.move_index && a.joints == b.joints && a.move_time == b.move_time && a.type == b.type &&
+           a.pose == b.pose && a.timing.scaling == b.timing.scaling &&
+           a.timing.velocity_scale == b.timing.velocity_scale && a.timing.dwell == b.timing.dwell &&
+           a.blend_radius == b.blend_radius;
+}
+
+// Loads config_file_path as random_points would (with the defaults the table was generated
+// with) and compares it move by move with the compiled-in dance
+int compareWithConfig(const std::string& config_file_path) {
+    std::vector<DanceMove> loaded = readDanceMovesFromConfig(config_file_path, kEmbeddedDanceDefaults);
+    DanceView embedded(kEmbeddedDance);
+    if (loaded.size() != embedded.size()) {
+        std::cerr << config_file_path << " has " << loaded.size() << " moves, the embedded dance "
+                  << embedded.size() << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < loaded.size(); i++) {
+        if (!sameMove(loaded[i], embedded[i])) {
+            std::cerr << "Move " << loaded[i].move_index << " differs from the embedded dance; regenerate it with "
+                      << "build_dance.sh" << std::endl;
+            return 1;
+        }
+    }
+    std::cout << "Embedded dance matches " << config_file_path << " (" << loaded.size() << " moves)" << std::endl;
+    return 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 3 && std::string(argv[1]) == "--compare") {
+        try {
+            return compareWithConfig(argv[2]);
+        } catch (const std::exception& e) {
+            std::cerr << "Exception: " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    // The dance and its timing defaults are fixed when the table is generated
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--watch-config" || arg == "--interp") {
+            std::cerr << arg << " is not available with an embedded dance; regenerate the table instead"
+                      << std::endl;
+            return 1;
+        }
+    }
+    Options options;
+    if (argc < 2 || !parseOptions(argc, argv, 2, options)) {
+        std::cerr << "Usage: " << argv[0] << " <robot-hostname>"
+                  << " [--record-dir DIR] [--postmortem-seconds S] [--simulate [--sim-missed-ticks P]]"
+                  << " [--stats-json FILE] [--stats-csv FILE]"
+                  << " [--cycles N | --duration S | --until-signal]"
+                  << " [--plan-cache ENTRIES] [--no-torque-retiming] [--torque-model-error F]"
+                  << " [--settle-timeout S] [--settle-velocity RAD_S] [--settle-position RAD]\n"
+                  << "       " << argv[0] << " --compare <config-file-path>" << std::endl;
+        return 1;
+    }
+
+    return connectAndRunDance(argv[1], kEmbeddedDanceSource, kEmbeddedDance, options);
+}
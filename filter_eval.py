@@ -0,0 +1,80 @@
+#!/usr/bin/env python3
+"""
+Replay-based jitter vs lag comparison for the One-Euro phone pose filter.
+Replays a recorded AR stream (see `predictor_eval.py record`) or a synthetic noisy
+stream through PoseOneEuroFilter for a grid of parameters and reports:
+  - jitter: RMS second difference of the output (mm, deg per sample)
+  - lag:    constant delay that best aligns the output with the raw stream (ms)
+"""
+
+import argparse
+import numpy as np
+from scipy.spatial.transform import Rotation as R
+import config
+from franka_ar_native import PoseOneEuroFilter
+from predictor_eval import synthetic_stream
+
+
+def run_filter(t, pos, quat, pos_min_cutoff, pos_beta, rot_min_cutoff, rot_beta):
+    pose_filter = PoseOneEuroFilter(pos_min_cutoff, pos_beta, rot_min_cutoff, rot_beta, config.ONE_EURO_D_CUTOFF)
+    out = np.zeros((len(t), 7))
+    for i in range(len(t)):
+        out[i] = pose_filter.filter(t[i], pos[i], quat[i])
+    return out[:, :3], out[:, 3:]
+
+
+def jitter(pos, quat):
+    pos_jitter = np.sqrt((np.linalg.norm(np.diff(pos, n=2, axis=0), axis=1) ** 2).mean()) * 1000
+    # Rotation: second difference of consecutive relative rotation vectors
+    rots = R.from_quat(quat)
+    steps = (rots[:-1].inv() * rots[1:]).as_rotvec()
+    rot_jitter = np.degrees(np.sqrt((np.linalg.norm(np.diff(steps, axis=0), axis=1) ** 2).mean()))
+    return pos_jitter, rot_jitter
+
+
+def lag(t, raw_pos, pos, max_lag=0.4):
+    lags = np.arange(0.0, max_lag, 0.001)
+    errs = []
+    for l in lags:
+        shifted = np.stack([np.interp(t - l, t, raw_pos[:, j]) for j in range(3)], axis=-1)
+        errs.append(np.sqrt(((pos - shifted) ** 2).sum(axis=1).mean()))
+    return lags[int(np.argmin(errs))] * 1000
+
+
+def main():
+    parser = argparse.ArgumentParser(description='One-Euro filter jitter vs lag comparison')
+    parser.add_argument('--input', help='Recorded .npz (default: synthetic noisy stream)')
+    parser.add_argument('--min-cutoffs', type=float, nargs='+', default=[0.5, 1.0, 2.0, 4.0])
+    parser.add_argument('--betas', type=float, nargs='+', default=[0.0, 5.0, 10.0, 20.0])
+    args = parser.parse_args()
+
+    if args.input:
+        data = np.load(args.input)
+        t, pos, quat = data['t'], data['position'], data['quat']
+        source = args.input
+    else:
+        t, pos, quat = synthetic_stream(noise=0.002)
+        # Orientation tracking noise of about 0.3 degrees
+        noise = np.random.default_rng(1).normal(0, np.radians(0.3), (len(t), 3))
+        quat = (R.from_quat(quat) * R.from_rotvec(noise)).as_quat()
+        source = 'synthetic noisy stream'
+
+    raw_pos_jitter, raw_rot_jitter = jitter(pos, quat)
+    print(f"One-Euro jitter vs lag on {source} ({len(t)} samples)")
+    print("=" * 72)
+    print(f"{'min_cutoff':>10} | {'beta':>6} | {'pos jitter mm':>13} | {'rot jitter deg':>14} | {'lag ms':>7}")
+    print("-" * 72)
+    print(f"{'raw':>10} | {'':>6} | {raw_pos_jitter:>13.3f} | {raw_rot_jitter:>14.3f} | {0.0:>7.1f}")
+    for min_cutoff in args.min_cutoffs:
+        for beta in args.betas:
+            fpos, fquat = run_filter(t, pos, quat, min_cutoff, beta, min_cutoff,
+                                     beta * config.ONE_EURO_ROT_BETA / config.ONE_EURO_POS_BETA)
+            pos_jitter, rot_jitter = jitter(fpos, fquat)
+            print(f"{min_cutoff:>10.2f} | {beta:>6.1f} | {pos_jitter:>13.3f} | {rot_jitter:>14.3f} | "
+                  f"{lag(t, pos, fpos):>7.1f}")
+    print("=" * 72)
+    print("Native cost per sample: run ./bench_filters (built by build_native.sh)")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,448 @@
+// Always-on tick-level flight recorder for libfranka control callbacks.
+// record() copies a compact subset of the RobotState into a preallocated ring (fixed-size
+// copy plus one release store: no allocation, locking or I/O on the RT path). A background
+// thread drains the ring into one .npy file per channel, e.g. np.load("rec/q.npy") -> (N, 7),
+// and dumpRecent() writes the last few seconds for post-mortem after an exception.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <franka/duration.h>
+#include <franka/robot_state.h>
+
+namespace flight_recorder {
+
+// Control ticks per second of robot time; used to turn seconds into ring slots
+constexpr double kTickRate = 1000.0;
+
+// One control tick as seen by the callback
+struct TickRecord {
+    double t;                     // RobotState::time (s)
+    uint64_t period_ms;           // franka::Duration passed to the callback
+    int32_t segment;              // Segment (move) being executed, see beginSegment()
+    double success_rate;          // control_command_success_rate
+    std::array<double, 7> q;      // Measured joint positions
+    std::array<double, 7> q_d;    // Last commanded joint positions
+    std::array<double, 7> dq;     // Measured joint velocities
+    std::array<double, 7> tau_J;  // Measured joint torques
+};
+
+// How a segment's commands were generated (SegmentRecord::motion), so replay_harness can rebuild
+// the same callback
+enum class SegmentMotion { kJoint, kJointPlan, kCartesian };
+
+// Per-segment metadata, written once per move (outside the callback)
+struct SegmentRecord {
+    double index;
+    std::array<double, 7> q_start;
+    std::array<double, 7> q_target;
+    double desired_duration;
+    double safe_duration;
+    std::array<double, 7> plan_start{};  // Start of the played plan (a cached plan's can differ from q_start)
+    double scaling = 0.0;                // TimeScaling of the move
+    double velocity_scale = 1.0;
+    double motion = 0.0;                 // SegmentMotion
+    double torque_model_error = NAN;     // TorqueBudget::model_error of the plan's torque retiming (NaN: none)
+    std::array<double, 4> settle{};      // SettleOptions: velocity, position, window, timeout
+};
+
+// Columns of segments.npy, one per double of SegmentRecord
+constexpr std::size_t kSegmentColumns = sizeof(SegmentRecord) / sizeof(double);
+static_assert(sizeof(SegmentRecord) == kSegmentColumns * sizeof(double), "SegmentRecord must be packed doubles");
+
+// Column layout of the .npy output: name, numpy dtype, columns, offset and size in TickRecord
+struct Channel {
+    const char* name;
+    const char* descr;
+    std::size_t columns;
+    std::size_t offset;
+    std::size_t bytes;
+};
+
+constexpr std::array<Channel, 8> kChannels{{
+    {"t", "<f8", 1, offsetof(TickRecord, t), sizeof(double)},
+    {"period_ms", "<u8", 1, offsetof(TickRecord, period_ms), sizeof(uint64_t)},
+    {"segment", "<i4", 1, offsetof(TickRecord, segment), sizeof(int32_t)},
+    {"success_rate", "<f8", 1, offsetof(TickRecord, success_rate), sizeof(double)},
+    {"q", "<f8", 7, offsetof(TickRecord, q), 7 * sizeof(double)},
+    {"q_d", "<f8", 7, offsetof(TickRecord, q_d), 7 * sizeof(double)},
+    {"dq", "<f8", 7, offsetof(TickRecord, dq), 7 * sizeof(double)},
+    {"tau_J", "<f8", 7, offsetof(TickRecord, tau_J), 7 * sizeof(double)},
+}};
+
+// Appends rows to a .npy file. The header has a fixed size so the row count can be
+// rewritten in place after every append; the file is loadable even after a crash.
+class NpyWriter {
+public:
+    NpyWriter() = default;
+    NpyWriter(const NpyWriter&) = delete;
+    NpyWriter& operator=(const NpyWriter&) = delete;
+    ~NpyWriter() { close(); }
+
+    bool open(const std::string& path, const char* descr, std::size_t columns) {
+        close();
+        file_ = std::fopen(path.c_str(), "wb");
+        descr_ = descr;
+        columns_ = columns;
+        rows_ = 0;
+        return file_ != nullptr && writeHeader();
+    }
+
+    bool append(const void* data, std::size_t rows, std::size_t row_bytes) {
+        if (file_ == nullptr || rows == 0) return file_ != nullptr;
+        if (std::fwrite(data, row_bytes, rows, file_) != rows) return false;
+        rows_ += rows;
+        return writeHeader();
+    }
+
+    void close() {
+        if (file_ != nullptr) {
+            std::fclose(file_);
+            file_ = nullptr;
+        }
+    }
+
+    std::size_t rows() const { return rows_; }
+
+private:
+    static constexpr std::size_t kHeaderBytes = 128;
+
+    bool writeHeader() {
+        char dict[kHeaderBytes];
+        int n;
+        if (columns_ == 1) {
+            n = std::snprintf(dict, sizeof(dict), "{'descr': '%s', 'fortran_order': False, 'shape': (%zu,), }",
+                              descr_, rows_);
+        } else {
+            n = std::snprintf(dict, sizeof(dict), "{'descr': '%s', 'fortran_order': False, 'shape': (%zu, %zu), }",
+                              descr_, rows_, columns_);
+        }
+        const std::size_t dict_bytes = kHeaderBytes - 10;  // magic (6) + version (2) + length (2)
+        if (n < 0 || static_cast<std::size_t>(n) >= dict_bytes) return false;
+        char header[kHeaderBytes];
+        std::memcpy(header, "\x93NUMPY\x01\x00", 8);
+        header[8] = static_cast<char>(dict_bytes & 0xff);
+        header[9] = static_cast<char>(dict_bytes >> 8);
+        std::memset(header + 10, ' ', dict_bytes);
+        std::memcpy(header + 10, dict, n);
+        header[kHeaderBytes - 1] = '\n';
+
+        long end = std::ftell(file_);
+        std::fseek(file_, 0, SEEK_SET);
+        bool ok = std::fwrite(header, 1, kHeaderBytes, file_) == kHeaderBytes;
+        std::fseek(file_, std::max(end, static_cast<long>(kHeaderBytes)), SEEK_SET);
+        return ok && std::fflush(file_) == 0;
+    }
+
+    std::FILE* file_ = nullptr;
+    const char* descr_ = "<f8";
+    std::size_t columns_ = 1;
+    std::size_t rows_ = 0;
+};
+
+// Writes records to one .npy per channel in `directory`; returns false on I/O errors
+inline bool writeColumns(const std::string& directory, const TickRecord* records, std::size_t count,
+                         std::vector<unsigned char>& scratch, std::array<NpyWriter, kChannels.size()>* writers = nullptr) {
+    std::array<NpyWriter, kChannels.size()> local;
+    std::array<NpyWriter, kChannels.size()>& out = writers != nullptr ? *writers : local;
+    bool ok = true;
+    for (std::size_t c = 0; c < kChannels.size(); c++) {
+        const Channel& channel = kChannels[c];
+        if (writers == nullptr) {
+            ok &= out[c].open(directory + "/" + channel.name + ".npy", channel.descr, channel.columns);
+        }
+        scratch.resize(count * channel.bytes);
+        for (std::size_t i = 0; i < count; i++) {
+            std::memcpy(&scratch[i * channel.bytes],
+                        reinterpret_cast<const unsigned char*>(&records[i]) + channel.offset, channel.bytes);
+        }
+        ok &= out[c].append(scratch.data(), count, channel.bytes);
+    }
+    return ok;
+}
+
+// Writes segment metadata as segments.npy, one row of kSegmentColumns doubles per segment:
+// index, q_start[7], q_target[7], desired_duration, safe_duration, plan_start[7], scaling,
+// velocity_scale, motion, torque_model_error, settle[4]
+inline bool writeSegments(const std::string& directory, const std::vector<SegmentRecord>& segments) {
+    NpyWriter writer;
+    return writer.open(directory + "/segments.npy", "<f8", kSegmentColumns) &&
+           writer.append(segments.data(), segments.size(), sizeof(SegmentRecord));
+}
+
+// Reads a .npy written by NpyWriter (or numpy) into data; returns the row count. Throws
+// std::runtime_error if the file is missing or its dtype/columns do not match.
+inline std::size_t readNpy(const std::string& path, const char* descr, std::size_t columns,
+                           std::size_t row_bytes, std::vector<unsigned char>& data) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) throw std::runtime_error("Cannot open " + path);
+    unsigned char preamble[10];
+    std::string header;
+    bool ok = std::fread(preamble, 1, 10, file) == 10 && std::memcmp(preamble, "\x93NUMPY", 6) == 0;
+    if (ok) {
+        std::size_t header_bytes = preamble[8] | (preamble[9] << 8);
+        header.resize(header_bytes);
+        ok = std::fread(&header[0], 1, header_bytes, file) == header_bytes;
+    }
+    std::size_t rows = 0, cols = 1;
+    if (ok) {
+        std::size_t shape = header.find("'shape': (");
+        ok = header.find(std::string("'descr': '") + descr + "'") != std::string::npos &&
+             header.find("'fortran_order': False") != std::string::npos && shape != std::string::npos;
+        if (ok) {
+            const char* p = header.c_str() + shape + 10;
+            char* end = nullptr;
+            rows = std::strtoull(p, &end, 10);
+            if (*end == ',' && end[1] == ' ' && end[2] != ')') cols = std::strtoull(end + 2, nullptr, 10);
+            ok = cols == columns;
+        }
+    }
+    if (ok) {
+        data.resize(rows * row_bytes);
+        ok = std::fread(data.data(), row_bytes, rows, file) == rows;
+    }
+    std::fclose(file);
+    if (!ok) throw std::runtime_error("Unexpected or truncated .npy: " + path);
+    return rows;
+}
+
+// Loads a recording written by FlightRecorder (startFlushing or dumpRecent)
+inline void loadRecording(const std::string& directory, std::vector<TickRecord>& ticks,
+                          std::vector<SegmentRecord>& segments) {
+    std::vector<unsigned char> data;
+    std::size_t count = readNpy(directory + "/t.npy", "<f8", 1, sizeof(double), data);
+    ticks.assign(count, TickRecord{});
+    for (const Channel& channel : kChannels) {
+        std::size_t rows = readNpy(directory + "/" + channel.name + ".npy", channel.descr, channel.columns,
+                                   channel.bytes, data);
+        if (rows != count) throw std::runtime_error(std::string("Channel length mismatch: ") + channel.name);
+        for (std::size_t i = 0; i < count; i++) {
+            std::memcpy(reinterpret_cast<unsigned char*>(&ticks[i]) + channel.offset, &data[i * channel.bytes],
+                        channel.bytes);
+        }
+    }
+    count = readNpy(directory + "/segments.npy", "<f8", kSegmentColumns, sizeof(SegmentRecord), data);
+    segments.resize(count);
+    std::memcpy(segments.data(), data.data(), count * sizeof(SegmentRecord));
+}
+
+class FlightRecorder {
+public:
+    // capacity_seconds of ticks are kept in the ring (rounded up to a power of two)
+    explicit FlightRecorder(double capacity_seconds = 30.0) {
+        std::size_t capacity = 1;
+        while (capacity < capacity_seconds * kTickRate) capacity <<= 1;
+        ring_.resize(capacity);
+        mask_ = capacity - 1;
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+    ~FlightRecorder() { stopFlushing(); }
+
+    // Starts the background thread that drains the ring into `directory` every flush_period
+    bool startFlushing(const std::string& directory,
+                       std::chrono::milliseconds flush_period = std::chrono::milliseconds(100)) {
+        stopFlushing();
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        for (std::size_t c = 0; c < kChannels.size(); c++) {
+            const Channel& channel = kChannels[c];
+            if (!writers_[c].open(directory + "/" + channel.name + ".npy", channel.descr, channel.columns)) {
+                return false;
+            }
+        }
+        if (!segment_writer_.open(directory + "/segments.npy", "<f8", kSegmentColumns)) return false;
+        directory_ = directory;
+        tail_ = head_.load(std::memory_order_acquire);
+        {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            flushing_ = true;
+            flushed_segments_ = 0;
+        }
+        stop_ = false;
+        flusher_ = std::thread([this, flush_period] {
+            std::unique_lock<std::mutex> lock(flush_mutex_);
+            while (!stop_) {
+                flush_cv_.wait_for(lock, flush_period, [this] { return stop_; });
+                drain();
+            }
+        });
+        return true;
+    }
+
+    // Drains what is left in the ring and closes the output files
+    void stopFlushing() {
+        if (!flusher_.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex_);
+            stop_ = true;
+        }
+        flush_cv_.notify_one();
+        flusher_.join();
+        for (NpyWriter& writer : writers_) writer.close();
+        segment_writer_.close();
+        std::lock_guard<std::mutex> lock(segments_mutex_);
+        flushing_ = false;
+    }
+
+    // Starts a new segment described by `record` (its index is assigned here); ticks recorded
+    // until the next call are tagged with that index. Call from the control thread before
+    // robot.control(), not from the callback. Only the segments that still have ticks in the
+    // ring (or are not flushed yet) are kept in memory.
+    int32_t beginSegment(const SegmentRecord& record) {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        std::lock_guard<std::mutex> lock(segments_mutex_);
+        while (segments_.size() > 1 && segment_starts_[1] + ring_.size() <= head &&
+               (!flushing_ || first_segment_ < flushed_segments_)) {
+            segments_.pop_front();
+            segment_starts_.pop_front();
+            first_segment_++;
+        }
+        segment_ = static_cast<int32_t>(first_segment_ + segments_.size());
+        segments_.push_back(record);
+        segments_.back().index = static_cast<double>(segment_);
+        segment_starts_.push_back(head);
+        return segment_;
+    }
+
+    // Called from the control callback once per tick
+    void record(const franka::RobotState& state, franka::Duration period) noexcept {
+        const uint64_t head = head_.load(std::memory_order_relaxed);
+        TickRecord& r = ring_[head & mask_];
+        r.t = state.time.toSec();
+        r.period_ms = period.toMSec();
+        r.segment = segment_;
+        r.success_rate = state.control_command_success_rate;
+        r.q = state.q;
+        r.q_d = state.q_d;
+        r.dq = state.dq;
+        r.tau_J = state.tau_J;
+        head_.store(head + 1, std::memory_order_release);
+    }
+
+    // Writes the last `seconds` of ticks and the metadata of the segments kept in memory to
+    // `directory`. The ticks' segment column is renumbered to index the rows of that
+    // segments.npy, whose first column keeps the run-wide index. Intended for post-mortem
+    // after robot.control() threw, when the callback is idle.
+    std::size_t dumpRecent(const std::string& directory, double seconds) const {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        std::size_t count = static_cast<std::size_t>(seconds * kTickRate);
+        count = std::min<uint64_t>({count, head, ring_.size()});
+        std::vector<TickRecord> records(count);
+        for (std::size_t i = 0; i < count; i++) {
+            records[i] = ring_[(head - count + i) & mask_];
+        }
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        std::vector<SegmentRecord> segments;
+        {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            segments.assign(segments_.begin(), segments_.end());
+            for (TickRecord& record : records) {
+                if (record.segment >= 0) record.segment -= static_cast<int32_t>(first_segment_);
+            }
+        }
+        std::vector<unsigned char> scratch;
+        bool ok = writeColumns(directory, records.data(), count, scratch);
+        ok &= writeSegments(directory, segments);
+        return ok ? count : 0;
+    }
+
+    uint64_t recorded() const { return head_.load(std::memory_order_relaxed); }
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    std::size_t capacity() const { return ring_.size(); }
+
+private:
+    // Copies [tail_, head) out of the ring and appends it to the channel files. Slots the
+    // callback lapped while being copied (flusher stalled for a full ring) are counted as
+    // dropped instead of written.
+    void drain() {
+        const uint64_t head = head_.load(std::memory_order_acquire);
+        const uint64_t capacity = ring_.size();
+        if (head - tail_ > capacity) {
+            dropped_.fetch_add(head - tail_ - capacity, std::memory_order_relaxed);
+            tail_ = head - capacity;
+        }
+        const std::size_t count = head - tail_;
+        batch_.resize(count);
+        for (std::size_t i = 0; i < count; i++) {
+            batch_[i] = ring_[(tail_ + i) & mask_];
+        }
+        std::size_t skip = 0;
+        const uint64_t after = head_.load(std::memory_order_acquire);
+        if (after - tail_ > capacity) {
+            skip = std::min<uint64_t>(after - capacity - tail_, count);
+            dropped_.fetch_add(skip, std::memory_order_relaxed);
+        }
+        if (count > skip) {
+            writeColumns(directory_, batch_.data() + skip, count - skip, scratch_, &writers_);
+        }
+        tail_ = head;
+
+        // New segment rows are appended, outside the lock. Rows for segments dropped from memory
+        // before flushing started are NaN, so row i stays segment i.
+        pending_segments_.clear();
+        {
+            std::lock_guard<std::mutex> lock(segments_mutex_);
+            const std::size_t end = first_segment_ + segments_.size();
+            for (std::size_t i = flushed_segments_; i < end; i++) {
+                if (i >= first_segment_) {
+                    pending_segments_.push_back(segments_[i - first_segment_]);
+                } else {
+                    SegmentRecord missing;
+                    std::fill_n(reinterpret_cast<double*>(&missing), kSegmentColumns,
+                                std::numeric_limits<double>::quiet_NaN());
+                    missing.index = static_cast<double>(i);
+                    pending_segments_.push_back(missing);
+                }
+            }
+            flushed_segments_ = end;
+        }
+        segment_writer_.append(pending_segments_.data(), pending_segments_.size(), sizeof(SegmentRecord));
+    }
+
+    std::vector<TickRecord> ring_;
+    std::size_t mask_ = 0;
+    std::atomic<uint64_t> head_{0};
+    std::atomic<uint64_t> dropped_{0};
+    int32_t segment_ = -1;
+
+    mutable std::mutex segments_mutex_;
+    std::deque<SegmentRecord> segments_;     // Segments first_segment_, first_segment_ + 1, ...
+    std::deque<uint64_t> segment_starts_;    // Tick count (head_) when each of them began
+    std::size_t first_segment_ = 0;
+    bool flushing_ = false;
+    std::size_t flushed_segments_ = 0;       // Segment rows written to segments.npy
+
+    // Flusher state
+    std::thread flusher_;
+    std::mutex flush_mutex_;
+    std::condition_variable flush_cv_;
+    bool stop_ = false;
+    std::string directory_;
+    uint64_t tail_ = 0;
+    std::vector<TickRecord> batch_;
+    std::vector<SegmentRecord> pending_segments_;
+    std::vector<unsigned char> scratch_;
+    std::array<NpyWriter, kChannels.size()> writers_;
+    NpyWriter segment_writer_;
+};
+
+}  // namespace flight_recorder
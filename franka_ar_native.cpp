@@ -0,0 +1,175 @@
+// C ABI for the native teleop filters, loaded from Python through ctypes (franka_ar_native.py).
+// Build with build_native.sh. Every handle carries its own mutex because the Python side calls
+// in from several threads (pose stream receiver and the fixed-rate output loop) and ctypes
+// releases the GIL for the duration of each call.
+#include <mutex>
+#include "one_euro_filter.h"
+#include "pose_interpolator.h"
+#include "pose_predictor.h"
+
+namespace {
+
+struct InterpolatorHandle {
+    std::mutex mutex;
+    PoseInterpolator interpolator;
+
+    InterpolatorHandle(double max_extrapolation, double max_extrapolation_distance)
+        : interpolator(max_extrapolation, max_extrapolation_distance) {}
+};
+
+struct PredictorHandle {
+    std::mutex mutex;
+    PosePredictor predictor;
+
+    PredictorHandle(double alpha, double beta, double gamma, double max_lead)
+        : predictor(alpha, beta, gamma, max_lead) {}
+};
+
+struct LatencyHandle {
+    std::mutex mutex;
+    LatencyEstimator estimator;
+
+    explicit LatencyHandle(double smoothing) : estimator(smoothing) {}
+};
+
+struct OneEuroHandle {
+    std::mutex mutex;
+    PoseOneEuroFilter filter;
+
+    OneEuroHandle(double pos_min_cutoff, double pos_beta, double rot_min_cutoff, double rot_beta, double d_cutoff)
+        : filter(pos_min_cutoff, pos_beta, rot_min_cutoff, rot_beta, d_cutoff) {}
+};
+
+void writePose(const so3::Vec3& p, const so3::Quat& q, double* pose) {
+    pose[0] = p[0];
+    pose[1] = p[1];
+    pose[2] = p[2];
+    pose[3] = q[0];
+    pose[4] = q[1];
+    pose[5] = q[2];
+    pose[6] = q[3];
+}
+
+}  // namespace
+
+extern "C" {
+
+// pose layout for all calls: {x, y, z, qx, qy, qz, qw}
+
+void* fa_interpolator_create(double max_extrapolation, double max_extrapolation_distance) {
+    return new InterpolatorHandle(max_extrapolation, max_extrapolation_distance);
+}
+
+void fa_interpolator_destroy(void* handle) {
+    delete static_cast<InterpolatorHandle*>(handle);
+}
+
+void fa_interpolator_reset(void* handle) {
+    auto* h = static_cast<InterpolatorHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    h->interpolator.reset();
+}
+
+int fa_interpolator_push(void* handle, double t, const double* pose) {
+    auto* h = static_cast<InterpolatorHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    return h->interpolator.push(t, {pose[0], pose[1], pose[2]}, {pose[3], pose[4], pose[5], pose[6]}) ? 1 : 0;
+}
+
+int fa_interpolator_sample(void* handle, double t, double* pose) {
+    auto* h = static_cast<InterpolatorHandle*>(handle);
+    so3::Vec3 p;
+    so3::Quat q;
+    PoseInterpolator::Status status;
+    {
+        std::lock_guard<std::mutex> lock(h->mutex);
+        status = h->interpolator.sample(t, p, q);
+    }
+    if (status != PoseInterpolator::kEmpty) {
+        writePose(p, q, pose);
+    }
+    return status;
+}
+
+void* fa_predictor_create(double alpha, double beta, double gamma, double max_lead) {
+    return new PredictorHandle(alpha, beta, gamma, max_lead);
+}
+
+void fa_predictor_destroy(void* handle) {
+    delete static_cast<PredictorHandle*>(handle);
+}
+
+void fa_predictor_reset(void* handle) {
+    auto* h = static_cast<PredictorHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    h->predictor.reset();
+}
+
+int fa_predictor_update(void* handle, double t, const double* pose) {
+    auto* h = static_cast<PredictorHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    return h->predictor.update(t, {pose[0], pose[1], pose[2]}, {pose[3], pose[4], pose[5], pose[6]}) ? 1 : 0;
+}
+
+int fa_predictor_predict(void* handle, double t, double* pose) {
+    auto* h = static_cast<PredictorHandle*>(handle);
+    so3::Vec3 p;
+    so3::Quat q;
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lock(h->mutex);
+        ok = h->predictor.predict(t, p, q);
+    }
+    if (ok) {
+        writePose(p, q, pose);
+    }
+    return ok ? 1 : 0;
+}
+
+void* fa_latency_create(double smoothing) {
+    return new LatencyHandle(smoothing);
+}
+
+void fa_latency_destroy(void* handle) {
+    delete static_cast<LatencyHandle*>(handle);
+}
+
+void fa_latency_add(void* handle, double latency) {
+    auto* h = static_cast<LatencyHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    h->estimator.add(latency);
+}
+
+// out = {mean, deviation}; returns the number of samples seen
+long fa_latency_get(void* handle, double* out) {
+    auto* h = static_cast<LatencyHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    out[0] = h->estimator.mean();
+    out[1] = h->estimator.deviation();
+    return h->estimator.count();
+}
+
+void* fa_one_euro_create(double pos_min_cutoff, double pos_beta, double rot_min_cutoff, double rot_beta,
+                         double d_cutoff) {
+    return new OneEuroHandle(pos_min_cutoff, pos_beta, rot_min_cutoff, rot_beta, d_cutoff);
+}
+
+void fa_one_euro_destroy(void* handle) {
+    delete static_cast<OneEuroHandle*>(handle);
+}
+
+void fa_one_euro_reset(void* handle) {
+    auto* h = static_cast<OneEuroHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    h->filter.reset();
+}
+
+void fa_one_euro_filter(void* handle, double t, const double* pose, double* out) {
+    auto* h = static_cast<OneEuroHandle*>(handle);
+    std::lock_guard<std::mutex> lock(h->mutex);
+    const auto& p = h->filter.position.filter(t, {pose[0], pose[1], pose[2]});
+    const auto& q = h->filter.orientation.filter(t, {pose[3], pose[4], pose[5], pose[6]});
+    writePose(p, q, out);
+}
+
+}  // extern "C"
@@ -0,0 +1,187 @@
+"""
+ctypes bindings for the native teleop filters in libfranka_ar_native.so.
+Build the library with `bash build_native.sh` before importing this module.
+Wrappers keep preallocated numpy buffers so per-sample calls do not allocate.
+"""
+
+import ctypes
+import os
+import numpy as np
+
+_LIB_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), 'libfranka_ar_native.so')
+_DOUBLE_P = ctypes.POINTER(ctypes.c_double)
+
+
+def _load_library():
+    try:
+        lib = ctypes.CDLL(_LIB_PATH)
+    except OSError as e:
+        raise ImportError(f"Could not load {_LIB_PATH} ({e}). Run `bash build_native.sh` first.")
+
+    lib.fa_interpolator_create.restype = ctypes.c_void_p
+    lib.fa_interpolator_create.argtypes = [ctypes.c_double, ctypes.c_double]
+    lib.fa_interpolator_destroy.argtypes = [ctypes.c_void_p]
+    lib.fa_interpolator_reset.argtypes = [ctypes.c_void_p]
+    lib.fa_interpolator_push.restype = ctypes.c_int
+    lib.fa_interpolator_push.argtypes = [ctypes.c_void_p, ctypes.c_double, _DOUBLE_P]
+    lib.fa_interpolator_sample.restype = ctypes.c_int
+    lib.fa_interpolator_sample.argtypes = [ctypes.c_void_p, ctypes.c_double, _DOUBLE_P]
+
+    lib.fa_predictor_create.restype = ctypes.c_void_p
+    lib.fa_predictor_create.argtypes = [ctypes.c_double] * 4
+    lib.fa_predictor_destroy.argtypes = [ctypes.c_void_p]
+    lib.fa_predictor_reset.argtypes = [ctypes.c_void_p]
+    lib.fa_predictor_update.restype = ctypes.c_int
+    lib.fa_predictor_update.argtypes = [ctypes.c_void_p, ctypes.c_double, _DOUBLE_P]
+    lib.fa_predictor_predict.restype = ctypes.c_int
+    lib.fa_predictor_predict.argtypes = [ctypes.c_void_p, ctypes.c_double, _DOUBLE_P]
+
+    lib.fa_latency_create.restype = ctypes.c_void_p
+    lib.fa_latency_create.argtypes = [ctypes.c_double]
+    lib.fa_latency_destroy.argtypes = [ctypes.c_void_p]
+    lib.fa_latency_add.argtypes = [ctypes.c_void_p, ctypes.c_double]
+    lib.fa_latency_get.restype = ctypes.c_long
+    lib.fa_latency_get.argtypes = [ctypes.c_void_p, _DOUBLE_P]
+
+    lib.fa_one_euro_create.restype = ctypes.c_void_p
+    lib.fa_one_euro_create.argtypes = [ctypes.c_double] * 5
+    lib.fa_one_euro_destroy.argtypes = [ctypes.c_void_p]
+    lib.fa_one_euro_reset.argtypes = [ctypes.c_void_p]
+    lib.fa_one_euro_filter.argtypes = [ctypes.c_void_p, ctypes.c_double, _DOUBLE_P, _DOUBLE_P]
+    return lib
+
+
+_lib = _load_library()
+
+
+class PoseInterpolator:
+    """Sparse timestamped poses in, smooth pose reference out (see pose_interpolator.h)."""
+
+    EMPTY = -1
+    INTERPOLATED = 0
+    EXTRAPOLATED = 1
+    HELD = 2
+
+    def __init__(self, max_extrapolation=0.05, max_extrapolation_distance=0.05):
+        self._handle = _lib.fa_interpolator_create(max_extrapolation, max_extrapolation_distance)
+        # Pre-allocated [x, y, z, qx, qy, qz, qw] buffers
+        self._in = np.zeros(7)
+        self._out = np.zeros(7)
+        self._in_ptr = self._in.ctypes.data_as(_DOUBLE_P)
+        self._out_ptr = self._out.ctypes.data_as(_DOUBLE_P)
+
+    def push(self, t, position, quat_xyzw):
+        """Add a sample; returns False if it is not newer than the last one."""
+        self._in[:3] = position
+        self._in[3:] = quat_xyzw
+        return bool(_lib.fa_interpolator_push(self._handle, t, self._in_ptr))
+
+    def sample(self, t):
+        """
+        Evaluate the reference at time t. Returns (status, pose) where pose is an
+        internal [x, y, z, qx, qy, qz, qw] buffer that is overwritten by the next call.
+        """
+        return _lib.fa_interpolator_sample(self._handle, t, self._out_ptr), self._out
+
+    def reset(self):
+        _lib.fa_interpolator_reset(self._handle)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fa_interpolator_destroy(self._handle)
+            self._handle = None
+
+
+def abg_gains(alpha):
+    """Steady-state beta/gamma for a given alpha (same relations as PosePredictor::gainsFromAlpha)."""
+    beta = 2.0 * (2.0 - alpha) - 4.0 * np.sqrt(1.0 - alpha)
+    gamma = beta * beta / (2.0 * alpha)
+    return beta, gamma
+
+
+class PosePredictor:
+    """Alpha-beta-gamma pose predictor on R^3 x SO(3) (see pose_predictor.h)."""
+
+    def __init__(self, alpha, beta=None, gamma=None, max_lead=0.15):
+        default_beta, default_gamma = abg_gains(alpha)
+        beta = default_beta if beta is None else beta
+        gamma = default_gamma if gamma is None else gamma
+        self._handle = _lib.fa_predictor_create(alpha, beta, gamma, max_lead)
+        self._in = np.zeros(7)
+        self._out = np.zeros(7)
+        self._in_ptr = self._in.ctypes.data_as(_DOUBLE_P)
+        self._out_ptr = self._out.ctypes.data_as(_DOUBLE_P)
+
+    def update(self, t, position, quat_xyzw):
+        """Feed a measurement; returns False if it is not newer than the previous one."""
+        self._in[:3] = position
+        self._in[3:] = quat_xyzw
+        return bool(_lib.fa_predictor_update(self._handle, t, self._in_ptr))
+
+    def predict(self, t):
+        """
+        Predicted [x, y, z, qx, qy, qz, qw] at absolute time t, or None before the first
+        update. The returned buffer is overwritten by the next call.
+        """
+        if _lib.fa_predictor_predict(self._handle, t, self._out_ptr):
+            return self._out
+        return None
+
+    def reset(self):
+        _lib.fa_predictor_reset(self._handle)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fa_predictor_destroy(self._handle)
+            self._handle = None
+
+
+class LatencyEstimator:
+    """EWMA mean/deviation of measured sample-to-actuation latency (seconds)."""
+
+    def __init__(self, smoothing=0.05):
+        self._handle = _lib.fa_latency_create(smoothing)
+        self._out = np.zeros(2)
+        self._out_ptr = self._out.ctypes.data_as(_DOUBLE_P)
+
+    def add(self, latency):
+        _lib.fa_latency_add(self._handle, latency)
+
+    def get(self):
+        """Returns (mean, deviation, count)."""
+        count = _lib.fa_latency_get(self._handle, self._out_ptr)
+        return self._out[0], self._out[1], count
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fa_latency_destroy(self._handle)
+            self._handle = None
+
+
+class PoseOneEuroFilter:
+    """One-Euro filter for position and (on the quaternion manifold) orientation."""
+
+    def __init__(self, pos_min_cutoff=1.0, pos_beta=0.0, rot_min_cutoff=1.0, rot_beta=0.0, d_cutoff=1.0):
+        self._handle = _lib.fa_one_euro_create(pos_min_cutoff, pos_beta, rot_min_cutoff, rot_beta, d_cutoff)
+        self._in = np.zeros(7)
+        self._out = np.zeros(7)
+        self._in_ptr = self._in.ctypes.data_as(_DOUBLE_P)
+        self._out_ptr = self._out.ctypes.data_as(_DOUBLE_P)
+
+    def filter(self, t, position, quat_xyzw):
+        """
+        Filter one sample taken at time t. Returns the internal [x, y, z, qx, qy, qz, qw]
+        buffer, which is overwritten by the next call.
+        """
+        self._in[:3] = position
+        self._in[3:] = quat_xyzw
+        _lib.fa_one_euro_filter(self._handle, t, self._in_ptr, self._out_ptr)
+        return self._out
+
+    def reset(self):
+        _lib.fa_one_euro_reset(self._handle)
+
+    def __del__(self):
+        if getattr(self, '_handle', None):
+            _lib.fa_one_euro_destroy(self._handle)
+            self._handle = None
@@ -0,0 +1,321 @@
+// Joint-space motion for random_points.cpp: time scaling (time_scaling.h), velocity-limited timing and
+// the robot.control callback itself. moveJoints and recoverRobot are templated on the robot so
+// the same code runs against franka::Robot and SimulatedRobot (simulated_robot.h), and the
+// callback is a named type so replay_harness.cpp can drive it from recorded ticks.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <utility>
+#include <franka/control_types.h>
+#include <franka/duration.h>
+#include <franka/exception.h>
+#include <franka/robot_state.h>
+#include "flight_recorder.h"
+#include "plan_cache.h"
+#include "segment_stats.h"
+#include "time_scaling.h"
+#include "trajectory_core.h"
+
+// Function to recover the robot if an error occurs
+template <typename Robot>
+void recoverRobot(Robot& robot) {
+    std::cout << "Attempting to recover robot from error state..." << std::endl;
+
+    try {
+        robot.automaticErrorRecovery();
+        std::cout << "Robot recovery successful!" << std::endl;
+    } catch (const franka::Exception& e) {
+        std::cerr << "Error during recovery: " << e.what() << std::endl;
+        std::cout << "Waiting 5 seconds before continuing..." << std::endl;
+        std::this_thread::sleep_for(std::chrono::seconds(5));
+    }
+}
+
+// Configurable max joint velocity (rad/s) - increased from 1.5 for better performance
+constexpr double MAX_JOINT_VELOCITY = 2.0;
+
+// Shortest duration for q_start -> q_end under MAX_JOINT_VELOCITY; critical_joint is set to the
+// (0-based) joint that needs it, or -1 if nothing moves
+template <size_t DOF, typename Scalar>
+Scalar minSafeMovementTime(const trajectory::Vector<DOF, Scalar>& q_start,
+                           const trajectory::Vector<DOF, Scalar>& q_end,
+                           int* critical_joint = nullptr) {
+    constexpr std::array<double, DOF> kSpeed = trajectory::uniform<DOF>(MAX_JOINT_VELOCITY);
+    return trajectory::minTravelTime(q_start, q_end, kSpeed, critical_joint);
+}
+
+// Check if the desired movement time is safe with respect to the robot's joint velocity limits.
+template <size_t DOF, typename Scalar>
+Scalar getSafeMovementTime(const trajectory::Vector<DOF, Scalar>& q_start,
+                           const trajectory::Vector<DOF, Scalar>& q_end,
+                           Scalar desired_time) {
+    int critical_joint = -1;
+    Scalar min_safe_time = minSafeMovementTime(q_start, q_end, &critical_joint);
+
+    if (desired_time >= min_safe_time) {
+        return desired_time;
+    } else {
+        Scalar max_delta = min_safe_time * static_cast<Scalar>(MAX_JOINT_VELOCITY);
+        std::cout << "WARNING: Requested time (" << desired_time << "s) is too fast!" << std::endl;
+        std::cout << "Joint " << critical_joint+1 << " would need to move at "
+                  << (max_delta / desired_time) << " rad/s (limit: " << MAX_JOINT_VELOCITY << " rad/s)" << std::endl;
+        std::cout << "Automatically increasing time to " << min_safe_time << "s for safety\n";
+        return min_safe_time;
+    }
+}
+
+// Control callback of one joint move: quintic (or another scaling's) interpolation from q_start
+// to q_target over duration seconds of accumulated callback periods, finishing at 1.01 x duration.
+class QuinticJointMotion {
+public:
+    QuinticJointMotion(const trajectory::ArmVector& q_start, const trajectory::ArmVector& q_target, double duration,
+                       ScalingFunction scaling = quinticPath)
+        : q_start_(q_start), q_target_(q_target), duration_(duration), scaling_(scaling) {}
+
+    franka::JointPositions operator()(const franka::RobotState& /*state*/, franka::Duration period) {
+        double time_passed = period.toSec();
+        time_total_ += time_passed;
+
+        double factor = scaling_(time_total_, duration_);
+        trajectory::ArmVector q_desired;
+        trajectory::interpolate(q_start_, q_target_, factor, q_desired);
+
+        if (time_total_ >= duration_ * 1.01) {  // Allow slight overshoot for smooth stop
+            return franka::MotionFinished(franka::JointPositions(q_desired));
+        }
+
+        return franka::JointPositions(q_desired);
+    }
+
+    double elapsed() const { return time_total_; }
+    double duration() const { return duration_; }
+
+private:
+    trajectory::ArmVector q_start_;
+    trajectory::ArmVector q_target_;
+    double duration_;
+    ScalingFunction scaling_;
+    double time_total_ = 0.0;
+};
+
+// Default planner for the plan cache: velocity-limited duration (divided by the move's velocity
+// scale) and the path in the move's time scaling sampled at 1 kHz
+inline std::shared_ptr<SegmentPlan> planJointSegment(const trajectory::ArmVector& q_start,
+                                                     const trajectory::ArmVector& q_target,
+                                                     double desired_duration, const MoveTiming& timing) {
+    auto plan = std::make_shared<SegmentPlan>();
+    plan->q_start = q_start;
+    plan->q_target = q_target;
+    plan->desired_duration = desired_duration;
+    plan->safe_duration = getSafeMovementTime(q_start, q_target, desired_duration) / timing.velocity_scale;
+    plan->scaling = timing.scaling;
+    samplePlan(*plan, scalingFunction(timing.scaling));
+    return plan;
+}
+
+// Settle detection at the end of a move: the control session holds the final command until every
+// joint has stayed below `velocity` and within `position` of the command for `window` seconds,
+// at most `timeout` seconds after the trajectory ends
+struct SettleOptions {
+    double velocity = 0.02;   // rad/s, measured |dq|
+    double position = 0.002;  // rad, |q_d - q|
+    double window = 0.02;     // s
+    double timeout = 0.5;     // s (0: end the session with the trajectory)
+};
+
+// Wraps a move's control callback (joint positions or Cartesian pose): once the motion reports
+// MotionFinished, its last command is held within the same session until the arm has settled
+// (see SettleOptions) or the timeout passes, and only then is MotionFinished returned.
+template <typename Motion>
+class SettlingMotion {
+public:
+    using Command = decltype(std::declval<Motion&>()(std::declval<const franka::RobotState&>(),
+                                                     std::declval<franka::Duration>()));
+
+    SettlingMotion(Motion& motion, const SettleOptions& options) : motion_(motion), options_(options) {}
+
+    Command operator()(const franka::RobotState& state, franka::Duration period) {
+        if (!hold_) {
+            Command command = motion_(state, period);
+            if (!command.motion_finished || options_.timeout <= 0.0) return command;
+            command.motion_finished = false;
+            hold_ = command;
+            return command;
+        }
+        settle_time_ += period.toSec();
+        bool still = true;
+        for (size_t i = 0; i < panda::kJoints && still; i++) {
+            still = std::abs(state.dq[i]) <= options_.velocity && std::abs(state.q_d[i] - state.q[i]) <= options_.position;
+        }
+        quiet_time_ = still ? quiet_time_ + period.toSec() : 0.0;
+        settled_ = quiet_time_ >= options_.window - 1e-9;
+        if (settled_ || settle_time_ >= options_.timeout - 1e-9) {
+            return franka::MotionFinished(*hold_);
+        }
+        return *hold_;
+    }
+
+    double settleTime() const { return settle_time_; }  // Hold after the trajectory (s)
+    bool settled() const { return settled_ || options_.timeout <= 0.0; }
+
+private:
+    Motion& motion_;
+    SettleOptions options_;
+    std::optional<Command> hold_;
+    double settle_time_ = 0.0;
+    double quiet_time_ = 0.0;
+    bool settled_ = false;
+};
+
+// Per-run state shared by every moveJoints call
+struct MoveContext {
+    flight_recorder::FlightRecorder& recorder;
+    std::string postmortem_dir;          // Post-mortem dumps go to <postmortem_dir>/postmortem_<time>
+    double postmortem_seconds;
+    PlanCache* plan_cache = nullptr;     // Reuse sampled plans across cycles (nullptr: plan every move)
+    PlanCache::Planner planner;          // Segment planner (empty: planJointSegment with the cache,
+                                         // QuinticJointMotion without)
+    SettleOptions settle;                // End-of-move settle detection
+    double torque_model_error = NAN;     // Budget model error if planner retimes for torque (recorded for replay)
+};
+
+// Flight recorder metadata of a move: start, target, durations and the settle options of context
+inline flight_recorder::SegmentRecord segmentRecord(const trajectory::ArmVector& q_start,
+                                                    const trajectory::ArmVector& q_target, double desired_duration,
+                                                    double safe_duration, const MoveTiming& timing,
+                                                    const MoveContext& context) {
+    flight_recorder::SegmentRecord segment{};
+    segment.q_start = segment.plan_start = q_start;
+    segment.q_target = q_target;
+    segment.desired_duration = desired_duration;
+    segment.safe_duration = safe_duration;
+    segment.scaling = static_cast<double>(timing.scaling);
+    segment.velocity_scale = timing.velocity_scale;
+    segment.settle = {{context.settle.velocity, context.settle.position, context.settle.window,
+                       context.settle.timeout}};
+    return segment;
+}
+
+// Writes the flight recorder's last seconds to <base>/postmortem_<unix time> after a control exception
+inline void dumpPostmortem(const flight_recorder::FlightRecorder& recorder, const std::string& base_dir, double seconds) {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    std::string dir = base_dir + "/postmortem_" + std::to_string(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+    size_t ticks = recorder.dumpRecent(dir, seconds);
+    std::cerr << "Flight recorder: wrote last " << ticks << " ticks to " << dir << std::endl;
+}
+
+// Runs one control session with `motion` as the callback (joint positions or, for
+// cartesian_motion.h, a Cartesian pose) followed by settle detection, recording every tick.
+// Returns the max |q_d - q| seen and sets the settle time and outcome in result.
+template <typename Robot, typename Motion>
+double runMotion(Robot& robot, Motion& motion, MoveContext& context, MoveResult& result) {
+    double max_tracking_error = 0.0;
+    SettlingMotion<Motion> settling(motion, context.settle);
+    flight_recorder::FlightRecorder& recorder = context.recorder;
+    robot.control([&settling, &recorder, &max_tracking_error](const franka::RobotState& state,
+                                                              franka::Duration period) {
+        recorder.record(state, period);
+        max_tracking_error = std::max(max_tracking_error, trajectory::maxAbsDifference(state.q_d, state.q));
+        return settling(state, period);
+    });
+    result.settle_time = settling.settleTime();
+    result.settled = settling.settled();
+    return max_tracking_error;
+}
+
+// Common end of a successful move: reports the timing (the session's wall-clock time minus the
+// settle hold), pauses for the move's `dwell` seconds and completes the result (desired and
+// safe durations and the settle time already set)
+inline void completeMove(MoveResult& result, double session_duration, double max_tracking_error, double dwell) {
+    double actual_duration = session_duration - result.settle_time;
+    std::cout << "Move completed! Desired: " << result.desired_duration
+              << "s, Actual: " << actual_duration << "s, Settle: " << result.settle_time * 1000.0 << "ms"
+              << (result.settled ? "" : " (timed out)") << "\n";
+    std::cout.flush();  // Explicit flush only when needed
+
+    // Optional pause from the dance file (dwell_ms=); settling is already done
+    if (dwell > 0.0) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(dwell));
+    }
+
+    result.success = true;
+    result.actual_duration = actual_duration;
+    result.overshoot = actual_duration - result.safe_duration;
+    result.max_tracking_error = max_tracking_error;
+}
+
+// Moves the robot's joints to a target configuration over the desired duration.
+// A quintic polynomial (or the scaling in `timing`) is used to interpolate between the current
+// and target joint positions, played back from the plan cache when one is configured. Every
+// control tick is copied into the flight recorder; on a control exception its recent history is
+// dumped before recovery.
+template <typename Robot>
+MoveResult moveJoints(Robot& robot, const trajectory::ArmVector& q_target, double desired_duration,
+                      MoveContext& context, const MoveTiming& timing = MoveTiming(), bool recover_on_error = true) {
+    MoveResult result;
+    result.desired_duration = desired_duration;
+    try {
+        // Read current joint positions
+        franka::RobotState state = robot.readOnce();
+        trajectory::ArmVector q_current = state.q;
+
+        // Calculate a safe duration based on the joint velocities (cached with its sampled path)
+        std::shared_ptr<const SegmentPlan> plan;
+        double safe_duration;
+        if (context.plan_cache != nullptr) {
+            plan = context.plan_cache->getOrPlan(q_current, q_target, desired_duration, timing,
+                                                 context.planner ? context.planner : planJointSegment);
+            safe_duration = plan->safe_duration;
+        } else if (context.planner) {
+            plan = context.planner(q_current, q_target, desired_duration, timing);
+            safe_duration = plan->safe_duration;
+        } else {
+            safe_duration = getSafeMovementTime(q_current, q_target, desired_duration) / timing.velocity_scale;
+        }
+        flight_recorder::SegmentRecord segment =
+            segmentRecord(q_current, q_target, desired_duration, safe_duration, timing, context);
+        if (plan) {
+            segment.plan_start = plan->q_start;
+            segment.motion = static_cast<double>(flight_recorder::SegmentMotion::kJointPlan);
+            segment.torque_model_error = context.torque_model_error;
+        }
+        context.recorder.beginSegment(segment);
+        result.safe_duration = safe_duration;
+
+        auto start_time = std::chrono::high_resolution_clock::now();
+
+        // Control loop: generates a smooth trajectory using quintic interpolation
+        double max_tracking_error;
+        if (plan) {
+            SampledJointMotion motion(*plan, q_current);
+            max_tracking_error = runMotion(robot, motion, context, result);
+        } else {
+            QuinticJointMotion motion(q_current, q_target, safe_duration, scalingFunction(timing.scaling));
+            max_tracking_error = runMotion(robot, motion, context, result);
+        }
+
+        auto end_time = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end_time - start_time;
+        completeMove(result, elapsed.count(), max_tracking_error, timing.dwell);
+        return result;
+    } catch (const franka::Exception& e) {
+        std::cerr << "Franka exception during joint motion: " << e.what() << std::endl;
+        dumpPostmortem(context.recorder, context.postmortem_dir, context.postmortem_seconds);
+        if (recover_on_error) {
+            std::cout << "Attempting to recover and retry..." << std::endl;
+            recoverRobot(robot);
+            MoveResult retry = moveJoints(robot, q_target, desired_duration, context, timing, false);
+            retry.recoveries += 1;
+            return retry;
+        }
+        return result;
+    }
+}
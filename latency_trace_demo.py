@@ -0,0 +1,117 @@
+#!/usr/bin/env python3
+"""
+End-to-end latency tracing against local stand-ins for the phone and Polymetis.
+A fake phone produces ARKit-rate samples, a client loop mirrors mujocoar_teleop.py
+(new-sample detection, arrival timestamp, one-way send) and the server side runs
+the real PoseSink (and optionally the TargetUpsampler) with a fake Polymetis call.
+Prints per-stage latency histograms and writes a Chrome/Perfetto trace.
+"""
+
+import argparse
+import threading
+import time
+import numpy as np
+import zmq
+from loop_rate_limiters import RateLimiter
+from streaming import PoseSink, PoseSender
+from tracing import LatencyTracer
+import config
+
+ENDPOINT = "tcp://127.0.0.1:{port}"
+
+
+class FakePhone:
+    """Stand-in for MujocoARConnector: publishes a moving pose at ARKit rate."""
+
+    def __init__(self, rate=60.0):
+        self.period = 1.0 / rate
+        self.data = {"position": None, "rotation": np.identity(3), "button": False}
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def _run(self):
+        start = time.time()
+        while self.running:
+            t = time.time() - start
+            # Replace the dict entry (like the connector does) instead of mutating in place
+            self.data["position"] = np.array([0.0, 0.1 * np.sin(t), 0.05 * np.sin(2 * t)])
+            time.sleep(self.period)
+
+    def get_latest_data(self):
+        return self.data
+
+
+def fake_polymetis(latency, jitter, rng):
+    def apply(*args):
+        time.sleep(latency + rng.uniform(0, jitter))
+    return apply
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Latency tracing with local phone/Polymetis stand-ins')
+    parser.add_argument('--duration', type=float, default=5.0)
+    parser.add_argument('--polymetis-latency', type=float, default=1.0, help='Fake Polymetis call time (ms)')
+    parser.add_argument('--polymetis-jitter', type=float, default=1.0, help='Extra random call time (ms)')
+    parser.add_argument('--upsample', action='store_true', help='Route targets through the TargetUpsampler')
+    parser.add_argument('--trace', default='latency_trace.json', help='Chrome/Perfetto trace output')
+    parser.add_argument('--port', type=int, default=5344)
+    args = parser.parse_args()
+
+    rng = np.random.default_rng(0)
+    polymetis = fake_polymetis(args.polymetis_latency / 1000.0, args.polymetis_jitter / 1000.0, rng)
+    tracer = LatencyTracer()
+    context = zmq.Context()
+
+    upsampler = None
+    if args.upsample:
+        from upsampling import TargetUpsampler
+        upsampler = TargetUpsampler(polymetis, rate=config.UPSAMPLING_RATE,
+                                    playout_delay=config.UPSAMPLING_PLAYOUT_DELAY, tracer=tracer)
+        upsampler.start()
+        apply_target = upsampler.push
+    else:
+        apply_target = lambda pose, stamp, seq: polymetis(pose)
+
+    sink = PoseSink(apply_target, ENDPOINT.format(port=args.port), context=context,
+                    tracer=tracer, traces_actuation=upsampler is None)
+    sink.start()
+    sender = PoseSender(ENDPOINT.format(port=args.port), context=context)
+    phone = FakePhone()
+    time.sleep(0.2)
+
+    # Client loop, as in mujocoar_teleop.py
+    rate = RateLimiter(frequency=config.CONTROL_FREQUENCY, warn=False)
+    pose = np.zeros(6)
+    last_position = None
+    stamp = None
+    end = time.time() + args.duration
+    while time.time() < end:
+        data = phone.get_latest_data()
+        new_sample = last_position is None or data["position"] is not last_position
+        if new_sample:
+            last_position = data["position"]
+            stamp = time.time()
+        if not (upsampler is not None and not new_sample):
+            pose[:3] = data["position"]
+            sender.send(pose, stamp)
+        rate.sleep()
+
+    time.sleep(0.1)
+    phone.running = False
+    sink.stop()
+    if upsampler is not None:
+        upsampler.stop()
+    sender.close()
+
+    mode = "upsampled" if upsampler is not None else "direct"
+    print(f"Pose target latency by stage ({mode}, fake Polymetis {args.polymetis_latency:.1f} ms)")
+    print("=" * 74)
+    tracer.print_summary()
+    print("=" * 74)
+    count = tracer.export_chrome_trace(args.trace)
+    print(f"Wrote {count} spans to {args.trace} (open in ui.perfetto.dev or chrome://tracing)")
+
+
+if __name__ == "__main__":
+    main()
@@ -12,7 +12,10 @@ interface = FrankaClient(
     server_ip=config.SERVER_IP,
     port=config.SERVER_PORT,
     connection_timeout=config.CONNECTION_TIMEOUT,
-    heartbeat_timeout=config.HEARTBEAT_TIMEOUT
+    heartbeat_timeout=config.HEARTBEAT_TIMEOUT,
+    state_port=config.STATE_PUBLISH_PORT,
+    pose_port=config.POSE_STREAM_PORT,
+    pose_ack_port=config.POSE_ACK_PORT if config.POSE_ACK_INTERVAL > 0 else None
 )
 
 # Start the AR connector
@@ -44,6 +47,8 @@ while connector.get_latest_data()["position"] is None:
 
 print(f"AR data received, starting control loop at {config.CONTROL_FREQUENCY} Hz...")
 last_episode_stop = None
+last_ack_errors = 0
+last_ar_position = None
 loop_counter = 0
 print_interval = int(config.CONTROL_FREQUENCY * config.PRINT_INTERVAL_MULTIPLIER)
 
@@ -51,14 +56,46 @@ print_interval = int(config.CONTROL_FREQUENCY * config.PRINT_INTERVAL_MULTIPLIER
 phone_pose = config.IDENTITY_4x4.copy()
 new_pos = config.ZERO_VECTOR_3.copy()
 updated_pose = config.ZERO_VECTOR_6.copy()
+ar_stamp = None
+
+# Optional One-Euro filter on the phone pose stream
+pose_filter = None
+if config.ONE_EURO_ENABLED:
+    from franka_ar_native import PoseOneEuroFilter
+    pose_filter = PoseOneEuroFilter(config.ONE_EURO_POS_MIN_CUTOFF, config.ONE_EURO_POS_BETA,
+                                    config.ONE_EURO_ROT_MIN_CUTOFF, config.ONE_EURO_ROT_BETA,
+                                    config.ONE_EURO_D_CUTOFF)
+    filtered_pos = config.ZERO_VECTOR_3.copy()
+    filtered_rot = config.IDENTITY_4x4[:3, :3].copy()
 
 while True:
     # Get latest AR data once per loop
     ar_data = connector.get_latest_data()
     
+    # Detect a new AR sample and timestamp it on arrival
+    new_ar_sample = last_ar_position is None or not np.array_equal(ar_data["position"], last_ar_position)
+    if new_ar_sample:
+        last_ar_position = np.array(ar_data["position"])
+        ar_stamp = time.time()
+    
+    # With server-side upsampling each AR sample is sent exactly once
+    if config.POSE_UPSAMPLING_ENABLED and not new_ar_sample:
+        loop_counter += 1
+        rate.sleep()
+        continue
+    
     # Update phone pose transformation matrix (reuse pre-allocated matrix)
-    phone_pose[:3, :3] = ar_data["rotation"]
-    phone_pose[:3, 3] = ar_data["position"]
+    if pose_filter is not None:
+        # Smooth ARKit tracking jitter; each AR sample is filtered once, at its arrival time
+        if new_ar_sample:
+            filtered = pose_filter.filter(ar_stamp, ar_data["position"], R.from_matrix(ar_data["rotation"]).as_quat())
+            filtered_pos[:] = filtered[:3]
+            filtered_rot[:] = R.from_quat(filtered[3:]).as_matrix()
+        phone_pose[:3, :3] = filtered_rot
+        phone_pose[:3, 3] = filtered_pos
+    else:
+        phone_pose[:3, :3] = ar_data["rotation"]
+        phone_pose[:3, 3] = ar_data["position"]
     
     # Apply front-of-robot transformation if needed (cached calculation)
     if config.INFRONT_OF_ROBOT and z_fix_pose is not None:
@@ -83,12 +120,29 @@ while True:
     
     # Update robot pose with improved error handling
     try:
-        interface.update_desired_ee_pose(updated_pose)
+        if config.POSE_STREAM_ENABLED:
+            # Fire-and-forget: loop rate no longer depends on the server round trip
+            interface.update_desired_ee_pose_oneway(updated_pose, ar_stamp)
+        else:
+            interface.update_desired_ee_pose(updated_pose)
     except Exception as e:
         if loop_counter % print_interval == 0:
             print(f"Communication error, restarting impedance control: {e}")
         interface.start_cartesian_impedance(Kx=config.CARTESIAN_KX, Kxd=config.CARTESIAN_KXD)
     
+    # One-way targets report failures through the periodic server ack instead of exceptions
+    if config.POSE_STREAM_ENABLED and config.POSE_ACK_INTERVAL > 0 and loop_counter % print_interval == 0 and loop_counter > 0:
+        ack = interface.pose_stream_ack()
+        if ack is None or time.time() - ack['received_at'] > config.POSE_ACK_TIMEOUT:
+            print("Pose stream: no ack from server, link may be down")
+        elif ack['errors'] > last_ack_errors:
+            last_ack_errors = ack['errors']
+            print("Pose stream: server failed to apply targets, restarting impedance control")
+            try:
+                interface.start_cartesian_impedance(Kx=config.CARTESIAN_KX, Kxd=config.CARTESIAN_KXD)
+            except Exception as e:
+                print(f"Failed to restart impedance control: {e}")
+
     # Handle button press with debouncing
     if ar_data["button"] is True:
         if last_episode_stop is None or time.time() - last_episode_stop > config.BUTTON_DEBOUNCE_TIME:
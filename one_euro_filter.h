@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "so3.h"
+
+// One-Euro filter (Casiez et al., CHI 2012): a first-order low-pass whose cutoff rises with
+// the signal speed, so the phone pose is smoothed heavily while the hand is still (jitter)
+// and lightly while it moves (lag). All state is fixed-size; filter() never allocates.
+
+namespace one_euro {
+
+// Smoothing factor of an exponential low-pass with the given cutoff for a step of dt seconds
+inline double alpha(double cutoff, double dt) {
+    double tau = 1.0 / (2.0 * M_PI * cutoff);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+}  // namespace one_euro
+
+// Vector One-Euro filter over N lanes that share one speed estimate (the vector norm of the
+// derivative), so a 3D position is filtered isotropically. Lanes are laid out contiguously
+// and every loop has a compile-time trip count so the compiler vectorizes it.
+template <std::size_t N>
+class OneEuroFilter {
+public:
+    using Vec = std::array<double, N>;
+
+    OneEuroFilter(double min_cutoff = 1.0, double beta = 0.0, double d_cutoff = 1.0)
+        : min_cutoff_(min_cutoff), beta_(beta), d_cutoff_(d_cutoff) {}
+
+    void reset() { initialized_ = false; }
+
+    void setParameters(double min_cutoff, double beta, double d_cutoff) {
+        min_cutoff_ = min_cutoff;
+        beta_ = beta;
+        d_cutoff_ = d_cutoff;
+    }
+
+    // Filter sample x taken at time t (seconds). Non-increasing timestamps return the last output.
+    const Vec& filter(double t, const Vec& x) {
+        if (!initialized_) {
+            x_hat_ = x;
+            dx_hat_ = Vec{};
+            t_ = t;
+            initialized_ = true;
+            return x_hat_;
+        }
+        double dt = t - t_;
+        if (dt <= 0.0) {
+            return x_hat_;
+        }
+        t_ = t;
+
+        double a_d = one_euro::alpha(d_cutoff_, dt);
+        double inv_dt = 1.0 / dt;
+        double speed2 = 0.0;
+        for (std::size_t i = 0; i < N; i++) {
+            double dx = (x[i] - x_hat_[i]) * inv_dt;
+            dx_hat_[i] += a_d * (dx - dx_hat_[i]);
+            speed2 += dx_hat_[i] * dx_hat_[i];
+        }
+
+        double a = one_euro::alpha(min_cutoff_ + beta_ * std::sqrt(speed2), dt);
+        for (std::size_t i = 0; i < N; i++) {
+            x_hat_[i] += a * (x[i] - x_hat_[i]);
+        }
+        return x_hat_;
+    }
+
+    const Vec& value() const { return x_hat_; }
+
+private:
+    double min_cutoff_, beta_, d_cutoff_;
+    bool initialized_ = false;
+    double t_ = 0.0;
+    Vec x_hat_{};
+    Vec dx_hat_{};
+};
+
+// One-Euro filter on the unit quaternion manifold. The derivative is the body angular
+// velocity log(q_hat^-1 q) / dt, its magnitude drives the cutoff, and the low-pass step is
+// a SLERP from the previous estimate towards the new sample by the smoothing factor.
+class QuaternionOneEuroFilter {
+public:
+    QuaternionOneEuroFilter(double min_cutoff = 1.0, double beta = 0.0, double d_cutoff = 1.0)
+        : min_cutoff_(min_cutoff), beta_(beta), d_cutoff_(d_cutoff) {}
+
+    void reset() { initialized_ = false; }
+
+    void setParameters(double min_cutoff, double beta, double d_cutoff) {
+        min_cutoff_ = min_cutoff;
+        beta_ = beta;
+        d_cutoff_ = d_cutoff;
+    }
+
+    const so3::Quat& filter(double t, const so3::Quat& q) {
+        if (!initialized_) {
+            q_hat_ = so3::quatNormalize(q);
+            w_hat_ = {0.0, 0.0, 0.0};
+            t_ = t;
+            initialized_ = true;
+            return q_hat_;
+        }
+        double dt = t - t_;
+        if (dt <= 0.0) {
+            return q_hat_;
+        }
+        t_ = t;
+
+        so3::Vec3 delta = so3::boxMinus(q, q_hat_);
+        double a_d = one_euro::alpha(d_cutoff_, dt);
+        double inv_dt = 1.0 / dt;
+        for (std::size_t i = 0; i < 3; i++) {
+            w_hat_[i] += a_d * (delta[i] * inv_dt - w_hat_[i]);
+        }
+        double speed = std::sqrt(w_hat_[0] * w_hat_[0] + w_hat_[1] * w_hat_[1] + w_hat_[2] * w_hat_[2]);
+
+        double a = one_euro::alpha(min_cutoff_ + beta_ * speed, dt);
+        q_hat_ = so3::boxPlus(q_hat_, {a * delta[0], a * delta[1], a * delta[2]});
+        return q_hat_;
+    }
+
+    const so3::Quat& value() const { return q_hat_; }
+
+private:
+    double min_cutoff_, beta_, d_cutoff_;
+    bool initialized_ = false;
+    double t_ = 0.0;
+    so3::Quat q_hat_{0.0, 0.0, 0.0, 1.0};
+    so3::Vec3 w_hat_{};
+};
+
+// Position + orientation filter for the phone pose stream
+struct PoseOneEuroFilter {
+    OneEuroFilter<3> position;
+    QuaternionOneEuroFilter orientation;
+
+    PoseOneEuroFilter(double pos_min_cutoff, double pos_beta, double rot_min_cutoff, double rot_beta,
+                      double d_cutoff)
+        : position(pos_min_cutoff, pos_beta, d_cutoff), orientation(rot_min_cutoff, rot_beta, d_cutoff) {}
+
+    void reset() {
+        position.reset();
+        orientation.reset();
+    }
+};
@@ -0,0 +1,347 @@
+// Panda rigid-body dynamics for offline torque prediction: recursive Newton-Euler inverse
+// dynamics (RNEA) and the composite-rigid-body mass matrix (CRBA). Link inertial parameters are
+// the identified values of Gaz et al. (RA-L 2019, as used by franka_description); the Franka
+// Hand is attached as an end-effector load with Desk's default parameters. Joint friction and
+// motor inertia are not modelled.
+//
+// Everything is templated on the scalar type. With panda::Batch<N> one call evaluates N states,
+// lane by lane in SIMD registers (build with -march=native so Batch<4> fits an AVX register).
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "panda_kinematics.h"
+
+namespace panda {
+
+constexpr double kGravity = 9.81;  // m/s^2, along -z of the base
+
+// Mass, centre of mass and inertia about the centre of mass (xx, yy, zz, xy, xz, yz), in the
+// link frame
+struct LinkInertia {
+    double mass;
+    std::array<double, 3> com;
+    std::array<double, 6> inertia;
+};
+
+constexpr std::array<LinkInertia, 7> kLinkInertia{{
+    {4.970684, {{3.875e-03, 2.081e-03, -4.762e-02}}, {{7.0337e-01, 7.0661e-01, 9.117e-03, -1.39e-04, 6.772e-03, 1.9169e-02}}},
+    {0.646926, {{-3.141e-03, -2.872e-02, 3.495e-03}}, {{7.962e-03, 2.811e-02, 2.5995e-02, -3.925e-03, 1.0254e-02, 7.04e-04}}},
+    {3.228604, {{2.7518e-02, 3.9252e-02, -6.6502e-02}}, {{3.7242e-02, 3.6155e-02, 1.083e-02, -4.761e-03, -1.1396e-02, -1.2805e-02}}},
+    {3.587895, {{-5.317e-02, 1.04419e-01, 2.7454e-02}}, {{2.5853e-02, 1.9552e-02, 2.8323e-02, 7.796e-03, -1.332e-03, 8.641e-03}}},
+    {1.225946, {{-1.1953e-02, 4.1065e-02, -3.8437e-02}}, {{3.5549e-02, 2.9474e-02, 8.627e-03, -2.117e-03, -4.037e-03, 2.29e-04}}},
+    {1.666555, {{6.0149e-02, -1.4117e-02, -1.0517e-02}}, {{1.964e-03, 4.354e-03, 5.433e-03, 1.09e-04, -1.158e-03, 3.41e-04}}},
+    {7.35522e-01, {{1.0517e-02, -4.252e-03, 6.1597e-02}}, {{1.2516e-02, 1.0027e-02, 4.815e-03, -4.28e-04, -1.196e-03, -7.41e-04}}},
+}};
+
+// End-effector load in the flange frame (as set in Desk / Robot::setLoad)
+constexpr LinkInertia kFrankaHand{0.73, {{-0.01, 0.0, 0.03}}, {{0.001, 0.0025, 0.0017, 0.0, 0.0, 0.0}}};
+
+// Native vector types for Batch (GCC/Clang vector extensions)
+template <size_t N>
+struct BatchLanes;
+template <>
+struct BatchLanes<2> {
+    typedef double type __attribute__((vector_size(16)));
+};
+template <>
+struct BatchLanes<4> {
+    typedef double type __attribute__((vector_size(32)));
+};
+template <>
+struct BatchLanes<8> {
+    typedef double type __attribute__((vector_size(64)));
+};
+
+// N lanes of double (N = 2, 4 or 8) with element-wise arithmetic in SIMD registers; lane k of a
+// batch b is b.lane[k]
+template <size_t N>
+struct Batch {
+    typename BatchLanes<N>::type lane{};
+
+    Batch() = default;
+    Batch(double value) { lane = lane * 0.0 + value; }
+
+    Batch& operator+=(const Batch& o) {
+        lane += o.lane;
+        return *this;
+    }
+    Batch& operator-=(const Batch& o) {
+        lane -= o.lane;
+        return *this;
+    }
+    Batch& operator*=(const Batch& o) {
+        lane *= o.lane;
+        return *this;
+    }
+    friend Batch operator+(Batch a, const Batch& b) { return a += b; }
+    friend Batch operator-(Batch a, const Batch& b) { return a -= b; }
+    friend Batch operator*(Batch a, const Batch& b) { return a *= b; }
+    friend Batch operator-(Batch a) {
+        a.lane = -a.lane;
+        return a;
+    }
+    friend void sinCos(const Batch& a, Batch& s, Batch& c) {
+        for (size_t k = 0; k < N; k++) {
+            s.lane[k] = std::sin(a.lane[k]);
+            c.lane[k] = std::cos(a.lane[k]);
+        }
+    }
+};
+
+inline void sinCos(double a, double& s, double& c) {
+    s = std::sin(a);
+    c = std::cos(a);
+}
+
+template <typename Scalar>
+using JointVector = std::array<Scalar, 7>;
+
+namespace dynamics_detail {
+
+template <typename Scalar>
+using Vec = std::array<Scalar, 3>;
+
+template <typename Scalar>
+Vec<Scalar> cross(const Vec<Scalar>& a, const Vec<Scalar>& b) {
+    return {{a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]}};
+}
+
+template <typename Scalar>
+Vec<Scalar> add(const Vec<Scalar>& a, const Vec<Scalar>& b) {
+    return {{a[0] + b[0], a[1] + b[1], a[2] + b[2]}};
+}
+
+// Constant vector (link geometry) as Scalar
+template <typename Scalar>
+Vec<Scalar> constant(const std::array<double, 3>& v) {
+    return {{Scalar(v[0]), Scalar(v[1]), Scalar(v[2])}};
+}
+
+// Rotation of a child frame in its parent, RotX(alpha) RotZ(theta), applied without building
+// the matrix
+template <typename Scalar>
+struct JointRotation {
+    Scalar ct, st;
+    double ca, sa;
+
+    // Parent-frame vector to the child frame (R^T v)
+    Vec<Scalar> toChild(const Vec<Scalar>& v) const {
+        Scalar y = ca * v[1] + sa * v[2];
+        return {{ct * v[0] + st * y, ct * y - st * v[0], ca * v[2] - sa * v[1]}};
+    }
+
+    // Child-frame vector to the parent frame (R v)
+    Vec<Scalar> toParent(const Vec<Scalar>& v) const {
+        Scalar x = ct * v[0] - st * v[1];
+        Scalar y = st * v[0] + ct * v[1];
+        return {{x, ca * y - sa * v[2], sa * y + ca * v[2]}};
+    }
+};
+
+// Link with the end-effector load merged in: mass, first moment m c and inertia about the
+// centre of mass (row-major 3 x 3), all in the link frame
+struct RigidBody {
+    double mass;
+    std::array<double, 3> com;
+    std::array<double, 3> first_moment;
+    std::array<double, 9> inertia;
+};
+
+inline std::array<double, 9> inertiaMatrix(const std::array<double, 6>& i) {
+    return {{i[0], i[3], i[4], i[3], i[1], i[5], i[4], i[5], i[2]}};
+}
+
+// Adds the inertia of a point mass m at r, m (|r|^2 I - r r^T)
+inline void addPointInertia(std::array<double, 9>& inertia, double m, const std::array<double, 3>& r) {
+    double rr = r[0] * r[0] + r[1] * r[1] + r[2] * r[2];
+    for (size_t a = 0; a < 3; a++) {
+        for (size_t b = 0; b < 3; b++) {
+            inertia[3 * a + b] += m * ((a == b ? rr : 0.0) - r[a] * r[b]);
+        }
+    }
+}
+
+inline std::array<RigidBody, 7> makeBodies(const LinkInertia& load) {
+    std::array<RigidBody, 7> bodies;
+    for (size_t i = 0; i < 7; i++) {
+        const LinkInertia& link = kLinkInertia[i];
+        bodies[i].mass = link.mass;
+        bodies[i].com = link.com;
+        bodies[i].inertia = inertiaMatrix(link.inertia);
+    }
+    // The flange is frame 7 shifted by d along z, so the load's frame has link 7's orientation
+    RigidBody& last = bodies[6];
+    std::array<double, 3> load_com{{load.com[0], load.com[1], load.com[2] + kDh[7].d}};
+    double mass = last.mass + load.mass;
+    std::array<double, 3> com;
+    for (size_t a = 0; a < 3; a++) com[a] = (last.mass * last.com[a] + load.mass * load_com[a]) / mass;
+    std::array<double, 9> inertia = last.inertia;
+    std::array<double, 9> load_inertia = inertiaMatrix(load.inertia);
+    for (size_t k = 0; k < 9; k++) inertia[k] += load_inertia[k];
+    std::array<double, 3> r_last{}, r_load{};
+    for (size_t a = 0; a < 3; a++) {
+        r_last[a] = last.com[a] - com[a];
+        r_load[a] = load_com[a] - com[a];
+    }
+    addPointInertia(inertia, last.mass, r_last);
+    addPointInertia(inertia, load.mass, r_load);
+    last.mass = mass;
+    last.com = com;
+    last.inertia = inertia;
+    for (RigidBody& body : bodies) {
+        for (size_t a = 0; a < 3; a++) body.first_moment[a] = body.mass * body.com[a];
+    }
+    return bodies;
+}
+
+template <typename Scalar>
+Vec<Scalar> multiply(const std::array<double, 9>& m, const Vec<Scalar>& v) {
+    return {{m[0] * v[0] + m[1] * v[1] + m[2] * v[2], m[3] * v[0] + m[4] * v[1] + m[5] * v[2],
+             m[6] * v[0] + m[7] * v[1] + m[8] * v[2]}};
+}
+
+}  // namespace dynamics_detail
+
+template <typename Scalar>
+class Dynamics {
+public:
+    using Joints = JointVector<Scalar>;
+
+    explicit Dynamics(const LinkInertia& load = kFrankaHand) : bodies_(dynamics_detail::makeBodies(load)) {
+        for (size_t i = 0; i < 8; i++) {
+            cos_alpha_[i] = std::cos(kDh[i].alpha);
+            sin_alpha_[i] = std::sin(kDh[i].alpha);
+            origin_[i] = {{kDh[i].a, -kDh[i].d * sin_alpha_[i], kDh[i].d * cos_alpha_[i]}};
+        }
+    }
+
+    // Joint torques for the motion (q, dq, ddq), including gravity unless with_gravity is false (RNEA)
+    Joints inverseDynamics(const Joints& q, const Joints& dq, const Joints& ddq, bool with_gravity = true) const {
+        using namespace dynamics_detail;
+        std::array<JointRotation<Scalar>, 7> rotation = rotations(q);
+        std::array<Vec<Scalar>, 7> force, moment;
+
+        // Forward: link velocities and accelerations, and the net force/moment on each link
+        Vec<Scalar> w{}, dw{};
+        Vec<Scalar> dv{{Scalar(0.0), Scalar(0.0), Scalar(with_gravity ? kGravity : 0.0)}};
+        for (size_t i = 0; i < 7; i++) {
+            const JointRotation<Scalar>& R = rotation[i];
+            Vec<Scalar> p = constant<Scalar>(origin_[i]);
+            dv = R.toChild(add(add(cross(dw, p), cross(w, cross(w, p))), dv));
+            Vec<Scalar> w_parent = R.toChild(w);
+            w = w_parent;
+            w[2] += dq[i];
+            dw = add(R.toChild(dw), cross(w_parent, Vec<Scalar>{{Scalar(0.0), Scalar(0.0), dq[i]}}));
+            dw[2] += ddq[i];
+
+            const dynamics_detail::RigidBody& body = bodies_[i];
+            Vec<Scalar> c = constant<Scalar>(body.com);
+            Vec<Scalar> dv_com = add(add(cross(dw, c), cross(w, cross(w, c))), dv);
+            for (size_t a = 0; a < 3; a++) force[i][a] = body.mass * dv_com[a];
+            moment[i] = add(multiply(body.inertia, dw), cross(w, multiply(body.inertia, w)));
+        }
+
+        // Backward: forces transmitted through the joints
+        Joints tau;
+        Vec<Scalar> f{}, n{};
+        for (size_t k = 7; k-- > 0;) {
+            Vec<Scalar> n_child{}, f_child{};
+            if (k < 6) {
+                f_child = rotation[k + 1].toParent(f);
+                n_child = add(rotation[k + 1].toParent(n), cross(constant<Scalar>(origin_[k + 1]), f_child));
+            }
+            n = add(add(moment[k], n_child), cross(constant<Scalar>(bodies_[k].com), force[k]));
+            f = add(force[k], f_child);
+            tau[k] = n[2];
+        }
+        return tau;
+    }
+
+    // Gravity torques g(q)
+    Joints gravity(const Joints& q) const {
+        Joints zero;
+        zero.fill(Scalar(0.0));
+        return inverseDynamics(q, zero, zero);
+    }
+
+    // Joint-space mass matrix M(q), row-major 7 x 7 (CRBA)
+    std::array<Scalar, 49> massMatrix(const Joints& q) const {
+        using namespace dynamics_detail;
+        std::array<JointRotation<Scalar>, 7> rotation = rotations(q);
+
+        // Composite bodies about each joint origin: mass, first moment and rotational inertia
+        std::array<Vec<Scalar>, 7> h;
+        std::array<std::array<Scalar, 9>, 7> inertia;
+        std::array<double, 7> mass;
+        for (size_t i = 0; i < 7; i++) {
+            const RigidBody& body = bodies_[i];
+            mass[i] = body.mass;
+            h[i] = constant<Scalar>(body.first_moment);
+            std::array<double, 9> origin_inertia = body.inertia;
+            addPointInertia(origin_inertia, body.mass, body.com);
+            for (size_t k = 0; k < 9; k++) inertia[i][k] = Scalar(origin_inertia[k]);
+        }
+        for (size_t i = 6; i > 0; i--) {
+            // Move composite i into frame i-1 and add it to body i-1
+            const JointRotation<Scalar>& R = rotation[i];
+            Vec<Scalar> p = constant<Scalar>(origin_[i]);
+            Vec<Scalar> Rh = R.toParent(h[i]);
+            std::array<Vec<Scalar>, 3> columns;
+            for (size_t b = 0; b < 3; b++) {
+                columns[b] = R.toParent(Vec<Scalar>{{inertia[i][b], inertia[i][3 + b], inertia[i][6 + b]}});
+            }
+            // R I R^T, row by row
+            for (size_t a = 0; a < 3; a++) {
+                Vec<Scalar> row = R.toParent(Vec<Scalar>{{columns[0][a], columns[1][a], columns[2][a]}});
+                for (size_t b = 0; b < 3; b++) inertia[i - 1][3 * a + b] += row[b];
+            }
+            Scalar shift = 2.0 * (Rh[0] * p[0] + Rh[1] * p[1] + Rh[2] * p[2]) +
+                           mass[i] * (p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+            for (size_t a = 0; a < 3; a++) {
+                inertia[i - 1][4 * a] += shift;
+                for (size_t b = 0; b < 3; b++) {
+                    inertia[i - 1][3 * a + b] -= Rh[a] * p[b] + p[a] * Rh[b] + mass[i] * p[a] * p[b];
+                }
+            }
+            h[i - 1] = add(h[i - 1], add(Rh, Vec<Scalar>{{mass[i] * p[0], mass[i] * p[1], mass[i] * p[2]}}));
+            mass[i - 1] += mass[i];
+        }
+
+        // Unit acceleration of joint i: force (z x h, I z) about joint i, carried to each ancestor
+        std::array<Scalar, 49> M;
+        for (size_t i = 0; i < 7; i++) {
+            Vec<Scalar> f{{-h[i][1], h[i][0], Scalar(0.0)}};
+            Vec<Scalar> n{{inertia[i][2], inertia[i][5], inertia[i][8]}};
+            M[7 * i + i] = n[2];
+            for (size_t j = i; j > 0; j--) {
+                f = rotation[j].toParent(f);
+                n = add(rotation[j].toParent(n), cross(constant<Scalar>(origin_[j]), f));
+                M[7 * i + (j - 1)] = n[2];
+                M[7 * (j - 1) + i] = n[2];
+            }
+        }
+        return M;
+    }
+
+    // Links with the load merged into link 7
+    const std::array<dynamics_detail::RigidBody, 7>& bodies() const { return bodies_; }
+
+private:
+    std::array<dynamics_detail::JointRotation<Scalar>, 7> rotations(const Joints& q) const {
+        std::array<dynamics_detail::JointRotation<Scalar>, 7> rotation;
+        for (size_t i = 0; i < 7; i++) {
+            sinCos(q[i], rotation[i].st, rotation[i].ct);
+            rotation[i].ca = cos_alpha_[i];
+            rotation[i].sa = sin_alpha_[i];
+        }
+        return rotation;
+    }
+
+    std::array<dynamics_detail::RigidBody, 7> bodies_;
+    std::array<std::array<double, 3>, 8> origin_;  // Origin of frame i in frame i-1
+    std::array<double, 8> cos_alpha_, sin_alpha_;
+};
+
+}  // namespace panda
@@ -0,0 +1,273 @@
+// Panda forward kinematics, geometric Jacobian, manipulability, damped least-squares inverse
+// kinematics and a coarse capsule model for self-collision checks in the offline dance tools
+// and the simulated robot. Frames follow Franka's modified DH parameters; the end effector is
+// the Franka Hand TCP (flange + 0.1034 m along z), i.e. the robot's O_T_EE with the hand.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include "panda_limits.h"
+
+namespace panda {
+
+using Vec3 = std::array<double, 3>;
+using Rot3 = std::array<double, 9>;  // Row-major rotation matrix
+
+struct Frame {
+    Rot3 R;
+    Vec3 p;
+};
+
+struct DhParameter {
+    double a;
+    double d;
+    double alpha;
+};
+
+// Joints 1-7 and the flange (modified DH: RotX(alpha) TransX(a) RotZ(theta) TransZ(d))
+constexpr std::array<DhParameter, 8> kDh{{
+    {0.0, 0.333, 0.0},
+    {0.0, 0.0, -M_PI_2},
+    {0.0, 0.316, M_PI_2},
+    {0.0825, 0.0, M_PI_2},
+    {-0.0825, 0.384, -M_PI_2},
+    {0.0, 0.0, M_PI_2},
+    {0.088, 0.0, M_PI_2},
+    {0.0, 0.107, 0.0},
+}};
+constexpr double kHandOffset = 0.1034;  // Flange to TCP (m)
+
+// Frames 1-7, the flange and the TCP, in the base frame
+struct Kinematics {
+    std::array<Frame, 9> frames;
+
+    const Vec3& tcp() const { return frames[8].p; }
+};
+
+// Child frame of `parent` offset by (a, d, alpha) and rotated by theta about the new z
+inline Frame dhChild(const Frame& parent, const DhParameter& dh, double theta) {
+    double ct = std::cos(theta), st = std::sin(theta);
+    double ca = std::cos(dh.alpha), sa = std::sin(dh.alpha);
+    const Rot3 local{{ct, -st, 0.0, st * ca, ct * ca, -sa, st * sa, ct * sa, ca}};
+    const Vec3 offset{{dh.a, -dh.d * sa, dh.d * ca}};
+    Frame child;
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t c = 0; c < 3; c++) {
+            child.R[3 * r + c] = parent.R[3 * r] * local[c] + parent.R[3 * r + 1] * local[3 + c] +
+                                 parent.R[3 * r + 2] * local[6 + c];
+        }
+        child.p[r] = parent.p[r] + parent.R[3 * r] * offset[0] + parent.R[3 * r + 1] * offset[1] +
+                     parent.R[3 * r + 2] * offset[2];
+    }
+    return child;
+}
+
+inline Kinematics forwardKinematics(const std::array<double, 7>& q) {
+    Kinematics k;
+    Frame base{{{1.0, 0.0, 0.0, 0.0, 1.0, 0.0, 0.0, 0.0, 1.0}}, {{0.0, 0.0, 0.0}}};
+    for (size_t i = 0; i < 8; i++) {
+        k.frames[i] = dhChild(i == 0 ? base : k.frames[i - 1], kDh[i], i < 7 ? q[i] : 0.0);
+    }
+    k.frames[8] = dhChild(k.frames[7], {0.0, kHandOffset, 0.0}, -M_PI_4);
+    return k;
+}
+
+// Geometric Jacobian of the TCP (rows: linear x y z, angular x y z; row-major 6 x 7)
+inline std::array<double, 42> jacobian(const Kinematics& k) {
+    std::array<double, 42> J{};
+    const Vec3& tcp = k.tcp();
+    for (size_t i = 0; i < 7; i++) {
+        const Frame& frame = k.frames[i];
+        Vec3 z{{frame.R[2], frame.R[5], frame.R[8]}};
+        Vec3 r{{tcp[0] - frame.p[0], tcp[1] - frame.p[1], tcp[2] - frame.p[2]}};
+        J[0 * 7 + i] = z[1] * r[2] - z[2] * r[1];
+        J[1 * 7 + i] = z[2] * r[0] - z[0] * r[2];
+        J[2 * 7 + i] = z[0] * r[1] - z[1] * r[0];
+        J[3 * 7 + i] = z[0];
+        J[4 * 7 + i] = z[1];
+        J[5 * 7 + i] = z[2];
+    }
+    return J;
+}
+
+// Yoshikawa manipulability sqrt(det(J J^T)); 0 at singularities
+inline double manipulability(const std::array<double, 42>& J) {
+    std::array<double, 36> A{};
+    for (size_t r = 0; r < 6; r++) {
+        for (size_t c = 0; c <= r; c++) {
+            double sum = 0.0;
+            for (size_t i = 0; i < 7; i++) sum += J[r * 7 + i] * J[c * 7 + i];
+            A[r * 6 + c] = A[c * 6 + r] = sum;
+        }
+    }
+    // Cholesky: det(A) is the squared product of the diagonal of L
+    double det_sqrt = 1.0;
+    for (size_t j = 0; j < 6; j++) {
+        double diagonal = A[j * 6 + j];
+        for (size_t k = 0; k < j; k++) diagonal -= A[j * 6 + k] * A[j * 6 + k];
+        if (diagonal <= 0.0) return 0.0;
+        double l = std::sqrt(diagonal);
+        A[j * 6 + j] = l;
+        det_sqrt *= l;
+        for (size_t r = j + 1; r < 6; r++) {
+            double sum = A[r * 6 + j];
+            for (size_t k = 0; k < j; k++) sum -= A[r * 6 + k] * A[j * 6 + k];
+            A[r * 6 + j] = sum / l;
+        }
+    }
+    return det_sqrt;
+}
+
+// Rotation taking R to R_target, as a rotation vector in the base frame (log(R_target R^T))
+inline Vec3 rotationError(const Rot3& R_target, const Rot3& R) {
+    Rot3 E;
+    for (size_t r = 0; r < 3; r++) {
+        for (size_t c = 0; c < 3; c++) {
+            E[3 * r + c] = R_target[3 * r] * R[3 * c] + R_target[3 * r + 1] * R[3 * c + 1] +
+                           R_target[3 * r + 2] * R[3 * c + 2];
+        }
+    }
+    Vec3 v{{0.5 * (E[7] - E[5]), 0.5 * (E[2] - E[6]), 0.5 * (E[3] - E[1])}};
+    double sin_angle = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    double angle = std::atan2(sin_angle, 0.5 * (E[0] + E[4] + E[8] - 1.0));
+    double k = sin_angle < 1e-9 ? 1.0 : angle / sin_angle;
+    return {{v[0] * k, v[1] * k, v[2] * k}};
+}
+
+// Damped least-squares inverse kinematics for the TCP: iterates q (in place, clamped to the
+// joint limits, at most max_step rad per joint and iteration) towards `target`. Returns true
+// once the position error is below `tolerance` metres and the orientation error below
+// `tolerance` radians. Seeded with the previous solution, a few iterations per control tick
+// track a continuous Cartesian path.
+inline bool inverseKinematics(const Frame& target, std::array<double, 7>& q, size_t iterations = 20,
+                              double tolerance = 1e-6, double damping = 1e-3, double max_step = 0.2) {
+    for (size_t iteration = 0; iteration <= iterations; iteration++) {
+        Kinematics k = forwardKinematics(q);
+        const Frame& tcp = k.frames[8];
+        Vec3 rotation = rotationError(target.R, tcp.R);
+        std::array<double, 6> error{{target.p[0] - tcp.p[0], target.p[1] - tcp.p[1], target.p[2] - tcp.p[2],
+                                     rotation[0], rotation[1], rotation[2]}};
+        double position_error = std::sqrt(error[0] * error[0] + error[1] * error[1] + error[2] * error[2]);
+        double rotation_error = std::sqrt(error[3] * error[3] + error[4] * error[4] + error[5] * error[5]);
+        if (position_error < tolerance && rotation_error < tolerance) return true;
+        if (iteration == iterations) break;
+
+        // dq = J^T (J J^T + damping^2 I)^-1 error, solved with a Cholesky factorization
+        std::array<double, 42> J = jacobian(k);
+        std::array<double, 36> A{};
+        for (size_t r = 0; r < 6; r++) {
+            for (size_t c = 0; c <= r; c++) {
+                double sum = r == c ? damping * damping : 0.0;
+                for (size_t i = 0; i < 7; i++) sum += J[r * 7 + i] * J[c * 7 + i];
+                A[r * 6 + c] = A[c * 6 + r] = sum;
+            }
+        }
+        for (size_t j = 0; j < 6; j++) {
+            for (size_t m = 0; m < j; m++) A[j * 6 + j] -= A[j * 6 + m] * A[j * 6 + m];
+            A[j * 6 + j] = std::sqrt(A[j * 6 + j]);
+            for (size_t r = j + 1; r < 6; r++) {
+                for (size_t m = 0; m < j; m++) A[r * 6 + j] -= A[r * 6 + m] * A[j * 6 + m];
+                A[r * 6 + j] /= A[j * 6 + j];
+            }
+        }
+        std::array<double, 6> y = error;
+        for (size_t r = 0; r < 6; r++) {
+            for (size_t m = 0; m < r; m++) y[r] -= A[r * 6 + m] * y[m];
+            y[r] /= A[r * 6 + r];
+        }
+        for (size_t r = 6; r-- > 0;) {
+            for (size_t m = r + 1; m < 6; m++) y[r] -= A[m * 6 + r] * y[m];
+            y[r] /= A[r * 6 + r];
+        }
+        std::array<double, 7> step{};
+        double largest = 0.0;
+        for (size_t i = 0; i < 7; i++) {
+            for (size_t r = 0; r < 6; r++) step[i] += J[r * 7 + i] * y[r];
+            largest = std::max(largest, std::abs(step[i]));
+        }
+        double scale = largest > max_step ? max_step / largest : 1.0;
+        for (size_t i = 0; i < 7; i++) {
+            q[i] = std::clamp(q[i] + scale * step[i], kJointPositionMin[i], kJointPositionMax[i]);
+        }
+    }
+    return false;
+}
+
+struct Capsule {
+    Vec3 a;
+    Vec3 b;
+    double radius;
+};
+
+// Coarse link capsules: base column, upper arm, elbow, forearm, wrist, hand (flange to TCP)
+constexpr size_t kCapsules = 6;
+
+inline std::array<Capsule, kCapsules> linkCapsules(const Kinematics& k) {
+    // The forearm capsule stops short of the wrist centre, which the wrist capsule covers;
+    // otherwise it would always touch the hand capsule
+    const Vec3& elbow = k.frames[3].p;
+    const Vec3& wrist = k.frames[4].p;
+    Vec3 forearm_end;
+    for (size_t i = 0; i < 3; i++) forearm_end[i] = elbow[i] + 0.75 * (wrist[i] - elbow[i]);
+    return {{
+        {{{0.0, 0.0, 0.0}}, k.frames[0].p, 0.09},
+        {k.frames[1].p, k.frames[2].p, 0.08},
+        {k.frames[2].p, k.frames[3].p, 0.07},
+        {elbow, forearm_end, 0.07},
+        {k.frames[5].p, k.frames[6].p, 0.07},
+        {k.frames[7].p, k.tcp(), 0.06},
+    }};
+}
+
+// Pairs of capsules that are not neighbours in the chain and can therefore collide
+constexpr std::array<std::array<size_t, 2>, 7> kCollisionPairs{{
+    {{0, 3}}, {{0, 4}}, {{0, 5}}, {{1, 4}}, {{1, 5}}, {{2, 5}}, {{3, 5}},
+}};
+
+// Distance between segments p1-q1 and p2-q2 (closest points, Ericson 5.1.9)
+inline double segmentDistance(const Vec3& p1, const Vec3& q1, const Vec3& p2, const Vec3& q2) {
+    auto dot = [](const Vec3& u, const Vec3& v) { return u[0] * v[0] + u[1] * v[1] + u[2] * v[2]; };
+    Vec3 d1{{q1[0] - p1[0], q1[1] - p1[1], q1[2] - p1[2]}};
+    Vec3 d2{{q2[0] - p2[0], q2[1] - p2[1], q2[2] - p2[2]}};
+    Vec3 r{{p1[0] - p2[0], p1[1] - p2[1], p1[2] - p2[2]}};
+    double a = dot(d1, d1), e = dot(d2, d2), f = dot(d2, r);
+    double s = 0.0, t = 0.0;
+    constexpr double kTiny = 1e-12;
+    if (a <= kTiny && e <= kTiny) {
+        // Both segments are points
+    } else if (a <= kTiny) {
+        t = std::clamp(f / e, 0.0, 1.0);
+    } else {
+        double c = dot(d1, r);
+        if (e <= kTiny) {
+            s = std::clamp(-c / a, 0.0, 1.0);
+        } else {
+            double b = dot(d1, d2), denominator = a * e - b * b;
+            s = denominator > kTiny ? std::clamp((b * f - c * e) / denominator, 0.0, 1.0) : 0.0;
+            t = (b * s + f) / e;
+            if (t < 0.0) {
+                t = 0.0;
+                s = std::clamp(-c / a, 0.0, 1.0);
+            } else if (t > 1.0) {
+                t = 1.0;
+                s = std::clamp((b - c) / a, 0.0, 1.0);
+            }
+        }
+    }
+    Vec3 gap{{r[0] + d1[0] * s - d2[0] * t, r[1] + d1[1] * s - d2[1] * t, r[2] + d1[2] * s - d2[2] * t}};
+    return std::sqrt(dot(gap, gap));
+}
+
+// True if any non-adjacent link capsules come closer than `clearance`
+inline bool selfCollision(const Kinematics& k, double clearance = 0.0) {
+    std::array<Capsule, kCapsules> capsules = linkCapsules(k);
+    for (const auto& pair : kCollisionPairs) {
+        const Capsule& u = capsules[pair[0]];
+        const Capsule& v = capsules[pair[1]];
+        if (segmentDistance(u.a, u.b, v.a, v.b) < u.radius + v.radius + clearance) return true;
+    }
+    return false;
+}
+
+}  // namespace panda
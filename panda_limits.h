@@ -0,0 +1,38 @@
+// Franka Emika Panda joint limits (from the robot's datasheet), shared by the offline dance
+// tools. Commands beyond the velocity/acceleration/jerk limits are rejected by the robot.
+#pragma once
+
+#include <array>
+
+namespace panda {
+
+constexpr size_t kJoints = 7;
+
+constexpr std::array<double, kJoints> kJointPositionMin{{-2.8973, -1.7628, -2.8973, -3.0718, -2.8973, -0.0175, -2.8973}};
+constexpr std::array<double, kJoints> kJointPositionMax{{2.8973, 1.7628, 2.8973, -0.0698, 2.8973, 3.7525, 2.8973}};
+constexpr std::array<double, kJoints> kJointVelocityMax{{2.175, 2.175, 2.175, 2.175, 2.61, 2.61, 2.61}};           // rad/s
+constexpr std::array<double, kJoints> kJointAccelerationMax{{15.0, 7.5, 10.0, 12.5, 15.0, 20.0, 20.0}};         // rad/s^2
+constexpr std::array<double, kJoints> kJointJerkMax{{7500.0, 3750.0, 5000.0, 6250.0, 7500.0, 10000.0, 10000.0}};  // rad/s^3
+constexpr std::array<double, kJoints> kJointTorqueMax{{87.0, 87.0, 87.0, 87.0, 12.0, 12.0, 12.0}};              // Nm
+
+// Cartesian (end effector) limits for CartesianPose commands
+constexpr double kCartesianVelocityMax = 1.7;               // m/s
+constexpr double kCartesianAccelerationMax = 13.0;          // m/s^2
+constexpr double kCartesianJerkMax = 6500.0;                // m/s^3
+constexpr double kCartesianAngularVelocityMax = 2.5;        // rad/s
+constexpr double kCartesianAngularAccelerationMax = 25.0;   // rad/s^2
+constexpr double kCartesianAngularJerkMax = 12500.0;        // rad/s^3
+
+// Thresholds random_points.cpp passes to Robot::setCollisionBehavior. An estimated external
+// torque (force) above the lower value is flagged as contact; above the upper value the
+// collision reflex stops the motion.
+constexpr std::array<double, kJoints> kJointContactTorque{{40.0, 40.0, 38.0, 38.0, 36.0, 34.0, 32.0}};    // Nm
+constexpr std::array<double, kJoints> kJointCollisionTorque{{45.0, 45.0, 43.0, 43.0, 41.0, 39.0, 37.0}};  // Nm
+constexpr std::array<double, 6> kCartesianContactForce{{40.0, 40.0, 38.0, 38.0, 36.0, 34.0}};    // N, Nm
+constexpr std::array<double, 6> kCartesianCollisionForce{{45.0, 45.0, 43.0, 43.0, 41.0, 39.0}};  // N, Nm
+
+// Typical end-of-move settle time, for cycle-time estimates that do not simulate the settle
+// detection of random_points.cpp (SettleOptions in joint_motion.h)
+constexpr double kSettleTime = 0.1;
+
+}  // namespace panda
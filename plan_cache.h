@@ -0,0 +1,169 @@
+// Segment plan cache for repeated dance cycles. A plan is the safe duration plus the joint
+// path sampled every control tick (1 ms). Plans are keyed by the quantized (q_target, desired
+// duration, time scaling, velocity scale) and reused when the measured start is within tolerance of a cached plan's start
+// (a key can hold several starts, e.g. A->B and C->B), so the planner (getSafeMovementTime
+// today, anything expensive later) only runs in the first cycle. Bounded with LRU eviction.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include <franka/control_types.h>
+#include <franka/duration.h>
+#include <franka/robot_state.h>
+#include "time_scaling.h"
+#include "trajectory_core.h"
+
+// A planned, sampled joint-space segment of the arm
+using SegmentPlan = trajectory::SegmentPlan<panda::kJoints>;
+using trajectory::samplePlan;
+
+// Control callback playing back a cached plan from the measured start q_start. The offset to
+// the planned start is blended out along the path parameter, which for a straight-line plan
+// gives the same path as replanning from q_start.
+class SampledJointMotion {
+public:
+    SampledJointMotion(const SegmentPlan& plan, const trajectory::ArmVector& q_start) : plan_(plan) {
+        for (size_t i = 0; i < panda::kJoints; i++) offset_[i] = q_start[i] - plan.q_start[i];
+    }
+
+    franka::JointPositions operator()(const franka::RobotState& /*state*/, franka::Duration period) {
+        ticks_ += period.toMSec();
+        size_t k = std::min<size_t>(ticks_, plan_.samples.size() - 1);
+        const trajectory::ArmVector& sample = plan_.samples[k];
+        double remaining = 1.0 - plan_.progress[k];
+        trajectory::ArmVector q_desired{};
+        for (size_t i = 0; i < panda::kJoints; i++) {
+            q_desired[i] = sample[i] + remaining * offset_[i];
+        }
+        if (ticks_ >= plan_.samples.size() - 1) {
+            return franka::MotionFinished(franka::JointPositions(q_desired));
+        }
+        return franka::JointPositions(q_desired);
+    }
+
+    double elapsed() const { return ticks_ / 1000.0; }
+
+private:
+    const SegmentPlan& plan_;
+    trajectory::ArmVector offset_{};
+    uint64_t ticks_ = 0;
+};
+
+class PlanCache {
+public:
+    using Planner = std::function<std::shared_ptr<SegmentPlan>(const trajectory::ArmVector& q_start,
+                                                               const trajectory::ArmVector& q_target,
+                                                               double desired_duration,
+                                                               const MoveTiming& timing)>;
+
+    struct Counters {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        double plan_seconds = 0.0;    // Total time spent in the planner (misses)
+        double lookup_seconds = 0.0;  // Total time spent on hits
+    };
+
+    // start_tolerance: max |measured - planned| start per joint (rad) for a plan to be reused
+    explicit PlanCache(size_t capacity = 64, double start_tolerance = 1e-3)
+        : capacity_(std::max<size_t>(capacity, 1)), start_tolerance_(start_tolerance) {}
+
+    // Returns the cached plan for this segment, or runs planner and caches its result
+    std::shared_ptr<const SegmentPlan> getOrPlan(const trajectory::ArmVector& q_start,
+                                                 const trajectory::ArmVector& q_target,
+                                                 double desired_duration, const MoveTiming& timing,
+                                                 const Planner& planner) {
+        auto start = std::chrono::steady_clock::now();
+        Key key = makeKey(q_target, desired_duration, timing);
+        std::vector<std::list<Entry>::iterator>& bucket = index_[key];
+        for (auto entry : bucket) {
+            if (withinTolerance(*entry->plan, q_start)) {
+                lru_.splice(lru_.begin(), lru_, entry);
+                counters_.hits++;
+                counters_.lookup_seconds += secondsSince(start);
+                return entry->plan;
+            }
+        }
+
+        std::shared_ptr<const SegmentPlan> plan = planner(q_start, q_target, desired_duration, timing);
+        counters_.misses++;
+        counters_.plan_seconds += secondsSince(start);
+        if (lru_.size() >= capacity_) {
+            evictOldest();
+        }
+        lru_.push_front({key, plan});
+        index_[key].push_back(lru_.begin());
+        return plan;
+    }
+
+    void clear() {
+        lru_.clear();
+        index_.clear();
+    }
+
+    size_t size() const { return lru_.size(); }
+    const Counters& counters() const { return counters_; }
+
+private:
+    // q_target, desired duration and velocity scale quantized to 1e-6, and the time scaling
+    using Key = std::array<int64_t, panda::kJoints + 3>;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            uint64_t h = 1469598103934665603ull;  // FNV-1a over the quantized values
+            for (int64_t v : key) {
+                h ^= static_cast<uint64_t>(v);
+                h *= 1099511628211ull;
+            }
+            return static_cast<size_t>(h);
+        }
+    };
+
+    struct Entry {
+        Key key;
+        std::shared_ptr<const SegmentPlan> plan;
+    };
+
+    Key makeKey(const trajectory::ArmVector& q_target, double desired_duration, const MoveTiming& timing) const {
+        Key key{};
+        for (size_t i = 0; i < panda::kJoints; i++) {
+            key[i] = std::llround(q_target[i] * 1e6);
+        }
+        key[panda::kJoints] = std::llround(desired_duration * 1e6);
+        key[panda::kJoints + 1] = std::llround(timing.velocity_scale * 1e6);
+        key[panda::kJoints + 2] = static_cast<int64_t>(timing.scaling);
+        return key;
+    }
+
+    void evictOldest() {
+        auto oldest = std::prev(lru_.end());
+        auto bucket = index_.find(oldest->key);
+        bucket->second.erase(std::find(bucket->second.begin(), bucket->second.end(), oldest));
+        if (bucket->second.empty()) index_.erase(bucket);
+        lru_.erase(oldest);
+        counters_.evictions++;
+    }
+
+    bool withinTolerance(const SegmentPlan& plan, const trajectory::ArmVector& q_start) const {
+        return trajectory::maxAbsDifference(q_start, plan.q_start) <= start_tolerance_;
+    }
+
+    static double secondsSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    size_t capacity_;
+    double start_tolerance_;
+    std::list<Entry> lru_;
+    std::unordered_map<Key, std::vector<std::list<Entry>::iterator>, KeyHash> index_;
+    Counters counters_;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include "so3.h"
+
+// Turns sparse, timestamped pose targets (ARKit rate, ~60 Hz) into a smooth reference that
+// can be sampled at any rate (1 kHz next to the robot).
+// Position: non-uniform Catmull-Rom, i.e. cubic Hermite segments with finite-difference tangents.
+// Orientation: cubic Hermite in the tangent space of each segment's start orientation.
+// Both are C1 and pass exactly through every sample. Past the newest sample the pose is
+// extrapolated with the last velocity for at most max_extrapolation seconds (and at most
+// max_extrapolation_distance meters), then held. All storage is fixed-size; nothing allocates.
+class PoseInterpolator {
+public:
+    static constexpr std::size_t kCapacity = 16;
+    // Samples closer together than this are treated as duplicates
+    static constexpr double kMinSampleSpacing = 1e-4;
+
+    enum Status { kEmpty = -1, kInterpolated = 0, kExtrapolated = 1, kHeld = 2 };
+
+    explicit PoseInterpolator(double max_extrapolation = 0.05, double max_extrapolation_distance = 0.05)
+        : max_extrapolation_(max_extrapolation), max_extrapolation_distance_(max_extrapolation_distance) {}
+
+    void reset() { count_ = 0; }
+
+    std::size_t size() const { return count_; }
+
+    // Add a sample. Returns false (and ignores it) if it is not newer than the newest sample.
+    bool push(double t, const so3::Vec3& p, const so3::Quat& q) {
+        if (count_ > 0 && t - at(count_ - 1).t < kMinSampleSpacing) {
+            return false;
+        }
+        head_ = (head_ + 1) % kCapacity;
+        Sample& s = samples_[head_];
+        s.t = t;
+        s.p = p;
+        s.q = so3::quatNormalize(q);
+        // Keep consecutive quaternions in the same hemisphere
+        if (count_ > 0) {
+            const so3::Quat& prev = at(count_ - 1).q;
+            if (prev[0] * s.q[0] + prev[1] * s.q[1] + prev[2] * s.q[2] + prev[3] * s.q[3] < 0.0) {
+                s.q = {-s.q[0], -s.q[1], -s.q[2], -s.q[3]};
+            }
+        }
+        if (count_ < kCapacity) {
+            ++count_;
+        }
+        return true;
+    }
+
+    Status sample(double t, so3::Vec3& p, so3::Quat& q) const {
+        if (count_ == 0) {
+            return kEmpty;
+        }
+        const Sample& newest = at(count_ - 1);
+        if (count_ == 1) {
+            p = newest.p;
+            q = newest.q;
+            return t > newest.t ? kHeld : kInterpolated;
+        }
+        if (t <= at(0).t) {
+            p = at(0).p;
+            q = at(0).q;
+            return kInterpolated;
+        }
+        if (t >= newest.t) {
+            return extrapolate(t, p, q);
+        }
+
+        // Find segment [i, i+1] containing t, searching from the newest end (the usual case)
+        std::size_t i = count_ - 2;
+        while (i > 0 && at(i).t > t) {
+            --i;
+        }
+        const Sample& s0 = at(i);
+        const Sample& s1 = at(i + 1);
+        double dt = s1.t - s0.t;
+        double u = (t - s0.t) / dt;
+
+        // Cubic Hermite basis
+        double u2 = u * u, u3 = u2 * u;
+        double h00 = 2 * u3 - 3 * u2 + 1;
+        double h10 = u3 - 2 * u2 + u;
+        double h01 = -2 * u3 + 3 * u2;
+        double h11 = u3 - u2;
+
+        so3::Vec3 v0 = linearVelocity(i), v1 = linearVelocity(i + 1);
+        for (std::size_t k = 0; k < 3; k++) {
+            p[k] = h00 * s0.p[k] + h10 * dt * v0[k] + h01 * s1.p[k] + h11 * dt * v1[k];
+        }
+
+        // Orientation: Hermite curve from 0 to log(q0^-1 q1) in q0's tangent space
+        so3::Vec3 r = so3::boxMinus(s1.q, s0.q);
+        so3::Vec3 w0 = angularVelocity(i), w1 = angularVelocity(i + 1);
+        so3::Vec3 h;
+        for (std::size_t k = 0; k < 3; k++) {
+            h[k] = h10 * dt * w0[k] + h01 * r[k] + h11 * dt * w1[k];
+        }
+        q = so3::boxPlus(s0.q, h);
+        return kInterpolated;
+    }
+
+private:
+    struct Sample {
+        double t = 0.0;
+        so3::Vec3 p{};
+        so3::Quat q{0.0, 0.0, 0.0, 1.0};
+    };
+
+    // i = 0 is the oldest stored sample, i = count_ - 1 the newest
+    const Sample& at(std::size_t i) const {
+        return samples_[(head_ + kCapacity - (count_ - 1) + i) % kCapacity];
+    }
+
+    // Finite-difference tangents: central inside the window, one-sided at its ends
+    so3::Vec3 linearVelocity(std::size_t i) const {
+        std::size_t a = i > 0 ? i - 1 : i;
+        std::size_t b = i + 1 < count_ ? i + 1 : i;
+        const Sample& sa = at(a);
+        const Sample& sb = at(b);
+        double dt = sb.t - sa.t;
+        return {(sb.p[0] - sa.p[0]) / dt, (sb.p[1] - sa.p[1]) / dt, (sb.p[2] - sa.p[2]) / dt};
+    }
+
+    // Body-frame angular velocity estimate around sample i
+    so3::Vec3 angularVelocity(std::size_t i) const {
+        std::size_t a = i > 0 ? i - 1 : i;
+        std::size_t b = i + 1 < count_ ? i + 1 : i;
+        const Sample& sa = at(a);
+        const Sample& sb = at(b);
+        double dt = sb.t - sa.t;
+        so3::Vec3 d = so3::boxMinus(sb.q, sa.q);
+        return {d[0] / dt, d[1] / dt, d[2] / dt};
+    }
+
+    Status extrapolate(double t, so3::Vec3& p, so3::Quat& q) const {
+        const Sample& newest = at(count_ - 1);
+        double ahead = t - newest.t;
+        Status status = kExtrapolated;
+        if (ahead > max_extrapolation_) {
+            ahead = max_extrapolation_;
+            status = kHeld;
+        }
+
+        so3::Vec3 v = linearVelocity(count_ - 1);
+        so3::Vec3 dp = {v[0] * ahead, v[1] * ahead, v[2] * ahead};
+        double dist = std::sqrt(dp[0] * dp[0] + dp[1] * dp[1] + dp[2] * dp[2]);
+        double scale = dist > max_extrapolation_distance_ ? max_extrapolation_distance_ / dist : 1.0;
+        for (std::size_t k = 0; k < 3; k++) {
+            p[k] = newest.p[k] + dp[k] * scale;
+        }
+
+        so3::Vec3 w = angularVelocity(count_ - 1);
+        q = so3::boxPlus(newest.q, {w[0] * ahead, w[1] * ahead, w[2] * ahead});
+        return status;
+    }
+
+    std::array<Sample, kCapacity> samples_{};
+    std::size_t head_ = kCapacity - 1;
+    std::size_t count_ = 0;
+    double max_extrapolation_;
+    double max_extrapolation_distance_;
+};
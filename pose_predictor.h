@@ -0,0 +1,139 @@
+#pragma once
+
+#include <cmath>
+#include "so3.h"
+
+// Forward predictor for the phone pose, used to compensate the pipeline latency between
+// the ARKit sample and the robot acting on it.
+// Position: alpha-beta-gamma filter (constant acceleration model) per axis.
+// Orientation: the same filter on SO(3): orientation, body angular velocity and angular
+// acceleration, with residuals taken in the tangent space (q_meas [-] q_pred).
+// With gamma = 0 this degenerates to a constant-velocity alpha-beta filter.
+class PosePredictor {
+public:
+    PosePredictor(double alpha, double beta, double gamma, double max_lead)
+        : alpha_(alpha), beta_(beta), gamma_(gamma), max_lead_(max_lead) {}
+
+    void reset() { count_ = 0; }
+
+    // Standard steady-state gains for a given alpha (Kalata / Gray & Murray relations)
+    static void gainsFromAlpha(double alpha, double& beta, double& gamma) {
+        beta = 2.0 * (2.0 - alpha) - 4.0 * std::sqrt(1.0 - alpha);
+        gamma = beta * beta / (2.0 * alpha);
+    }
+
+    // Feed a measurement. Returns false if t is not newer than the previous measurement.
+    bool update(double t, const so3::Vec3& p, const so3::Quat& q) {
+        if (count_ > 0 && t <= t_) {
+            return false;
+        }
+        if (count_ == 0) {
+            p_ = p;
+            q_ = so3::quatNormalize(q);
+            v_ = {0.0, 0.0, 0.0};
+            a_ = {0.0, 0.0, 0.0};
+            w_ = {0.0, 0.0, 0.0};
+            dw_ = {0.0, 0.0, 0.0};
+        } else if (count_ == 1) {
+            // Second sample: initialize velocities by finite difference
+            double dt = t - t_;
+            so3::Quat qn = so3::quatNormalize(q);
+            so3::Vec3 d = so3::boxMinus(qn, q_);
+            for (int k = 0; k < 3; k++) {
+                v_[k] = (p[k] - p_[k]) / dt;
+                w_[k] = d[k] / dt;
+            }
+            p_ = p;
+            q_ = qn;
+        } else {
+            double dt = t - t_;
+            double k_beta = beta_ / dt;
+            double k_gamma = 2.0 * gamma_ / (dt * dt);
+
+            so3::Vec3 p_pred, q_step;
+            for (int k = 0; k < 3; k++) {
+                p_pred[k] = p_[k] + v_[k] * dt + 0.5 * a_[k] * dt * dt;
+                q_step[k] = w_[k] * dt + 0.5 * dw_[k] * dt * dt;
+            }
+            so3::Quat q_pred = so3::boxPlus(q_, q_step);
+            so3::Vec3 r_rot = so3::boxMinus(so3::quatNormalize(q), q_pred);
+
+            so3::Vec3 q_corr;
+            for (int k = 0; k < 3; k++) {
+                double r = p[k] - p_pred[k];
+                p_[k] = p_pred[k] + alpha_ * r;
+                v_[k] += a_[k] * dt + k_beta * r;
+                a_[k] += k_gamma * r;
+
+                q_corr[k] = alpha_ * r_rot[k];
+                w_[k] += dw_[k] * dt + k_beta * r_rot[k];
+                dw_[k] += k_gamma * r_rot[k];
+            }
+            q_ = so3::boxPlus(q_pred, q_corr);
+        }
+        t_ = t;
+        if (count_ < 2) {
+            ++count_;
+        }
+        return true;
+    }
+
+    // Predicted pose at absolute time t (lead over the last measurement is clamped to max_lead).
+    // Returns false before the first measurement.
+    bool predict(double t, so3::Vec3& p, so3::Quat& q) const {
+        if (count_ == 0) {
+            return false;
+        }
+        double lead = t - t_;
+        lead = lead < 0.0 ? 0.0 : (lead > max_lead_ ? max_lead_ : lead);
+        double half_lead2 = 0.5 * lead * lead;
+        so3::Vec3 q_step;
+        for (int k = 0; k < 3; k++) {
+            p[k] = p_[k] + v_[k] * lead + a_[k] * half_lead2;
+            q_step[k] = w_[k] * lead + dw_[k] * half_lead2;
+        }
+        q = so3::boxPlus(q_, q_step);
+        return true;
+    }
+
+    double lastUpdateTime() const { return t_; }
+
+private:
+    double alpha_, beta_, gamma_, max_lead_;
+    int count_ = 0;
+    double t_ = 0.0;
+    so3::Vec3 p_{}, v_{}, a_{};
+    so3::Quat q_{0.0, 0.0, 0.0, 1.0};
+    so3::Vec3 w_{}, dw_{};
+};
+
+// Online estimate of the sample-to-actuation latency from per-sample measurements:
+// exponentially weighted mean and mean absolute deviation (RFC 6298 style).
+class LatencyEstimator {
+public:
+    explicit LatencyEstimator(double smoothing = 0.05) : smoothing_(smoothing) {}
+
+    void reset() { count_ = 0; }
+
+    void add(double latency) {
+        if (count_ == 0) {
+            mean_ = latency;
+            deviation_ = 0.5 * latency;
+        } else {
+            double err = latency - mean_;
+            mean_ += smoothing_ * err;
+            deviation_ += smoothing_ * (std::abs(err) - deviation_);
+        }
+        ++count_;
+    }
+
+    double mean() const { return mean_; }
+    double deviation() const { return deviation_; }
+    long count() const { return count_; }
+
+private:
+    double smoothing_;
+    long count_ = 0;
+    double mean_ = 0.0;
+    double deviation_ = 0.0;
+};
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+Demonstrates that the one-way pose stream decouples the teleop loop rate from
+server latency. A simulated slow server (sleeping in place of the Polymetis
+call) is driven by a 200 Hz loop twice: once with a blocking request/response
+round trip per target (what a zerorpc call does) and once fire-and-forget.
+"""
+
+import argparse
+import multiprocessing as mp
+import time
+import numpy as np
+import zmq
+from streaming import PoseSink, PoseSender
+
+RPC_ENDPOINT = "tcp://127.0.0.1:{port}"
+
+
+def slow_apply(latency):
+    def apply_pose(pose, stamp=None, seq=None):
+        time.sleep(latency)  # Stand-in for a blocking Polymetis update_desired_ee_pose
+    return apply_pose
+
+
+def run_blocking_server(port, latency, stop_event):
+    """Request/response server: replies only after the (slow) apply finishes."""
+    context = zmq.Context()
+    socket = context.socket(zmq.REP)
+    socket.bind(RPC_ENDPOINT.format(port=port))
+    apply_pose = slow_apply(latency)
+    while not stop_event.is_set():
+        if socket.poll(100):
+            socket.recv()
+            apply_pose(None)
+            socket.send(b"ok")
+    socket.close()
+
+
+def run_oneway_server(port, ack_port, latency, stop_event, results):
+    sink = PoseSink(slow_apply(latency), RPC_ENDPOINT.format(port=port),
+                    ack_endpoint=RPC_ENDPOINT.format(port=ack_port), ack_interval=0.1,
+                    context=zmq.Context())
+    sink.start()
+    stop_event.wait()
+    sink.stop()
+    results.put((sink.applied, sink.coalesced, sink.stale))
+
+
+def control_loop(send, frequency, duration):
+    """Fixed-rate loop like mujocoar_teleop.py; returns the measured loop periods in ms."""
+    period = 1.0 / frequency
+    periods = []
+    pose = np.zeros(6)
+    next_deadline = time.perf_counter()
+    last = next_deadline
+    end = last + duration
+    while last < end:
+        pose[2] = 0.5 + 0.1 * np.sin(last)
+        send(pose)
+        next_deadline += period
+        delay = next_deadline - time.perf_counter()
+        if delay > 0:
+            time.sleep(delay)
+        now = time.perf_counter()
+        periods.append((now - last) * 1000)
+        last = now
+    return np.array(periods)
+
+
+def report(name, periods, frequency):
+    rate = 1000.0 / periods.mean()
+    print(f"{name:>10} | {rate:>8.1f} Hz | mean {periods.mean():6.2f} ms | "
+          f"p99 {np.percentile(periods, 99):6.2f} ms | target {frequency} Hz")
+
+
+def main():
+    parser = argparse.ArgumentParser(description='One-way pose stream vs blocking RPC under a slow server')
+    parser.add_argument('--frequency', type=int, default=200, help='Control loop rate in Hz (default: 200)')
+    parser.add_argument('--server-latency', type=float, default=15.0,
+                        help='Simulated server apply time in ms (default: 15)')
+    parser.add_argument('--duration', type=float, default=3.0, help='Seconds per mode (default: 3)')
+    parser.add_argument('--port', type=int, default=5244)
+    args = parser.parse_args()
+    latency = args.server_latency / 1000.0
+
+    print(f"Simulated server latency: {args.server_latency:.1f} ms")
+    print("=" * 80)
+
+    # Blocking request/response
+    stop_event = mp.Event()
+    server = mp.Process(target=run_blocking_server, args=(args.port, latency, stop_event))
+    server.start()
+    context = zmq.Context()
+    socket = context.socket(zmq.REQ)
+    socket.connect(RPC_ENDPOINT.format(port=args.port))
+
+    def blocking_send(pose):
+        socket.send(pose.tobytes())
+        socket.recv()
+
+    report("blocking", control_loop(blocking_send, args.frequency, args.duration), args.frequency)
+    socket.close()
+    stop_event.set()
+    server.join()
+
+    # One-way pose stream
+    stop_event = mp.Event()
+    results = mp.Queue()
+    server = mp.Process(target=run_oneway_server,
+                        args=(args.port + 1, args.port + 2, latency, stop_event, results))
+    server.start()
+    sender = PoseSender(RPC_ENDPOINT.format(port=args.port + 1),
+                        RPC_ENDPOINT.format(port=args.port + 2), context=context)
+    time.sleep(0.2)
+
+    report("one-way", control_loop(sender.send, args.frequency, args.duration), args.frequency)
+    ack = sender.ack(timeout=0.5)
+    sender.close()
+    stop_event.set()
+    applied, coalesced, stale = results.get()
+    server.join()
+
+    print("-" * 80)
+    print(f"One-way server: {applied} targets applied, {coalesced} coalesced (latest wins), {stale} stale; "
+          f"sent {sender.seq}")
+    if ack is not None:
+        print(f"Last ack: applied seq {ack['last_applied_seq']} of {sender.seq}")
+    print("=" * 80)
+
+
+if __name__ == "__main__":
+    main()
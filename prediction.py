@@ -0,0 +1,40 @@
+"""
+Latency compensation for AR teleop targets.
+
+Every target carries the time its phone pose was sampled. The server measures how
+old each target is when it reaches the robot, keeps an online estimate of that
+latency, and forward-predicts incoming targets by it so the robot tracks where the
+phone is now rather than where it was. Latency is measured from timestamps, so
+client and server clocks must agree (same host, or chrony/PTP synchronized).
+"""
+
+import numpy as np
+from scipy.spatial.transform import Rotation as R
+from franka_ar_native import PosePredictor, LatencyEstimator
+
+
+class LatencyCompensator:
+    def __init__(self, alpha=0.5, max_lead=0.15, extra_latency=0.0, smoothing=0.05):
+        # extra_latency covers stages that cannot be timestamped (ARKit capture, robot controller)
+        self.predictor = PosePredictor(alpha, max_lead=max_lead)
+        self.latency = LatencyEstimator(smoothing)
+        self.extra_latency = extra_latency
+        self.predicted = np.zeros(6)
+
+    def lead(self):
+        """Current prediction horizon in seconds."""
+        mean, _, count = self.latency.get()
+        return (mean if count > 0 else 0.0) + self.extra_latency
+
+    def compensate(self, pose, stamp):
+        """Feed a target [x, y, z, rx, ry, rz] sampled at `stamp`; returns the predicted target."""
+        if not self.predictor.update(stamp, pose[:3], R.from_rotvec(pose[3:]).as_quat()):
+            return pose  # Out-of-order sample; pass through unchanged
+        predicted = self.predictor.predict(stamp + self.lead())
+        self.predicted[:3] = predicted[:3]
+        self.predicted[3:] = R.from_quat(predicted[3:]).as_rotvec()
+        return self.predicted
+
+    def observe(self, latency):
+        """Record a measured sample-to-actuation latency (seconds)."""
+        self.latency.add(latency)
@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+"""
+Offline evaluation harness for the latency-compensating pose predictor.
+
+Record an AR stream from the phone:
+    python predictor_eval.py record --output ar_stream.npz --duration 60
+Replay it and report prediction error against lead time:
+    python predictor_eval.py eval --input ar_stream.npz
+Without --input a synthetic hand-like stream is used.
+"""
+
+import argparse
+import time
+import numpy as np
+from scipy.spatial.transform import Rotation as R, Slerp
+import config
+from franka_ar_native import PosePredictor
+
+
+def record_stream(output, duration):
+    """Record every new AR sample with its arrival time."""
+    from mujoco_ar import MujocoARConnector
+    connector = MujocoARConnector(port=config.AR_CONNECTOR_PORT, debug=config.AR_DEBUG)
+    connector.start()
+    print("Waiting for AR data...")
+    while connector.get_latest_data()["position"] is None:
+        time.sleep(0.01)
+
+    stamps, positions, quats = [], [], []
+    last_position = None
+    end = time.time() + duration
+    print(f"Recording for {duration:.0f} seconds...")
+    while time.time() < end:
+        data = connector.get_latest_data()
+        if last_position is None or not np.array_equal(data["position"], last_position):
+            last_position = np.array(data["position"])
+            stamps.append(time.time())
+            positions.append(last_position)
+            quats.append(R.from_matrix(data["rotation"]).as_quat())
+        time.sleep(0.0005)
+
+    np.savez(output, t=np.array(stamps), position=np.array(positions), quat=np.array(quats))
+    print(f"Saved {len(stamps)} samples ({len(stamps) / duration:.1f} Hz) to {output}")
+
+
+def synthetic_stream(duration=30.0, rate=60.0, noise=0.0005, seed=0):
+    rng = np.random.default_rng(seed)
+    t = np.arange(0.0, duration, 1.0 / rate) + rng.uniform(-0.002, 0.002, int(duration * rate))
+    t.sort()
+    # Piecewise reaching motions with smooth sinusoidal wobble
+    pos = np.stack([0.05 * np.sin(1.3 * t), 0.15 * np.sin(0.7 * t) * np.sin(0.23 * t),
+                    0.1 * np.sin(1.9 * t + 0.5)], axis=-1) + rng.normal(0, noise, (len(t), 3))
+    rot = np.stack([0.4 * np.sin(0.8 * t), 0.3 * np.sin(1.2 * t + 1.0), 0.3 * np.sin(0.5 * t)], axis=-1)
+    return t, pos, R.from_rotvec(rot).as_quat()
+
+
+def evaluate(t, pos, quat, leads, methods):
+    """For each method and lead, predict every sample forward and compare to the recorded future."""
+    slerp = Slerp(t, R.from_quat(quat))
+    results = {}
+    for name, alpha, gamma_zero in methods:
+        for lead in leads:
+            if name == 'hold':
+                query = t + lead
+                valid = query <= t[-1]
+                pred_pos = pos[valid]
+                pred_rot = R.from_quat(quat[valid])
+            else:
+                predictor = PosePredictor(alpha, gamma=0.0 if gamma_zero else None, max_lead=max(leads))
+                query = t + lead
+                valid = query <= t[-1]
+                pred_pos = np.zeros((valid.sum(), 3))
+                pred_q = np.zeros((valid.sum(), 4))
+                k = 0
+                for i in range(len(t)):
+                    predictor.update(t[i], pos[i], quat[i])
+                    if valid[i]:
+                        p = predictor.predict(query[i])
+                        pred_pos[k] = p[:3]
+                        pred_q[k] = p[3:]
+                        k += 1
+                pred_rot = R.from_quat(pred_q)
+
+            q_valid = query[valid]
+            true_pos = np.stack([np.interp(q_valid, t, pos[:, j]) for j in range(3)], axis=-1)
+            true_rot = slerp(q_valid)
+            pos_err = np.linalg.norm(pred_pos - true_pos, axis=1) * 1000
+            rot_err = np.degrees((pred_rot * true_rot.inv()).magnitude())
+            results[(name, lead)] = (pos_err.mean(), np.percentile(pos_err, 95),
+                                     rot_err.mean(), np.percentile(rot_err, 95))
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Pose predictor evaluation harness')
+    sub = parser.add_subparsers(dest='command')
+    rec = sub.add_parser('record', help='Record an AR stream from the phone')
+    rec.add_argument('--output', default='ar_stream.npz')
+    rec.add_argument('--duration', type=float, default=60.0)
+    ev = sub.add_parser('eval', help='Replay a stream and report error vs lead time')
+    ev.add_argument('--input', help='Recorded .npz (default: synthetic stream)')
+    ev.add_argument('--alpha', type=float, default=config.PREDICTOR_ALPHA)
+    ev.add_argument('--leads', type=float, nargs='+', default=[0, 10, 20, 40, 60, 80, 100, 150],
+                    help='Lead times in ms')
+    args = parser.parse_args()
+
+    if args.command == 'record':
+        record_stream(args.output, args.duration)
+        return
+
+    if args.command is None:
+        args = ev.parse_args([])
+    if args.input:
+        data = np.load(args.input)
+        t, pos, quat = data['t'], data['position'], data['quat']
+        source = args.input
+    else:
+        t, pos, quat = synthetic_stream()
+        source = 'synthetic stream'
+
+    leads = [lead / 1000.0 for lead in args.leads]
+    methods = [('hold', None, False), ('abg-cv', args.alpha, True), ('abg-ca', args.alpha, False)]
+    results = evaluate(t, pos, quat, leads, methods)
+
+    print(f"Prediction error vs lead time on {source} ({len(t)} samples, "
+          f"{len(t) / (t[-1] - t[0]):.1f} Hz, alpha={args.alpha})")
+    print("=" * 84)
+    print(f"{'lead ms':>7} | " + " | ".join(f"{name:>22}" for name, _, _ in methods))
+    print(f"{'':>7} | " + " | ".join(f"{'mm mean/p95  deg mean':>22}" for _ in methods))
+    print("-" * 84)
+    for lead in leads:
+        cells = []
+        for name, _, _ in methods:
+            pos_mean, pos_p95, rot_mean, _ = results[(name, lead)]
+            cells.append(f"{pos_mean:6.2f}/{pos_p95:6.2f}  {rot_mean:6.2f}")
+        print(f"{lead * 1000:>7.0f} | " + " | ".join(f"{c:>22}" for c in cells))
+    print("=" * 84)
+
+
+if __name__ == "__main__":
+    main()
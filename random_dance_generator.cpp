@@ -0,0 +1,231 @@
+// Random dance generator for data collection: samples joint configurations uniformly inside the
+// joint limits and rejects those whose hand leaves the teleop workspace (the MIN/MAX_Y/Z_HEIGHT
+// bounds in config.py), whose links collide (capsule model in panda_kinematics.h) or whose
+// manipulability is below a threshold. The accepted configurations are written as a ready-to-run
+// dance file with minimum feasible move times, optionally reordered for the shortest cycle.
+//
+// Sampling runs in parallel in fixed-size blocks; each block has its own RNG seeded from
+// (seed, block index) and the output is assembled in block order, so a seed always produces the
+// same dance regardless of the thread count.
+//
+// Usage: ./random_dance_generator COUNT [-o dance.cfg] [--seed S] [-j THREADS]
+//            [--min-manipulability M] [--clearance METERS] [--speed FRACTION] [--reorder]
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dance_optimizer.h"
+#include "panda_kinematics.h"
+#include "panda_limits.h"
+#include "waypoint_order.h"
+
+namespace {
+
+// Hand workspace in the base frame (MIN/MAX_Y_HEIGHT and MIN/MAX_Z_HEIGHT in config.py)
+constexpr double kMinY = -0.5;
+constexpr double kMaxY = 0.38;
+constexpr double kMinZ = 0.3;
+constexpr double kMaxZ = 0.9;
+
+constexpr size_t kBlockSize = 4096;  // Samples per RNG block
+constexpr uint64_t kGiveUpBlocks = 64;  // Stop if this many blocks accepted nothing
+constexpr double kFirstMoveTime = 3.0;  // The first move also starts from wherever the robot is
+
+struct Options {
+    size_t count = 0;
+    std::string output = "random_dance.cfg";
+    uint64_t seed = 1;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    double min_manipulability = 0.03;
+    double clearance = 0.02;      // Extra distance required between link capsules (m)
+    double limit_margin = 0.05;   // Distance kept from the joint position limits (rad)
+    double speed = 0.5;           // Fraction of the vel/acc/jerk limits used for the move times
+    bool reorder = false;
+};
+
+// Rejection counts by the first filter a sample failed
+struct Counters {
+    uint64_t samples = 0;
+    uint64_t workspace = 0;
+    uint64_t collision = 0;
+    uint64_t manipulability = 0;
+
+    void add(const Counters& other) {
+        samples += other.samples;
+        workspace += other.workspace;
+        collision += other.collision;
+        manipulability += other.manipulability;
+    }
+};
+
+// Samples one block; appends accepted configurations in sampling order
+void sampleBlock(const Options& options, uint64_t block, std::vector<std::array<double, 7>>& accepted,
+                 Counters& counters) {
+    std::seed_seq seed{options.seed, block};
+    std::mt19937_64 rng(seed);
+    std::array<std::uniform_real_distribution<double>, 7> joint;
+    for (size_t i = 0; i < 7; i++) {
+        joint[i] = std::uniform_real_distribution<double>(panda::kJointPositionMin[i] + options.limit_margin,
+                                                          panda::kJointPositionMax[i] - options.limit_margin);
+    }
+    for (size_t k = 0; k < kBlockSize; k++) {
+        std::array<double, 7> q;
+        for (size_t i = 0; i < 7; i++) q[i] = joint[i](rng);
+        counters.samples++;
+
+        // Cheapest filters first
+        panda::Kinematics kinematics = panda::forwardKinematics(q);
+        const panda::Vec3& tcp = kinematics.tcp();
+        if (tcp[1] < kMinY || tcp[1] > kMaxY || tcp[2] < kMinZ || tcp[2] > kMaxZ) {
+            counters.workspace++;
+            continue;
+        }
+        if (panda::selfCollision(kinematics, options.clearance)) {
+            counters.collision++;
+            continue;
+        }
+        if (panda::manipulability(panda::jacobian(kinematics)) < options.min_manipulability) {
+            counters.manipulability++;
+            continue;
+        }
+        accepted.push_back(q);
+    }
+}
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "-o" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--seed" && i + 1 < argc) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "-j" && i + 1 < argc) {
+            options.threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-manipulability" && i + 1 < argc) {
+            options.min_manipulability = std::stod(argv[++i]);
+        } else if (arg == "--clearance" && i + 1 < argc) {
+            options.clearance = std::stod(argv[++i]);
+        } else if (arg == "--speed" && i + 1 < argc) {
+            options.speed = std::stod(argv[++i]);
+        } else if (arg == "--reorder") {
+            options.reorder = true;
+        } else if (!arg.empty() && arg[0] != '-' && options.count == 0) {
+            options.count = std::strtoul(arg.c_str(), nullptr, 10);
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return options.count > 0 && options.speed > 0.0 && options.speed <= 1.0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " COUNT [-o dance.cfg] [--seed S] [-j THREADS]\n"
+                  << "           [--min-manipulability M] [--clearance METERS] [--speed FRACTION] [--reorder]"
+                  << std::endl;
+        return 2;
+    }
+
+    // Threads claim blocks until the finished blocks hold enough accepted samples
+    std::vector<std::vector<std::array<double, 7>>> blocks;
+    std::vector<Counters> block_counters;
+    std::mutex mutex;
+    std::atomic<uint64_t> next_block{0};
+    std::atomic<size_t> accepted_total{0};
+    auto start = std::chrono::steady_clock::now();
+    auto worker = [&] {
+        while (accepted_total < options.count) {
+            uint64_t block = next_block.fetch_add(1);
+            if (block >= kGiveUpBlocks && accepted_total == 0) break;
+            std::vector<std::array<double, 7>> accepted;
+            Counters counters;
+            sampleBlock(options, block, accepted, counters);
+            accepted_total += accepted.size();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (blocks.size() <= block) {
+                blocks.resize(block + 1);
+                block_counters.resize(block + 1);
+            }
+            blocks[block] = std::move(accepted);
+            block_counters[block] = counters;
+        }
+    };
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < options.threads; t++) threads.emplace_back(worker);
+    for (std::thread& thread : threads) thread.join();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Every claimed block finished, so the blocks form a prefix; take the first COUNT samples
+    std::vector<std::array<double, 7>> points;
+    Counters total;
+    for (size_t b = 0; b < blocks.size(); b++) {
+        total.add(block_counters[b]);
+        for (const std::array<double, 7>& q : blocks[b]) {
+            if (points.size() < options.count) points.push_back(q);
+        }
+    }
+    uint64_t accepted = total.samples - total.workspace - total.collision - total.manipulability;
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Sampled " << total.samples << " configurations in " << seconds * 1000.0 << " ms on "
+              << options.threads << " threads: " << accepted << " accepted ("
+              << 100.0 * accepted / total.samples << "%), rejected " << total.workspace << " workspace, "
+              << total.collision << " self-collision, " << total.manipulability << " manipulability" << std::endl;
+    std::cout << std::setprecision(0) << total.samples / seconds << " samples/s, " << accepted / seconds
+              << " accepted samples/s" << std::endl;
+
+    if (points.empty()) {
+        std::cerr << "No configuration passed the filters; relax --min-manipulability or --clearance" << std::endl;
+        return 1;
+    }
+
+    std::vector<int> order(points.size());
+    for (size_t k = 0; k < order.size(); k++) order[k] = static_cast<int>(k);
+    JointLimits limits = JointLimits::panda(options.speed);
+    if (options.reorder) {
+        TourOptions tour_options;
+        tour_options.threads = options.threads;
+        tour_options.seed = options.seed;
+        SegmentCostMatrix costs(points, limits, {}, options.threads);
+        TourResult tour = optimizeWaypointOrder(costs, tour_options);
+        order = tour.order;
+        std::cout << std::setprecision(2) << "Reordered in " << tour.seconds * 1000.0 << " ms: motion time "
+                  << tour.identity_cost << " s -> " << tour.cost << " s per cycle" << std::endl;
+    }
+
+    std::ofstream file(options.output);
+    file << "# Random dance: " << points.size() << " configurations, seed " << options.seed
+         << ", min manipulability " << options.min_manipulability << ", clearance " << options.clearance
+         << " m, move times at " << options.speed * 100.0 << "% of the joint limits"
+         << (options.reorder ? ", reordered" : "") << "\n";
+    file << "# Format: <index> <7 joint positions (rad)> <move time (s)>\n";
+    file << std::fixed << std::setprecision(4);
+    for (size_t k = 0; k < order.size(); k++) {
+        const std::array<double, 7>& q = points[order[k]];
+        const std::array<double, 7>& previous = points[order[(k + order.size() - 1) % order.size()]];
+        double move_time = minQuinticTime(previous, q, limits).duration;
+        if (k == 0) move_time = std::max(move_time, kFirstMoveTime);
+        file << k + 1;
+        for (double joint : q) file << " " << joint;
+        file << " " << std::setprecision(3) << move_time << std::setprecision(4) << "\n";
+    }
+    if (!file) {
+        std::cerr << "Failed to write " << options.output << std::endl;
+        return 1;
+    }
+    std::cout << "Wrote " << points.size() << " moves to " << options.output << std::endl;
+    return 0;
+}
@@ -0,0 +1,241 @@
+// Deterministic replay of the moveJoints control callback from a flight recording.
+// Every recorded tick (RobotState subset plus the franka::Duration it arrived with, including
+// jitter and missed ticks) is fed exactly as robot.control() would through the callback
+// moveJoints used for its segment: QuinticJointMotion in the move's time scaling, or
+// SampledJointMotion on the plan planJointSegment makes from the recorded plan start, timing and
+// velocity scale, retimed with retimeForTorque under the recorded budget when the runner retimed
+// it; both wrapped in SettlingMotion with the recorded settle options. The emitted JointPositions
+// are compared against a golden run bit-for-bit or within a tolerance. Also reports ns/tick for
+// the RT path. Cartesian segments are not replayed (their ticks are emitted as NaN).
+//
+// Record:  ./random_points <host> dance.cfg --record-dir rec   (or --simulate)
+// Golden:  ./replay_harness rec --write-golden golden.npy
+// Compare: ./replay_harness rec --golden golden.npy [--tolerance 1e-12] [--repeat 20]
+// Bit-for-bit comparison needs the golden run and the replay built with the same flags
+// (e.g. -march=native allows FMA contraction, which changes the last bit).
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "dance_config.h"
+#include "flight_recorder.h"
+#include "joint_motion.h"
+#include "torque_retiming.h"
+
+using namespace flight_recorder;
+
+namespace {
+
+// One emitted command: 7 joint positions plus the motion_finished flag
+constexpr std::size_t kOutputColumns = 8;
+
+struct Options {
+    std::string recording;
+    std::string golden;
+    std::string write_golden;
+    double tolerance = 0.0;
+    int repeat = 10;
+    bool with_recorder = false;
+};
+
+bool parseOptions(int argc, char** argv, Options& options) {
+    if (argc < 2) return false;
+    options.recording = argv[1];
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--golden" && i + 1 < argc) {
+            options.golden = argv[++i];
+        } else if (arg == "--write-golden" && i + 1 < argc) {
+            options.write_golden = argv[++i];
+        } else if (arg == "--tolerance" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.tolerance)) return false;
+        } else if (arg == "--repeat" && i + 1 < argc) {
+            if (!parseOptionValue(arg, argv[++i], options.repeat, 1)) return false;
+        } else if (arg == "--with-recorder") {
+            options.with_recorder = true;
+        } else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+MoveTiming segmentTiming(const SegmentRecord& meta) {
+    MoveTiming timing;
+    timing.scaling = static_cast<TimeScaling>(static_cast<int>(meta.scaling));
+    timing.velocity_scale = meta.velocity_scale;
+    return timing;
+}
+
+SettleOptions segmentSettle(const SegmentRecord& meta) {
+    SettleOptions settle;
+    settle.velocity = meta.settle[0];
+    settle.position = meta.settle[1];
+    settle.window = meta.settle[2];
+    settle.timeout = meta.settle[3];
+    return settle;
+}
+
+// The sampled plan of every kJointPlan segment, made as moveJoints' planner made it (with torque
+// retiming if the segment's budget is recorded); planned once, outside the timed replays
+std::vector<std::shared_ptr<const SegmentPlan>> planSegments(const std::vector<SegmentRecord>& segments) {
+    std::vector<std::shared_ptr<const SegmentPlan>> plans(segments.size());
+    for (std::size_t s = 0; s < segments.size(); s++) {
+        const SegmentRecord& meta = segments[s];
+        if (meta.motion != static_cast<double>(SegmentMotion::kJointPlan)) continue;
+        std::shared_ptr<SegmentPlan> plan =
+            planJointSegment(meta.plan_start, meta.q_target, meta.desired_duration, segmentTiming(meta));
+        if (!std::isnan(meta.torque_model_error)) {
+            TorqueBudget budget;
+            budget.model_error = meta.torque_model_error;
+            retimeForTorque(*plan, budget);
+        }
+        plans[s] = plan;
+    }
+    return plans;
+}
+
+// Feeds the ticks of one segment, from ticks[i] on, through motion; returns the index after them
+template <typename Motion>
+std::size_t replaySegment(const std::vector<TickRecord>& ticks, std::size_t i, Motion& motion,
+                          FlightRecorder* recorder, std::vector<double>& output) {
+    franka::RobotState state;
+    const int32_t segment = ticks[i].segment;
+    for (; i < ticks.size() && ticks[i].segment == segment; i++) {
+        const TickRecord& tick = ticks[i];
+        state.time = franka::Duration(static_cast<uint64_t>(std::llround(tick.t * 1000.0)));
+        state.q = tick.q;
+        state.q_d = tick.q_d;
+        state.dq = tick.dq;
+        state.tau_J = tick.tau_J;
+        state.control_command_success_rate = tick.success_rate;
+        franka::Duration period(tick.period_ms);
+        if (recorder != nullptr) recorder->record(state, period);
+        franka::JointPositions command = motion(state, period);
+        double* out = &output[i * kOutputColumns];
+        std::copy(command.q.begin(), command.q.end(), out);
+        out[7] = command.motion_finished ? 1.0 : 0.0;
+    }
+    return i;
+}
+
+// Feeds every recorded tick through a fresh callback per segment and writes the commands to
+// output (kOutputColumns per tick). Ticks outside a known joint segment are emitted as NaN.
+void replay(const std::vector<TickRecord>& ticks, const std::vector<SegmentRecord>& segments,
+            const std::vector<std::shared_ptr<const SegmentPlan>>& plans, FlightRecorder* recorder,
+            std::vector<double>& output) {
+    std::size_t i = 0;
+    while (i < ticks.size()) {
+        const int32_t segment = ticks[i].segment;
+        const SegmentRecord* meta =
+            segment >= 0 && static_cast<std::size_t>(segment) < segments.size() ? &segments[segment] : nullptr;
+        if (meta != nullptr && plans[segment]) {
+            SampledJointMotion motion(*plans[segment], meta->q_start);
+            SettlingMotion<SampledJointMotion> settling(motion, segmentSettle(*meta));
+            i = replaySegment(ticks, i, settling, recorder, output);
+        } else if (meta != nullptr && meta->motion == static_cast<double>(SegmentMotion::kJoint)) {
+            QuinticJointMotion motion(meta->q_start, meta->q_target, meta->safe_duration,
+                                      scalingFunction(segmentTiming(*meta).scaling));
+            SettlingMotion<QuinticJointMotion> settling(motion, segmentSettle(*meta));
+            i = replaySegment(ticks, i, settling, recorder, output);
+        } else {
+            std::fill_n(&output[i * kOutputColumns], kOutputColumns, NAN);
+            i++;
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " <recording-dir> [--golden FILE] [--write-golden FILE]"
+                  << " [--tolerance X] [--repeat N] [--with-recorder]" << std::endl;
+        return 2;
+    }
+
+    std::vector<TickRecord> ticks;
+    std::vector<SegmentRecord> segments;
+    try {
+        loadRecording(options.recording, ticks, segments);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load recording: " << e.what() << std::endl;
+        return 2;
+    }
+    std::size_t missed = 0;
+    for (const TickRecord& tick : ticks) missed += tick.period_ms > 1;
+    std::cout << "Loaded " << ticks.size() << " ticks, " << segments.size() << " segments ("
+              << missed << " ticks after a missed packet)" << std::endl;
+
+    // Timed replays; the last one's output is kept for the comparison
+    std::vector<std::shared_ptr<const SegmentPlan>> plans = planSegments(segments);
+    FlightRecorder recorder;
+    std::vector<double> output(ticks.size() * kOutputColumns);
+    std::vector<double> ns_per_tick;
+    for (int r = 0; r < options.repeat; r++) {
+        auto start = std::chrono::steady_clock::now();
+        replay(ticks, segments, plans, options.with_recorder ? &recorder : nullptr, output);
+        auto end = std::chrono::steady_clock::now();
+        ns_per_tick.push_back(std::chrono::duration<double, std::nano>(end - start).count() /
+                              std::max<std::size_t>(ticks.size(), 1));
+    }
+    std::sort(ns_per_tick.begin(), ns_per_tick.end());
+    std::cout << "Callback" << (options.with_recorder ? " + flight recorder" : "") << ": "
+              << ns_per_tick[ns_per_tick.size() / 2] << " ns/tick median, " << ns_per_tick.front()
+              << " best over " << options.repeat << " replays" << std::endl;
+
+    if (!options.write_golden.empty()) {
+        NpyWriter writer;
+        if (!writer.open(options.write_golden, "<f8", kOutputColumns) ||
+            !writer.append(output.data(), ticks.size(), kOutputColumns * sizeof(double))) {
+            std::cerr << "Failed to write " << options.write_golden << std::endl;
+            return 2;
+        }
+        std::cout << "Wrote golden output to " << options.write_golden << std::endl;
+    }
+
+    if (options.golden.empty()) return 0;
+    std::vector<unsigned char> data;
+    std::size_t rows;
+    try {
+        rows = readNpy(options.golden, "<f8", kOutputColumns, kOutputColumns * sizeof(double), data);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to load golden output: " << e.what() << std::endl;
+        return 2;
+    }
+    if (rows != ticks.size()) {
+        std::cerr << "FAIL: golden has " << rows << " ticks, recording has " << ticks.size() << std::endl;
+        return 1;
+    }
+    const double* golden = reinterpret_cast<const double*>(data.data());
+    std::size_t mismatches = 0, first_mismatch = 0;
+    double max_error = 0.0;
+    for (std::size_t i = 0; i < output.size(); i++) {
+        double a = output[i], b = golden[i];
+        bool both_nan = std::isnan(a) && std::isnan(b);
+        double error = both_nan ? 0.0 : std::abs(a - b);
+        bool equal = both_nan || (options.tolerance == 0.0 ? a == b : error <= options.tolerance);
+        if (!equal) {
+            if (mismatches++ == 0) first_mismatch = i / kOutputColumns;
+            if (!std::isnan(error)) max_error = std::max(max_error, error);
+        }
+    }
+    if (mismatches > 0) {
+        std::cerr << "FAIL: " << mismatches << " values differ (first at tick " << first_mismatch
+                  << ", max error " << max_error << ")" << std::endl;
+        return 1;
+    }
+    std::cout << "PASS: " << ticks.size() << " ticks match the golden run ";
+    if (options.tolerance == 0.0) {
+        std::cout << "bit-for-bit" << std::endl;
+    } else {
+        std::cout << "within " << options.tolerance << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Per-segment and per-cycle statistics for long dance runs: every move's MoveResult is
+// accumulated under its (from, to) segment, and p50/p95/max (including the end-of-move settle
+// time) are reported as a table, JSON or CSV so the bottleneck moves stand out.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Outcome of one moveJoints call
+struct MoveResult {
+    bool success = false;
+    double desired_duration = 0.0;    // move_time from the config (s)
+    double safe_duration = 0.0;       // After velocity-limit scaling (s)
+    double actual_duration = -1.0;    // Wall-clock time of the control session (s)
+    double overshoot = 0.0;           // actual_duration - safe_duration (s)
+    double max_tracking_error = 0.0;  // Max |q_d - q| over ticks and joints (rad)
+    int recoveries = 0;               // automaticErrorRecovery calls for this move
+    double settle_time = 0.0;         // Hold after the trajectory until the arm settled (s)
+    bool settled = true;              // False if the settle timeout ran out
+};
+
+// p50/p95/max of a sample set (nearest rank)
+struct Percentiles {
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double max = 0.0;
+};
+
+inline Percentiles percentiles(std::vector<double> values) {
+    Percentiles p;
+    if (values.empty()) return p;
+    std::sort(values.begin(), values.end());
+    auto rank = [&](double q) {
+        size_t index = static_cast<size_t>(std::ceil(q * values.size()));
+        return values[std::min(values.size(), std::max<size_t>(index, 1)) - 1];
+    };
+    p.p50 = rank(0.50);
+    p.p95 = rank(0.95);
+    p.max = values.back();
+    return p;
+}
+
+class SegmentStats {
+public:
+    struct Segment {
+        int from = 0;
+        int to = 0;
+        double desired_duration = 0.0;
+        double safe_duration = 0.0;
+        int failures = 0;
+        int recoveries = 0;
+        int settle_timeouts = 0;
+        std::vector<double> actual;
+        std::vector<double> overshoot;
+        std::vector<double> tracking_error;
+        std::vector<double> settle;
+    };
+
+    // Adds the result of the move at position `slot` of the cycle (from -> to)
+    void add(size_t slot, int from, int to, const MoveResult& result) {
+        if (slot >= segments_.size()) segments_.resize(slot + 1);
+        Segment& segment = segments_[slot];
+        segment.from = from;
+        segment.to = to;
+        segment.desired_duration = result.desired_duration;
+        segment.recoveries += result.recoveries;
+        if (!result.success) {
+            segment.failures++;
+            return;
+        }
+        segment.safe_duration = result.safe_duration;
+        segment.actual.push_back(result.actual_duration);
+        segment.overshoot.push_back(result.overshoot);
+        segment.tracking_error.push_back(result.max_tracking_error);
+        segment.settle.push_back(result.settle_time);
+        segment.settle_timeouts += !result.settled;
+    }
+
+    // Marks the end of a cycle that took `seconds` (moves, settling and dwell)
+    void endCycle(double seconds) { cycle_times_.push_back(seconds); }
+
+    size_t cycles() const { return cycle_times_.size(); }
+    const std::vector<Segment>& segments() const { return segments_; }
+
+    void printTable(std::ostream& out) const {
+        out << "Segment statistics over " << cycles()
+            << " cycles (durations in s, tracking error in mrad, settle time in ms)\n";
+        out << "| From | To | Count | Safe | Actual p50 | p95 | max | Overshoot p50 | p95 | max"
+            << " | Tracking p50 | p95 | max | Settle p50 | p95 | max | Settle timeouts | Recoveries | Failures |\n";
+        out << std::fixed << std::setprecision(4);
+        for (const Segment& s : segments_) {
+            Percentiles actual = percentiles(s.actual);
+            Percentiles overshoot = percentiles(s.overshoot);
+            Percentiles tracking = percentiles(s.tracking_error);
+            Percentiles settle = percentiles(s.settle);
+            out << "| " << s.from << " | " << s.to << " | " << s.actual.size() << " | " << s.safe_duration
+                << " | " << actual.p50 << " | " << actual.p95 << " | " << actual.max
+                << " | " << overshoot.p50 << " | " << overshoot.p95 << " | " << overshoot.max
+                << " | " << tracking.p50 * 1000 << " | " << tracking.p95 * 1000 << " | " << tracking.max * 1000
+                << " | " << std::setprecision(1) << settle.p50 * 1000 << " | " << settle.p95 * 1000 << " | "
+                << settle.max * 1000 << std::setprecision(4) << " | " << s.settle_timeouts
+                << " | " << s.recoveries << " | " << s.failures << " |\n";
+        }
+        Percentiles cycle = percentiles(cycle_times_);
+        out << "Cycle time p50 " << cycle.p50 << "s, p95 " << cycle.p95 << "s, max " << cycle.max << "s\n";
+        out << std::defaultfloat << std::setprecision(6);
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << std::setprecision(9);
+        out << "{\n  \"cycles\": " << cycles() << ",\n  \"cycle_time\": ";
+        writePercentiles(out, percentiles(cycle_times_));
+        out << ",\n  \"segments\": [";
+        for (size_t i = 0; i < segments_.size(); i++) {
+            const Segment& s = segments_[i];
+            out << (i ? ",\n" : "\n") << "    {\"from\": " << s.from << ", \"to\": " << s.to
+                << ", \"count\": " << s.actual.size() << ", \"desired_duration\": " << s.desired_duration
+                << ", \"safe_duration\": " << s.safe_duration << ", \"recoveries\": " << s.recoveries
+                << ", \"failures\": " << s.failures << ", \"settle_timeouts\": " << s.settle_timeouts
+                << ",\n     \"actual_duration\": ";
+            writePercentiles(out, percentiles(s.actual));
+            out << ", \"overshoot\": ";
+            writePercentiles(out, percentiles(s.overshoot));
+            out << ", \"max_tracking_error\": ";
+            writePercentiles(out, percentiles(s.tracking_error));
+            out << ", \"settle_time\": ";
+            writePercentiles(out, percentiles(s.settle));
+            out << "}";
+        }
+        out << "\n  ]\n}\n";
+        return static_cast<bool>(out);
+    }
+
+    bool writeCsv(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << std::setprecision(9);
+        out << "from,to,count,desired_duration,safe_duration,recoveries,failures,settle_timeouts,"
+            << "actual_p50,actual_p95,actual_max,overshoot_p50,overshoot_p95,overshoot_max,"
+            << "tracking_p50,tracking_p95,tracking_max,settle_p50,settle_p95,settle_max\n";
+        for (const Segment& s : segments_) {
+            Percentiles actual = percentiles(s.actual);
+            Percentiles overshoot = percentiles(s.overshoot);
+            Percentiles tracking = percentiles(s.tracking_error);
+            Percentiles settle = percentiles(s.settle);
+            out << s.from << ',' << s.to << ',' << s.actual.size() << ',' << s.desired_duration << ','
+                << s.safe_duration << ',' << s.recoveries << ',' << s.failures << ',' << s.settle_timeouts << ','
+                << actual.p50 << ',' << actual.p95 << ',' << actual.max << ','
+                << overshoot.p50 << ',' << overshoot.p95 << ',' << overshoot.max << ','
+                << tracking.p50 << ',' << tracking.p95 << ',' << tracking.max << ','
+                << settle.p50 << ',' << settle.p95 << ',' << settle.max << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+
+private:
+    static void writePercentiles(std::ostream& out, const Percentiles& p) {
+        out << "{\"p50\": " << p.p50 << ", \"p95\": " << p.p95 << ", \"max\": " << p.max << "}";
+    }
+
+    std::vector<Segment> segments_;
+    std::vector<double> cycle_times_;
+};
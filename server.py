@@ -2,60 +2,111 @@ import netifaces as ni
 import zerorpc
 import scipy.spatial.transform as st
 import numpy as np
+import threading
+import time
 import torch
 from polymetis import RobotInterface, GripperInterface
+from streaming import StatePublisher, PoseSink
+import config
 
 class FrankaInterface:
     def __init__(self):
         self.robot = RobotInterface('localhost')
         self.gripper = GripperInterface('localhost')
+        self.tracer = None
+        # The zerorpc handlers, the state publisher, the pose sink and the upsampler all
+        # run on different threads; every robot/gripper call goes through this lock.
+        # Reentrant so read_state_sample can hold it across its whole sample.
+        self.robot_lock = threading.RLock()
 
     def get_ee_pose(self):
-        data = self.robot.get_ee_pose()
+        with self.robot_lock:
+            data = self.robot.get_ee_pose()
         pos = data[0].numpy()
         quat_xyzw = data[1].numpy()
         rot_vec = st.Rotation.from_quat(quat_xyzw).as_rotvec()
         return np.concatenate([pos, rot_vec]).tolist()
     
     def get_joint_positions(self):
-        return self.robot.get_joint_positions().numpy().tolist()
+        with self.robot_lock:
+            return self.robot.get_joint_positions().numpy().tolist()
     
     def get_joint_velocities(self):
-        return self.robot.get_joint_velocities().numpy().tolist()
+        with self.robot_lock:
+            return self.robot.get_joint_velocities().numpy().tolist()
     
     def move_to_joint_positions(self, positions, time_to_go):
-        self.robot.move_to_joint_positions(
-            positions=torch.Tensor(positions),
-            time_to_go=time_to_go
-        )
+        # Start the move without blocking and wait with the lock released between polls,
+        # so the state stream keeps publishing while the robot moves
+        with self.robot_lock:
+            self.robot.move_to_joint_positions(
+                positions=torch.Tensor(positions),
+                time_to_go=time_to_go,
+                blocking=False
+            )
+        while True:
+            with self.robot_lock:
+                if not self.robot.is_running_policy():
+                    break
+            time.sleep(0.01)
     
     def start_cartesian_impedance(self, Kx, Kxd):
-        self.robot.start_cartesian_impedance(
-            Kx=torch.Tensor(Kx),
-            Kxd=torch.Tensor(Kxd)
-        )
+        with self.robot_lock:
+            self.robot.start_cartesian_impedance(
+                Kx=torch.Tensor(Kx),
+                Kxd=torch.Tensor(Kxd)
+            )
 
     def update_desired_ee_pose(self, pose):
         pose = np.asarray(pose)
-        self.robot.update_desired_ee_pose(
-            position=torch.Tensor(pose[:3]),
-            orientation=torch.Tensor(st.Rotation.from_rotvec(pose[3:]).as_quat())
-        )
+        position = torch.Tensor(pose[:3])
+        orientation = torch.Tensor(st.Rotation.from_rotvec(pose[3:]).as_quat())
+        with self.robot_lock:
+            self.robot.update_desired_ee_pose(position=position, orientation=orientation)
+
+    def update_desired_ee_pose_quat(self, position, quat_xyzw):
+        """Pose update with a quaternion orientation (used by the upsampling loop)."""
+        position = torch.Tensor(position)
+        orientation = torch.Tensor(quat_xyzw)
+        with self.robot_lock:
+            self.robot.update_desired_ee_pose(position=position, orientation=orientation)
 
     def terminate_current_policy(self):
-        self.robot.terminate_current_policy()
+        with self.robot_lock:
+            self.robot.terminate_current_policy()
 
     def get_gripper_width(self):
-        return self.gripper.get_state().width
+        with self.robot_lock:
+            return self.gripper.get_state().width
     
     def set_gripper_width(self, width):
         # Optimized gripper control - using goto instead of grasp for better performance
-        self.gripper.goto(width=width, speed=0.3, force=10, blocking=False)
+        with self.robot_lock:
+            self.gripper.goto(width=width, speed=0.3, force=10, blocking=False)
 
     def get_joint_angles(self):
         """Alias for get_joint_positions for backward compatibility"""
         return self.get_joint_positions()
 
+    def get_latency_summary(self):
+        """Per-stage pose target latency statistics (empty if tracing is disabled)."""
+        return self.tracer.summary() if self.tracer else {}
+
+    def export_latency_trace(self, path):
+        """Write recent pose target spans as a Chrome/Perfetto trace on the server; returns span count."""
+        return self.tracer.export_chrome_trace(path) if self.tracer else 0
+
+    def read_state_sample(self):
+        """Read one state sample for the state stream (single robot state query + FK)."""
+        with self.robot_lock:
+            state = self.robot.get_robot_state()
+            gripper_width = self.get_gripper_width()
+        q = torch.Tensor(state.joint_positions)
+        pos, quat_xyzw = self.robot.robot_model.forward_kinematics(q)
+        rot_vec = st.Rotation.from_quat(quat_xyzw.numpy()).as_rotvec()
+        ee_pose = np.concatenate([pos.numpy(), rot_vec])
+        return ee_pose, state.joint_positions, state.joint_velocities, gripper_width
+
 
 # Display network interfaces for debugging
 def show_network_interfaces():
@@ -72,8 +123,73 @@ def show_network_interfaces():
 if __name__ == "__main__":
     show_network_interfaces()
     
+    franka_interface = FrankaInterface()
+
+    # Per-stage latency histograms and trace spans for pose targets
+    tracer = None
+    if config.LATENCY_TRACING_ENABLED:
+        from tracing import LatencyTracer
+        tracer = LatencyTracer(max_spans=config.LATENCY_TRACE_MAX_SPANS)
+        franka_interface.tracer = tracer
+
+    # Start the state stream so monitoring consumers do not have to poll over RPC
+    print(f"Publishing robot state on port {config.STATE_PUBLISH_PORT} at {config.STATE_PUBLISH_RATE} Hz...")
+    state_publisher = StatePublisher(
+        franka_interface.read_state_sample,
+        f"tcp://0.0.0.0:{config.STATE_PUBLISH_PORT}",
+        config.STATE_PUBLISH_RATE
+    )
+    state_publisher.start()
+
+    # Either apply each target directly or upsample sparse AR targets to a fixed-rate reference
+    if config.POSE_UPSAMPLING_ENABLED:
+        from upsampling import TargetUpsampler
+        print(f"Upsampling pose targets to {config.UPSAMPLING_RATE} Hz...")
+        upsampler = TargetUpsampler(
+            franka_interface.update_desired_ee_pose_quat,
+            rate=config.UPSAMPLING_RATE,
+            playout_delay=config.UPSAMPLING_PLAYOUT_DELAY,
+            max_extrapolation=config.UPSAMPLING_MAX_EXTRAPOLATION,
+            max_extrapolation_distance=config.UPSAMPLING_MAX_EXTRAPOLATION_DISTANCE,
+            tracer=tracer
+        )
+        upsampler.start()
+        apply_target = upsampler.push
+    else:
+        apply_target = lambda pose, stamp, seq: franka_interface.update_desired_ee_pose(pose)
+
+    # Forward-predict targets by the measured pipeline latency
+    if config.PREDICTION_ENABLED:
+        from prediction import LatencyCompensator
+        print("Latency compensation enabled...")
+        compensator = LatencyCompensator(
+            alpha=config.PREDICTOR_ALPHA,
+            max_lead=config.PREDICTOR_MAX_LEAD,
+            extra_latency=config.PREDICTION_EXTRA_LATENCY,
+            smoothing=config.LATENCY_SMOOTHING
+        )
+        # Upsampled targets reach the robot one playout delay after they are pushed
+        playout_delay = config.UPSAMPLING_PLAYOUT_DELAY if config.POSE_UPSAMPLING_ENABLED else 0.0
+        apply_uncompensated = apply_target
+
+        def apply_target(pose, stamp, seq):
+            apply_uncompensated(compensator.compensate(np.asarray(pose), stamp), stamp, seq)
+            compensator.observe(time.time() - stamp + playout_delay)
+
+    # Start the one-way pose stream (latest-wins, acks for liveness)
+    print(f"Accepting one-way pose targets on port {config.POSE_STREAM_PORT}...")
+    pose_sink = PoseSink(
+        apply_target,
+        f"tcp://0.0.0.0:{config.POSE_STREAM_PORT}",
+        ack_endpoint=f"tcp://0.0.0.0:{config.POSE_ACK_PORT}" if config.POSE_ACK_INTERVAL > 0 else None,
+        ack_interval=config.POSE_ACK_INTERVAL,
+        tracer=tracer,
+        traces_actuation=not config.POSE_UPSAMPLING_ENABLED
+    )
+    pose_sink.start()
+
     # Start the ZeroRPC server
     print("Starting Franka interface server on port 4242...")
-    s = zerorpc.Server(FrankaInterface())
+    s = zerorpc.Server(franka_interface)
     s.bind("tcp://0.0.0.0:4242")
     s.run()
\ No newline at end of file
@@ -0,0 +1,135 @@
+// Simulated stand-in for franka::Robot, used by random_points --simulate and the offline tools.
+// control() calls the callback once per 1 ms tick the way libfranka does (first period is zero,
+// a missed packet shows up as a 2 ms period) and the joints track the last command with a
+// first-order lag. Cartesian pose commands are mapped to joint commands with damped
+// least-squares IK (panda_kinematics.h) seeded from the previous command, and O_T_EE/O_T_EE_c
+// follow from forward kinematics. Only the members random_points.cpp uses are provided.
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <random>
+#include <thread>
+#include <franka/control_types.h>
+#include <franka/duration.h>
+#include <franka/robot_state.h>
+#include "panda_kinematics.h"
+
+// Panda ready pose, where a simulated robot starts
+constexpr std::array<double, 7> kPandaHome{{0.0, -M_PI_4, 0.0, -3 * M_PI_4, 0.0, M_PI_2, M_PI_4}};
+
+class SimulatedRobot {
+public:
+    struct Options {
+        double time_constant = 0.01;     // Joint tracking lag (s)
+        double missed_tick_rate = 0.0;   // Probability that a tick's command packet is lost
+        bool real_time = true;           // Pace ticks at 1 kHz wall-clock
+        uint64_t seed = 0;
+        size_t ik_iterations = 10;       // Per tick, for Cartesian commands
+    };
+
+    using JointCallback = std::function<franka::JointPositions(const franka::RobotState&, franka::Duration)>;
+    using CartesianCallback = std::function<franka::CartesianPose(const franka::RobotState&, franka::Duration)>;
+
+    explicit SimulatedRobot(const std::array<double, 7>& q_initial = kPandaHome)
+        : SimulatedRobot(q_initial, Options()) {}
+
+    SimulatedRobot(const std::array<double, 7>& q_initial, const Options& options)
+        : options_(options), rng_(options.seed) {
+        state_.q = q_initial;
+        state_.q_d = q_initial;
+        state_.control_command_success_rate = 1.0;
+        updatePoses();
+    }
+
+    franka::RobotState readOnce() { return state_; }
+
+    void control(JointCallback callback) {
+        run(callback, [this](const franka::JointPositions& command) { state_.q_d = command.q; });
+    }
+
+    void control(CartesianCallback callback) {
+        run(callback, [this](const franka::CartesianPose& command) {
+            panda::Frame target;
+            for (size_t r = 0; r < 3; r++) {
+                for (size_t c = 0; c < 3; c++) target.R[3 * r + c] = command.O_T_EE[4 * c + r];
+                target.p[r] = command.O_T_EE[12 + r];
+            }
+            panda::inverseKinematics(target, state_.q_d, options_.ik_iterations, 1e-9);
+        });
+    }
+
+    void automaticErrorRecovery() {}
+
+    const franka::RobotState& state() const { return state_; }
+
+private:
+    // Control loop shared by the command types; apply turns a command into q_d
+    template <typename Callback, typename Apply>
+    void run(Callback& callback, Apply apply) {
+        franka::Duration period(0);
+        auto next_tick = std::chrono::steady_clock::now();
+        std::bernoulli_distribution missed(options_.missed_tick_rate);
+        while (true) {
+            auto command = callback(state_, period);
+            if (command.motion_finished) {
+                apply(command);
+                updatePoses();
+                return;
+            }
+            // A lost packet: the robot holds the previous command and the next callback sees 2 ms
+            uint64_t ticks = 1;
+            if (options_.missed_tick_rate > 0.0 && missed(rng_)) {
+                ticks = 2;
+            } else {
+                apply(command);
+            }
+            step(ticks);
+            period = franka::Duration(ticks);
+            if (options_.real_time) {
+                next_tick += std::chrono::milliseconds(ticks);
+                std::this_thread::sleep_until(next_tick);
+            }
+        }
+    }
+
+    // O_T_EE from the measured joints, O_T_EE_d and O_T_EE_c from the commanded ones (column-major)
+    void updatePoses() {
+        auto toMatrix = [](const panda::Frame& frame, std::array<double, 16>& T) {
+            for (size_t r = 0; r < 3; r++) {
+                for (size_t c = 0; c < 3; c++) T[4 * c + r] = frame.R[3 * r + c];
+                T[12 + r] = frame.p[r];
+                T[4 * r + 3] = 0.0;
+            }
+            T[15] = 1.0;
+        };
+        toMatrix(panda::forwardKinematics(state_.q).frames[8], state_.O_T_EE);
+        toMatrix(panda::forwardKinematics(state_.q_d).frames[8], state_.O_T_EE_d);
+        state_.O_T_EE_c = state_.O_T_EE_d;
+    }
+
+    // Advances the first-order joint tracking by ticks milliseconds
+    void step(uint64_t ticks) {
+        double dt = ticks * 0.001;
+        double gain = 1.0 - std::exp(-dt / options_.time_constant);
+        for (size_t i = 0; i < 7; i++) {
+            double q_next = state_.q[i] + gain * (state_.q_d[i] - state_.q[i]);
+            state_.dq[i] = (q_next - state_.q[i]) / dt;
+            state_.q[i] = q_next;
+        }
+        state_.time += franka::Duration(ticks);
+        received_ += 1;
+        sent_ += ticks;
+        state_.control_command_success_rate = static_cast<double>(received_) / sent_;
+        updatePoses();
+    }
+
+    Options options_;
+    std::mt19937_64 rng_;
+    franka::RobotState state_;
+    uint64_t received_ = 0;
+    uint64_t sent_ = 0;
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+// Minimal quaternion / rotation-vector helpers shared by the native pose filters.
+// Quaternions are stored as {x, y, z, w} to match scipy and Polymetis.
+namespace so3 {
+
+using Vec3 = std::array<double, 3>;
+using Quat = std::array<double, 4>;
+
+inline Quat quatMultiply(const Quat& a, const Quat& b) {
+    return {a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+            a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0],
+            a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3],
+            a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2]};
+}
+
+inline Quat quatConjugate(const Quat& q) {
+    return {-q[0], -q[1], -q[2], q[3]};
+}
+
+inline Quat quatNormalize(const Quat& q) {
+    double n = std::sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    if (n < 1e-12) {
+        return {0.0, 0.0, 0.0, 1.0};
+    }
+    return {q[0] / n, q[1] / n, q[2] / n, q[3] / n};
+}
+
+// Rotation vector -> unit quaternion
+inline Quat quatExp(const Vec3& v) {
+    double angle = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    double half = 0.5 * angle;
+    // sin(half)/angle, with a Taylor expansion near zero
+    double k = angle < 1e-8 ? 0.5 - angle * angle / 48.0 : std::sin(half) / angle;
+    return {v[0] * k, v[1] * k, v[2] * k, std::cos(half)};
+}
+
+// Unit quaternion -> rotation vector (shortest rotation, angle in [0, pi])
+inline Vec3 quatLog(const Quat& q) {
+    double sign = q[3] < 0.0 ? -1.0 : 1.0;
+    double x = sign * q[0], y = sign * q[1], z = sign * q[2], w = sign * q[3];
+    double s = std::sqrt(x * x + y * y + z * z);
+    double k = s < 1e-8 ? 2.0 / w : 2.0 * std::atan2(s, w) / s;
+    return {x * k, y * k, z * k};
+}
+
+// Rotation from a to b expressed in a's frame: log(a^-1 * b)
+inline Vec3 boxMinus(const Quat& b, const Quat& a) {
+    return quatLog(quatMultiply(quatConjugate(a), b));
+}
+
+// a rotated by the local rotation vector v: a * exp(v)
+inline Quat boxPlus(const Quat& a, const Vec3& v) {
+    return quatNormalize(quatMultiply(a, quatExp(v)));
+}
+
+inline Quat slerp(const Quat& a, const Quat& b, double s) {
+    Vec3 d = boxMinus(b, a);
+    return boxPlus(a, {d[0] * s, d[1] * s, d[2] * s});
+}
+
+}  // namespace so3
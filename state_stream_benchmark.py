@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""
+Local multi-subscriber benchmark for the server state stream.
+Runs a StatePublisher with a synthetic robot state source (no Polymetis needed)
+and measures publisher CPU usage as subscribers are added. Half of the
+subscribers are deliberately slow to exercise conflation.
+"""
+
+import argparse
+import multiprocessing as mp
+import time
+import numpy as np
+import psutil
+import zmq
+from streaming import StatePublisher, StateSubscriber
+
+ENDPOINT_BIND = "tcp://127.0.0.1:{port}"
+
+
+def synthetic_state():
+    """Stand-in for FrankaInterface.read_state_sample."""
+    t = time.time()
+    q = [np.sin(t + i) for i in range(7)]
+    dq = [np.cos(t + i) for i in range(7)]
+    ee_pose = [0.3, 0.0, 0.5, np.pi, 0.0, 0.0]
+    return ee_pose, q, dq, 0.08
+
+
+def run_publisher(port, rate, stop_event):
+    publisher = StatePublisher(synthetic_state, ENDPOINT_BIND.format(port=port), rate,
+                               context=zmq.Context())
+    publisher.start()
+    stop_event.wait()
+    publisher.stop()
+
+
+def run_subscriber(port, slow, duration, results):
+    subscriber = StateSubscriber(ENDPOINT_BIND.format(port=port), context=zmq.Context())
+    received = 0
+    ages = []
+    last_seq = None
+    end = time.time() + duration
+    while time.time() < end:
+        state = subscriber.latest(timeout=0.1)
+        if state is not None and state['seq'] != last_seq:
+            last_seq = state['seq']
+            received += 1
+            ages.append((time.time() - state['stamp']) * 1000)
+        if slow:
+            time.sleep(0.02)  # 50 Hz consumer
+    subscriber.close()
+    results.put((slow, received / duration, float(np.median(ages)) if ages else -1.0))
+
+
+def measure(num_subscribers, port, rate, duration):
+    stop_event = mp.Event()
+    publisher = mp.Process(target=run_publisher, args=(port, rate, stop_event))
+    publisher.start()
+    time.sleep(0.3)
+
+    results = mp.Queue()
+    subscribers = [mp.Process(target=run_subscriber, args=(port, i % 2 == 1, duration, results))
+                   for i in range(num_subscribers)]
+    for s in subscribers:
+        s.start()
+    time.sleep(0.3)  # Let subscriptions propagate before measuring
+
+    proc = psutil.Process(publisher.pid)
+    proc.cpu_percent(interval=None)
+    time.sleep(duration - 0.6)
+    cpu = proc.cpu_percent(interval=None)
+
+    for s in subscribers:
+        s.join()
+    stop_event.set()
+    publisher.join()
+
+    samples = [results.get() for _ in subscribers]
+    fast = [r for r in samples if not r[0]]
+    slow = [r for r in samples if r[0]]
+    return cpu, fast, slow
+
+
+def main():
+    parser = argparse.ArgumentParser(description='State stream multi-subscriber benchmark')
+    parser.add_argument('--rate', type=float, default=1000, help='Publish rate in Hz (default: 1000)')
+    parser.add_argument('--duration', type=float, default=3.0, help='Seconds per measurement (default: 3)')
+    parser.add_argument('--subscribers', type=int, nargs='+', default=[0, 1, 2, 4, 8, 16])
+    parser.add_argument('--port', type=int, default=5243)
+    args = parser.parse_args()
+
+    print(f"State stream benchmark at {args.rate:.0f} Hz")
+    print("=" * 72)
+    print(f"{'subs':>5} | {'pub CPU %':>9} | {'fast sub Hz':>11} | {'slow sub Hz':>11} | {'median age ms':>13}")
+    print("-" * 72)
+    for n in args.subscribers:
+        cpu, fast, slow = measure(n, args.port, args.rate, args.duration)
+        fast_hz = np.mean([r[1] for r in fast]) if fast else 0.0
+        slow_hz = np.mean([r[1] for r in slow]) if slow else 0.0
+        ages = [r[2] for r in fast + slow if r[2] >= 0]
+        age = np.median(ages) if ages else 0.0
+        print(f"{n:>5} | {cpu:>9.1f} | {fast_hz:>11.1f} | {slow_hz:>11.1f} | {age:>13.2f}")
+    print("=" * 72)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,310 @@
+"""
+Streaming channels between server.py and its clients.
+
+The zerorpc interface is strictly request/response, so every monitoring
+consumer polling the robot adds load on the single server. The state stream
+inverts that: the server samples the robot once per period and publishes the
+sample on a ZeroMQ PUB socket, and ZeroMQ fans it out to any number of
+subscribers. Subscribers are conflated, so a slow consumer only ever sees the
+most recent sample instead of a growing backlog.
+
+The pose stream is the reverse direction: a one-way PUSH/PULL channel for
+impedance targets. The sender never waits for the server, both ends are
+conflated so only the newest target is queued, and the sink drops anything
+older than what it already applied (latest wins). Optional periodic acks on a
+PUB socket report liveness and how many targets were coalesced.
+"""
+
+import os
+import struct
+import threading
+import time
+import zmq
+
+# Single-frame message: topic prefix followed by a fixed-size binary payload.
+# ZMQ_CONFLATE does not support multipart messages, hence no separate topic frame.
+STATE_TOPIC = b"S"
+# seq, stamp, ee_pose[6], q[7], dq[7], gripper_width
+STATE_FORMAT = struct.Struct("<Qd6d7d7dd")
+
+# sender id, seq, sample stamp, send stamp, pose[6] (x, y, z, rx, ry, rz)
+POSE_FORMAT = struct.Struct("<IQdd6d")
+# last received seq, last applied seq, applied, coalesced, stale, errors, server stamp
+ACK_FORMAT = struct.Struct("<QQQQQQd")
+
+
+def pack_state(seq, stamp, ee_pose, q, dq, gripper_width):
+    """Serialize one state sample into a state stream message."""
+    return STATE_TOPIC + STATE_FORMAT.pack(seq, stamp, *ee_pose, *q, *dq, gripper_width)
+
+
+def unpack_state(message):
+    """Deserialize a state stream message into a dict."""
+    values = STATE_FORMAT.unpack_from(message, len(STATE_TOPIC))
+    return {
+        'seq': values[0],
+        'stamp': values[1],
+        'ee_pose': values[2:8],
+        'joint_positions': values[8:15],
+        'joint_velocities': values[15:22],
+        'gripper_width': values[22],
+    }
+
+
+class StatePublisher:
+    """Samples robot state at a fixed rate and publishes it to all subscribers."""
+
+    def __init__(self, read_state, endpoint, rate, context=None):
+        # read_state() must return (ee_pose, joint_positions, joint_velocities, gripper_width)
+        self.read_state = read_state
+        self.endpoint = endpoint
+        self.period = 1.0 / rate
+        self.context = context or zmq.Context.instance()
+        self.running = False
+        self.thread = None
+        self.seq = 0
+        self.overruns = 0
+
+    def start(self):
+        """Bind the PUB socket and start the publishing thread."""
+        if self.running:
+            return
+        self.socket = self.context.socket(zmq.PUB)
+        # Keep per-subscriber queues tiny: a subscriber that cannot keep up
+        # should drop samples, not make the publisher buffer them.
+        self.socket.setsockopt(zmq.SNDHWM, 2)
+        self.socket.setsockopt(zmq.LINGER, 0)
+        self.socket.bind(self.endpoint)
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def stop(self):
+        """Stop the publishing thread and close the socket."""
+        self.running = False
+        if self.thread:
+            self.thread.join()
+            self.thread = None
+        self.socket.close()
+
+    def _run(self):
+        """Publishing loop with absolute deadlines so the rate does not drift."""
+        next_deadline = time.perf_counter()
+        while self.running:
+            try:
+                ee_pose, q, dq, gripper_width = self.read_state()
+                # PUB never blocks or raises on a full queue: slow subscribers just drop the sample
+                self.socket.send(pack_state(self.seq, time.time(), ee_pose, q, dq, gripper_width),
+                                 zmq.NOBLOCK)
+                self.seq += 1
+            except Exception as e:
+                print(f"State publisher error: {e}")
+
+            next_deadline += self.period
+            delay = next_deadline - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                # Fell behind (slow robot read); restart the schedule instead of bursting
+                self.overruns += 1
+                next_deadline = time.perf_counter()
+
+
+class StateSubscriber:
+    """Conflated subscriber that always yields the most recent published state."""
+
+    def __init__(self, endpoint, context=None):
+        self.endpoint = endpoint
+        self.context = context or zmq.Context.instance()
+        self.socket = self.context.socket(zmq.SUB)
+        # Conflation must be configured before connecting
+        self.socket.setsockopt(zmq.CONFLATE, 1)
+        self.socket.setsockopt(zmq.LINGER, 0)
+        self.socket.setsockopt(zmq.SUBSCRIBE, STATE_TOPIC)
+        self.socket.connect(endpoint)
+        self.last_state = None
+
+    def latest(self, timeout=0.0):
+        """
+        Return the newest state sample, waiting up to `timeout` seconds for one.
+        Falls back to the previously received sample (or None) if nothing new arrived.
+        """
+        if self.socket.poll(int(timeout * 1000)):
+            self.last_state = unpack_state(self.socket.recv())
+        return self.last_state
+
+    def close(self):
+        if self.socket is not None:
+            self.socket.close()
+            self.socket = None
+
+
+class PoseSink:
+    """
+    Server side of the one-way pose stream. Applies only the newest target:
+    the conflated PULL socket keeps a single pending message while apply_pose
+    blocks, and sequence numbers reject anything older than the last target.
+    """
+
+    def __init__(self, apply_pose, endpoint, ack_endpoint=None, ack_interval=0.1, context=None,
+                 tracer=None, traces_actuation=True):
+        # apply_pose(pose, stamp, seq) receives the target, its sample timestamp and sequence number
+        self.apply_pose = apply_pose
+        # Optional tracing.LatencyTracer; when apply_pose hands targets to a later stage (upsampling)
+        # that stage records the actuation latency instead (traces_actuation=False)
+        self.tracer = tracer
+        self.traces_actuation = traces_actuation
+        self.endpoint = endpoint
+        self.ack_endpoint = ack_endpoint
+        self.ack_interval = ack_interval
+        self.context = context or zmq.Context.instance()
+        self.running = False
+        self.thread = None
+
+        self.sender_id = None
+        self.last_received_seq = 0
+        self.last_applied_seq = 0
+        self.applied = 0
+        self.coalesced = 0
+        self.stale = 0
+        self.errors = 0
+
+    def start(self):
+        """Bind the sockets and start the apply thread."""
+        if self.running:
+            return
+        self.socket = self.context.socket(zmq.PULL)
+        self.socket.setsockopt(zmq.CONFLATE, 1)
+        self.socket.setsockopt(zmq.LINGER, 0)
+        self.socket.bind(self.endpoint)
+        self.ack_socket = None
+        if self.ack_endpoint:
+            self.ack_socket = self.context.socket(zmq.PUB)
+            self.ack_socket.setsockopt(zmq.SNDHWM, 2)
+            self.ack_socket.setsockopt(zmq.LINGER, 0)
+            self.ack_socket.bind(self.ack_endpoint)
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def stop(self):
+        """Stop the apply thread and close the sockets."""
+        self.running = False
+        if self.thread:
+            self.thread.join()
+            self.thread = None
+        self.socket.close()
+        if self.ack_socket is not None:
+            self.ack_socket.close()
+
+    def _trace(self, seq, stamp, sent, received, apply_start, applied):
+        self.tracer.record('ar_to_send', stamp, sent, seq)
+        self.tracer.record('network', sent, received, seq)
+        self.tracer.record('queue', received, apply_start, seq)
+        self.tracer.record('apply', apply_start, applied, seq)
+        if self.traces_actuation:
+            self.tracer.record('ar_to_robot', stamp, applied, seq)
+
+    def _send_ack(self):
+        # PUB drops the ack for a subscriber that cannot take it; send never raises zmq.Again
+        self.ack_socket.send(ACK_FORMAT.pack(self.last_received_seq, self.last_applied_seq,
+                                             self.applied, self.coalesced, self.stale,
+                                             self.errors, time.time()), zmq.NOBLOCK)
+
+    def _run(self):
+        next_ack = time.perf_counter()
+        poll_ms = int(self.ack_interval * 1000) if self.ack_socket is not None else 100
+        while self.running:
+            if self.socket.poll(poll_ms):
+                sender_id, seq, stamp, sent, *pose = POSE_FORMAT.unpack(self.socket.recv())
+                received = time.time()
+                if sender_id != self.sender_id:
+                    # New client session: its sequence numbers start over
+                    self.sender_id = sender_id
+                    self.last_received_seq = 0
+                    self.last_applied_seq = 0
+                if seq <= self.last_applied_seq:
+                    # Late target from the current session
+                    self.stale += 1
+                else:
+                    # Anything between the last received and this one was conflated away
+                    if seq > self.last_received_seq + 1 and self.last_received_seq > 0:
+                        self.coalesced += seq - self.last_received_seq - 1
+                    self.last_received_seq = seq
+                    try:
+                        apply_start = time.time()
+                        self.apply_pose(pose, stamp, seq)
+                        self.last_applied_seq = seq
+                        self.applied += 1
+                        if self.tracer is not None:
+                            self._trace(seq, stamp, sent, received, apply_start, time.time())
+                    except Exception as e:
+                        self.errors += 1
+                        if self.errors % 100 == 1:
+                            print(f"Pose stream apply error: {e}")
+
+            if self.ack_socket is not None and time.perf_counter() >= next_ack:
+                self._send_ack()
+                next_ack = time.perf_counter() + self.ack_interval
+
+
+class PoseSender:
+    """Client side of the one-way pose stream. send() never blocks on the server."""
+
+    def __init__(self, endpoint, ack_endpoint=None, context=None):
+        self.context = context or zmq.Context.instance()
+        self.socket = self.context.socket(zmq.PUSH)
+        # Only the newest unsent target is kept if the link is congested
+        self.socket.setsockopt(zmq.CONFLATE, 1)
+        self.socket.setsockopt(zmq.LINGER, 0)
+        self.socket.connect(endpoint)
+        self.sender_id = int.from_bytes(os.urandom(4), 'little')
+        self.seq = 0
+
+        self.ack_socket = None
+        self.last_ack = None
+        if ack_endpoint:
+            self.ack_socket = self.context.socket(zmq.SUB)
+            self.ack_socket.setsockopt(zmq.CONFLATE, 1)
+            self.ack_socket.setsockopt(zmq.LINGER, 0)
+            self.ack_socket.setsockopt(zmq.SUBSCRIBE, b"")
+            self.ack_socket.connect(ack_endpoint)
+
+    def send(self, pose, stamp=None):
+        """
+        Queue a pose target and return its sequence number immediately.
+        `stamp` is the sample time of the target (defaults to now).
+        """
+        self.seq += 1
+        now = time.time()
+        if stamp is None:
+            stamp = now
+        try:
+            self.socket.send(POSE_FORMAT.pack(self.sender_id, self.seq, stamp, now, *pose), zmq.NOBLOCK)
+        except zmq.Again:
+            pass  # Not connected yet; the next target supersedes this one anyway
+        return self.seq
+
+    def ack(self, timeout=0.0):
+        """Return the newest server ack as a dict (or None if acks are disabled/not yet received)."""
+        if self.ack_socket is not None and self.ack_socket.poll(int(timeout * 1000)):
+            values = ACK_FORMAT.unpack(self.ack_socket.recv())
+            self.last_ack = {
+                'last_received_seq': values[0],
+                'last_applied_seq': values[1],
+                'applied': values[2],
+                'coalesced': values[3],
+                'stale': values[4],
+                'errors': values[5],
+                'stamp': values[6],
+                'received_at': time.time(),
+            }
+        return self.last_ack
+
+    def close(self):
+        if self.socket is not None:
+            self.socket.close()
+            self.socket = None
+        if self.ack_socket is not None:
+            self.ack_socket.close()
+            self.ack_socket = None
@@ -0,0 +1,65 @@
+#!/usr/bin/env python3
+"""
+Offline checks for FrankaClient connection handling.
+No server is needed: zerorpc is replaced by a stub that only records calls,
+while the state and pose streams use real ZeroMQ sockets.
+
+Run with: python3 -m unittest test_franka_client
+"""
+
+import sys
+import types
+import unittest
+
+
+class StubRpcClient:
+    """Stands in for zerorpc.Client; connect() never touches the network."""
+
+    def __init__(self, heartbeat=None, timeout=None):
+        self.endpoint = None
+        self.closed = False
+
+    def connect(self, endpoint):
+        self.endpoint = endpoint
+
+    def close(self):
+        self.closed = True
+
+
+sys.modules.setdefault('zerorpc', types.SimpleNamespace(Client=StubRpcClient))
+sys.modules['zerorpc'].Client = StubRpcClient
+
+from FrankaClient import FrankaClient  # noqa: E402
+
+
+class FrankaClientCloseTest(unittest.TestCase):
+    def test_close_without_streams(self):
+        client = FrankaClient()
+        server = client.server
+        client.close()
+        self.assertTrue(server.closed)
+        self.assertIsNone(client.server)
+
+    def test_close_releases_streams(self):
+        client = FrankaClient(state_port=54243, pose_port=54244, pose_ack_port=54245)
+        subscriber = client.subscribe_state()
+        client.update_desired_ee_pose_oneway([0.3, 0.0, 0.5, 0.0, 0.0, 0.0])
+        sender = client.pose_sender
+        client.close()
+        self.assertIsNone(subscriber.socket)
+        self.assertIsNone(sender.socket)
+        self.assertIsNone(sender.ack_socket)
+        self.assertIsNone(client.pose_sender)
+        self.assertIsNone(client.state_subscriber)
+
+    def test_close_is_idempotent(self):
+        client = FrankaClient()
+        client.update_desired_ee_pose_oneway([0.3, 0.0, 0.5, 0.0, 0.0, 0.0])
+        client.close()
+        client.close()
+        # __del__ runs close() again on collection
+        del client
+
+
+if __name__ == '__main__':
+    unittest.main()
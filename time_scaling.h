@@ -0,0 +1,239 @@
+// Time scalings s(t / T) in [0, 1] for rest-to-rest dance segments, and the per-move timing
+// options of the dance file (interp=, velocity_scale=, dwell_ms=; see dance_config.h). Every
+// scaling starts and ends at rest. Quintic (minimum jerk), septic (minimum snap) and double-S
+// also start and end with zero acceleration, so a segment can follow any other without a
+// command discontinuity; cubic and trapezoid step the acceleration at their ends (and the
+// trapezoid at its blends), which shows up as jerk at the 1 kHz command rate (peakJerk).
+// Polynomials are evaluated in Horner form; the piecewise profiles mirror their first half.
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+enum class TimeScaling { kQuintic, kSeptic, kCubic, kTrapezoid, kDoubleS };
+
+// s(tau) and its derivatives d/dtau, d^2/dtau^2 at normalized time tau = t / T
+struct ScalingSample {
+    double s;
+    double ds;
+    double dds;
+};
+
+// Cubic: zero velocity at both ends, acceleration steps of 6 there
+inline ScalingSample cubicSample(double x) {
+    return {x * x * (3.0 - 2.0 * x), x * (6.0 - 6.0 * x), 6.0 - 12.0 * x};
+}
+
+// Quintic (minimum jerk): zero velocity and acceleration at both ends
+inline ScalingSample quinticSample(double x) {
+    double x2 = x * x;
+    return {x2 * x * (10.0 + x * (-15.0 + 6.0 * x)), x2 * (30.0 + x * (-60.0 + 30.0 * x)),
+            x * (60.0 + x * (-180.0 + 120.0 * x))};
+}
+
+// Septic (minimum snap): also zero jerk at both ends, for a softer start and stop at the cost
+// of a higher peak velocity
+inline ScalingSample septicSample(double x) {
+    double x2 = x * x;
+    return {x2 * x2 * (35.0 + x * (-84.0 + x * (70.0 - 20.0 * x))),
+            x2 * x * (140.0 + x * (-420.0 + x * (420.0 - 140.0 * x))),
+            x2 * (420.0 + x * (-1680.0 + x * (2100.0 - 840.0 * x)))};
+}
+
+// Trapezoidal velocity (linear segments with parabolic blends): constant acceleration for the
+// first and last kTrapezoidBlend of the move, constant velocity in between
+constexpr double kTrapezoidBlend = 1.0 / 3.0;
+constexpr double kTrapezoidVelocity = 1.0 / (1.0 - kTrapezoidBlend);
+constexpr double kTrapezoidAcceleration = kTrapezoidVelocity / kTrapezoidBlend;
+
+// Double-S (jerk-limited trapezoid, seven phases): the acceleration ramps up over kDoubleSJerkTime,
+// holds, and ramps down again by the end of the kDoubleSAccelTime acceleration phase
+constexpr double kDoubleSAccelTime = 1.0 / 3.0;
+constexpr double kDoubleSJerkTime = 1.0 / 12.0;
+constexpr double kDoubleSVelocity = 1.0 / (1.0 - kDoubleSAccelTime);
+constexpr double kDoubleSAcceleration = kDoubleSVelocity / (kDoubleSAccelTime - kDoubleSJerkTime);
+constexpr double kDoubleSJerk = kDoubleSAcceleration / kDoubleSJerkTime;
+
+namespace time_scaling_detail {
+
+// First half of a profile that is point-symmetric about tau = 1/2
+template <typename Half>
+ScalingSample mirrored(double x, Half half) {
+    if (x <= 0.5) return half(x);
+    ScalingSample h = half(1.0 - x);
+    return {1.0 - h.s, h.ds, -h.dds};
+}
+
+inline ScalingSample trapezoidHalf(double x) {
+    constexpr double v = kTrapezoidVelocity, a = kTrapezoidAcceleration, tb = kTrapezoidBlend;
+    if (x < tb) return {0.5 * a * x * x, a * x, a};
+    return {v * (x - 0.5 * tb), v, 0.0};
+}
+
+inline ScalingSample doubleSHalf(double x) {
+    constexpr double v = kDoubleSVelocity, a = kDoubleSAcceleration, j = kDoubleSJerk;
+    constexpr double ta = kDoubleSAccelTime, tj = kDoubleSJerkTime;
+    if (x < tj) return {j / 6.0 * x * x * x, 0.5 * j * x * x, j * x};
+    if (x < ta - tj) {
+        double u = x - tj;
+        return {a * tj * tj / 6.0 + u * (0.5 * a * tj + 0.5 * a * u), a * (0.5 * tj + u), a};
+    }
+    if (x < ta) {
+        // The acceleration phase is point-symmetric about (ta / 2, v / 2)
+        double y = ta - x;
+        return {0.5 * v * ta + y * (-v + j / 6.0 * y * y), v - 0.5 * j * y * y, j * y};
+    }
+    return {v * (x - 0.5 * ta), v, 0.0};
+}
+
+}  // namespace time_scaling_detail
+
+inline ScalingSample trapezoidSample(double x) {
+    return time_scaling_detail::mirrored(x, time_scaling_detail::trapezoidHalf);
+}
+
+inline ScalingSample doubleSSample(double x) {
+    return time_scaling_detail::mirrored(x, time_scaling_detail::doubleSHalf);
+}
+
+// s, ds/dtau and d^2s/dtau^2 of the scaling at tau, clamped to the segment
+inline ScalingSample scalingSample(TimeScaling scaling, double tau) {
+    if (tau <= 0.0) return {0.0, 0.0, 0.0};
+    if (tau >= 1.0) return {1.0, 0.0, 0.0};
+    switch (scaling) {
+        case TimeScaling::kSeptic: return septicSample(tau);
+        case TimeScaling::kCubic: return cubicSample(tau);
+        case TimeScaling::kTrapezoid: return trapezoidSample(tau);
+        case TimeScaling::kDoubleS: return doubleSSample(tau);
+        default: return quinticSample(tau);
+    }
+}
+
+// Helper function for quintic (5th order) path interpolation
+inline double quinticPath(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+
+    double x = t / T;
+    return x * x * x * (10.0 + x * (-15.0 + 6.0 * x));
+}
+
+// Septic (7th order) path, see septicSample
+inline double septicPath(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+
+    double x = t / T;
+    return x * x * x * x * (35.0 + x * (-84.0 + x * (70.0 - 20.0 * x)));
+}
+
+inline double cubicPath(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+
+    double x = t / T;
+    return x * x * (3.0 - 2.0 * x);
+}
+
+inline double trapezoidPath(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+    return trapezoidSample(t / T).s;
+}
+
+inline double doubleSPath(double t, double T) {
+    if (t <= 0) return 0.0;
+    if (t >= T) return 1.0;
+    return doubleSSample(t / T).s;
+}
+
+// Peak |d^k s / d tau^k| of the quintic scaling over tau in [0, 1]; a joint moving delta over T
+// seconds peaks at kQuinticPeakVelocity * delta / T, ... / T^2 and ... / T^3
+constexpr double kQuinticPeakVelocity = 1.875;                  // tau = 1/2
+constexpr double kQuinticPeakAcceleration = 5.773502691896258;  // 10 / sqrt(3), tau = (3 - sqrt(3)) / 6
+constexpr double kQuinticPeakJerk = 60.0;                       // tau = 0 and 1
+
+// The same for the septic scaling
+constexpr double kSepticPeakVelocity = 2.1875;                 // 35 / 16, tau = 1/2
+constexpr double kSepticPeakAcceleration = 7.513188404399293;  // 84 / (5 sqrt(5)), tau = (5 - sqrt(5)) / 10
+constexpr double kSepticPeakJerk = 52.5;                       // tau = 1/2
+
+struct ScalingPeaks {
+    double velocity;
+    double acceleration;
+    double jerk;                      // Within the smooth pieces
+    double acceleration_step = 0.0;   // Largest jump of the acceleration (ends, trapezoid blends)
+};
+
+constexpr ScalingPeaks scalingPeaks(TimeScaling scaling) {
+    switch (scaling) {
+        case TimeScaling::kSeptic:
+            return {kSepticPeakVelocity, kSepticPeakAcceleration, kSepticPeakJerk};
+        case TimeScaling::kCubic:
+            return {1.5, 6.0, 12.0, 6.0};
+        case TimeScaling::kTrapezoid:
+            return {kTrapezoidVelocity, kTrapezoidAcceleration, 0.0, kTrapezoidAcceleration};
+        case TimeScaling::kDoubleS:
+            return {kDoubleSVelocity, kDoubleSAcceleration, kDoubleSJerk};
+        default:
+            return {kQuinticPeakVelocity, kQuinticPeakAcceleration, kQuinticPeakJerk};
+    }
+}
+
+// Peak jerk of a coordinate moving delta over T seconds as commanded at 1 kHz: an acceleration
+// step is spread over one control period
+inline double peakJerk(const ScalingPeaks& peaks, double delta, double T) {
+    constexpr double kControlPeriod = 0.001;
+    return std::max(peaks.jerk * delta / (T * T * T), peaks.acceleration_step * delta / (T * T * kControlPeriod));
+}
+
+using ScalingFunction = double (*)(double t, double T);
+
+inline ScalingFunction scalingFunction(TimeScaling scaling) {
+    switch (scaling) {
+        case TimeScaling::kSeptic: return septicPath;
+        case TimeScaling::kCubic: return cubicPath;
+        case TimeScaling::kTrapezoid: return trapezoidPath;
+        case TimeScaling::kDoubleS: return doubleSPath;
+        default: return quinticPath;
+    }
+}
+
+inline const char* timeScalingName(TimeScaling scaling) {
+    switch (scaling) {
+        case TimeScaling::kSeptic: return "septic";
+        case TimeScaling::kCubic: return "cubic";
+        case TimeScaling::kTrapezoid: return "trapezoid";
+        case TimeScaling::kDoubleS: return "double_s";
+        default: return "quintic";
+    }
+}
+
+constexpr TimeScaling kTimeScalings[] = {TimeScaling::kQuintic, TimeScaling::kSeptic, TimeScaling::kCubic,
+                                         TimeScaling::kTrapezoid, TimeScaling::kDoubleS};
+
+// Parses an interp= value; false for unknown names. min_jerk and min_snap name the quintic and
+// septic, the rest-to-rest minimizers of integrated squared jerk and snap.
+inline bool parseTimeScaling(std::string_view name, TimeScaling& scaling) {
+    if (name == "min_jerk" || name == "min_snap") {
+        scaling = name == "min_jerk" ? TimeScaling::kQuintic : TimeScaling::kSeptic;
+        return true;
+    }
+    for (TimeScaling candidate : kTimeScalings) {
+        if (name == timeScalingName(candidate)) {
+            scaling = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Per-move timing options. A move with velocity_scale k takes 1/k times as long as it would
+// otherwise (its safe duration divided by k), and the robot holds still for `dwell` seconds
+// after it has settled.
+struct MoveTiming {
+    TimeScaling scaling = TimeScaling::kQuintic;
+    double velocity_scale = 1.0;
+    double dwell = 0.0;  // s
+};
@@ -0,0 +1,234 @@
+// Torque-aware retiming of dance segments. The collision reflex compares the robot's external
+// torque estimate (measured torque minus its model torque) with the setCollisionBehavior
+// thresholds, and that estimate is never exact: friction, motor inertia and identification
+// errors grow with the commanded dynamic torque, so a fast move can trip the reflex with
+// nothing in the way. Here the torques along a sampled segment are predicted with
+// panda_dynamics.h and a fraction of the dynamic (non-gravity) torque is taken as the
+// external-torque-equivalent error. Where that would exceed the contact threshold, or the total
+// torque the actuator limit, the time scaling is slowed by a smooth local factor until every
+// tick is within budget; the rest of the segment keeps its timing.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "dance_optimizer.h"
+#include "joint_motion.h"
+#include "panda_dynamics.h"
+#include "panda_limits.h"
+#include "plan_cache.h"
+
+// Torque limits a segment is retimed against
+struct TorqueBudget {
+    double model_error = 0.3;  // Fraction of the dynamic torque that shows up as external torque
+    trajectory::ArmVector external_limit = panda::kJointContactTorque;  // Nm, below the reflex threshold
+    double actuator_scale = 0.9;  // Fraction of kJointTorqueMax allowed for the total torque
+};
+
+struct RetimeResult {
+    double original_duration = 0.0;
+    double duration = 0.0;     // Session length / 1.01 after retiming
+    double peak_before = 0.0;  // Largest predicted torque / budget ratio before and after
+    double peak_after = 0.0;
+    int worst_joint = -1;      // Joint of peak_before (0-based)
+    size_t iterations = 0;
+    bool converged = true;     // False if the budget could not be met (e.g. gravity alone exceeds it)
+};
+
+namespace torque_retiming_detail {
+
+constexpr double kTick = 0.001;
+constexpr size_t kWarpCells = 1000;          // Resolution of the slowdown profile along the path
+constexpr double kWarpHalfWidth = 0.15;      // Half-width of one local stretch, fraction of the path,
+constexpr double kWarpMinHalfWidth = 0.1;    // but at least this many seconds (limits the added jerk)
+constexpr double kStretchOvershoot = 1.02;   // Stretch slightly more than the predicted need
+constexpr size_t kLocalIterations = 12;      // Then the whole segment is slowed uniformly
+constexpr size_t kMaxIterations = 24;
+
+inline const panda::Dynamics<double>& pandaDynamics() {
+    static const panda::Dynamics<double> dynamics;
+    return dynamics;
+}
+
+// Slowdown k(sigma) >= 1 at path time sigma in [0, 1], linear between cell centres
+inline double slowdownAt(const std::vector<double>& slow, double sigma) {
+    double x = sigma * slow.size() - 0.5;
+    if (x <= 0.0) return slow.front();
+    size_t c = static_cast<size_t>(x);
+    if (c + 1 >= slow.size()) return slow.back();
+    return slow[c] + (x - c) * (slow[c + 1] - slow[c]);
+}
+
+// Resamples the plan's path (in its time scaling) of nominal duration T0 with the local slowdown applied,
+// i.e. d sigma / dt = 1 / (T0 k(sigma)) integrated per tick with the midpoint rule; sigmas
+// receives the path time of every sample
+inline void sampleWarped(SegmentPlan& plan, double nominal, const std::vector<double>& slow,
+                         std::vector<double>& sigmas) {
+    plan.samples.clear();
+    plan.progress.clear();
+    sigmas.clear();
+    ScalingFunction scaling = scalingFunction(plan.scaling);
+    auto push = [&](double sigma) {
+        double s = scaling(sigma, 1.0);
+        trajectory::ArmVector q;
+        trajectory::interpolate(plan.q_start, plan.q_target, s, q);
+        plan.samples.push_back(q);
+        plan.progress.push_back(s);
+        sigmas.push_back(sigma);
+    };
+    double sigma = 0.0;
+    push(sigma);
+    while (sigma < 1.0 - 1e-9) {
+        double mid = std::min(1.0, sigma + 0.5 * kTick / (nominal * slowdownAt(slow, sigma)));
+        sigma = std::min(1.0, sigma + kTick / (nominal * slowdownAt(slow, mid)));
+        push(sigma);
+    }
+    // Hold the target through the end of the session, as samplePlan does
+    plan.safe_duration = (plan.samples.size() - 1) * kTick;
+    size_t count = static_cast<size_t>(std::ceil(plan.safe_duration * 1.01 * 1000.0)) + 1;
+    while (plan.samples.size() < count) push(1.0);
+}
+
+}  // namespace torque_retiming_detail
+
+// Ratio of the predicted torques to the budget at every tick of a sampled path (<= 1 is within
+// budget), from central differences of the samples; worst_joint receives the joint of the peak
+inline std::vector<double> torqueBudgetRatios(const std::vector<trajectory::ArmVector>& samples,
+                                              const TorqueBudget& budget, int* worst_joint = nullptr) {
+    using torque_retiming_detail::kTick;
+    const panda::Dynamics<double>& dynamics = torque_retiming_detail::pandaDynamics();
+    std::vector<double> ratios(samples.size(), 0.0);
+    double worst = -1.0;
+    for (size_t k = 1; k + 1 < samples.size(); k++) {
+        const trajectory::ArmVector& q = samples[k];
+        trajectory::ArmVector dq, ddq;
+        for (size_t i = 0; i < panda::kJoints; i++) {
+            dq[i] = (samples[k + 1][i] - samples[k - 1][i]) / (2.0 * kTick);
+            ddq[i] = (samples[k + 1][i] - 2.0 * q[i] + samples[k - 1][i]) / (kTick * kTick);
+        }
+        trajectory::ArmVector dynamic = dynamics.inverseDynamics(q, dq, ddq, false);
+        trajectory::ArmVector gravity = dynamics.gravity(q);
+        for (size_t i = 0; i < panda::kJoints; i++) {
+            double external = budget.model_error * std::abs(dynamic[i]) / budget.external_limit[i];
+            double total = std::abs(dynamic[i] + gravity[i]) / (budget.actuator_scale * panda::kJointTorqueMax[i]);
+            double ratio = std::max(external, total);
+            ratios[k] = std::max(ratios[k], ratio);
+            if (ratio > worst) {
+                worst = ratio;
+                if (worst_joint != nullptr) *worst_joint = static_cast<int>(i);
+            }
+        }
+    }
+    if (samples.size() > 2) {
+        ratios.front() = ratios[1];
+        ratios.back() = ratios[samples.size() - 2];
+    }
+    return ratios;
+}
+
+// Stretches the parts of a sampled plan (as planJointSegment makes it) whose predicted
+// torques exceed the budget, and resamples it. Torques on a path slowed by k scale by 1/k^2, so
+// each offending tick asks for sqrt(ratio) around its path time. The requests are spread over
+// raised-cosine windows and smoothed, so the slowdown and with it the acceleration stay
+// continuous. If local stretching has not converged after kLocalIterations the whole segment is
+// slowed uniformly.
+inline RetimeResult retimeForTorque(SegmentPlan& plan, const TorqueBudget& budget = TorqueBudget()) {
+    using namespace torque_retiming_detail;
+    RetimeResult result;
+    result.original_duration = result.duration = plan.safe_duration;
+    std::vector<double> ratios = torqueBudgetRatios(plan.samples, budget, &result.worst_joint);
+    result.peak_before = result.peak_after = *std::max_element(ratios.begin(), ratios.end());
+    if (result.peak_before <= 1.0 || plan.safe_duration <= 0.0) return result;
+
+    double nominal = plan.safe_duration;
+    std::vector<double> sigmas(plan.samples.size());
+    for (size_t k = 0; k < sigmas.size(); k++) sigmas[k] = std::min(1.0, k * kTick / nominal);
+    std::vector<double> slow(kWarpCells, 1.0), need(kWarpCells), stretch(kWarpCells), smoothed(kWarpCells);
+    double width = std::min(0.5, std::max(kWarpHalfWidth, kWarpMinHalfWidth / nominal));
+    const int half_width = std::max(2, static_cast<int>(width * kWarpCells));
+    // Normalized raised-cosine kernel of half the window width for smoothing the stretch
+    std::vector<double> kernel(half_width + 1);
+    double kernel_sum = 0.0;
+    for (int d = -half_width / 2; d <= half_width / 2; d++) {
+        double w = 0.5 * (1.0 + std::cos(2.0 * M_PI * d / (half_width + 1)));
+        kernel[d + half_width / 2] = w;
+        kernel_sum += w;
+    }
+    for (double& w : kernel) w /= kernel_sum;
+    while (result.peak_after > 1.0 && result.iterations < kMaxIterations) {
+        if (result.iterations < kLocalIterations) {
+            std::fill(need.begin(), need.end(), 1.0);
+            for (size_t k = 0; k < ratios.size(); k++) {
+                if (ratios[k] <= 1.0) continue;
+                size_t c = std::min(kWarpCells - 1, static_cast<size_t>(sigmas[k] * kWarpCells));
+                need[c] = std::max(need[c], std::sqrt(ratios[k]) * kStretchOvershoot);
+            }
+            // log stretch: windows around each request, combined by max, then smoothed so the
+            // slowdown has no kinks where windows cross
+            std::fill(stretch.begin(), stretch.end(), 0.0);
+            for (int c = 0; c < static_cast<int>(kWarpCells); c++) {
+                if (need[c] <= 1.0) continue;
+                int first = std::max(0, c - half_width);
+                int last = std::min(static_cast<int>(kWarpCells) - 1, c + half_width);
+                for (int j = first; j <= last; j++) {
+                    double window = 0.5 * (1.0 + std::cos(M_PI * (j - c) / half_width));
+                    stretch[j] = std::max(stretch[j], std::log(need[c]) * window);
+                }
+            }
+            for (int c = 0; c < static_cast<int>(kWarpCells); c++) {
+                double sum = 0.0;
+                for (int d = -half_width / 2; d <= half_width / 2; d++) {
+                    int j = std::clamp(c + d, 0, static_cast<int>(kWarpCells) - 1);
+                    sum += kernel[d + half_width / 2] * stretch[j];
+                }
+                smoothed[c] = sum;
+            }
+            for (size_t c = 0; c < kWarpCells; c++) slow[c] *= std::exp(smoothed[c]);
+        } else {
+            for (double& k : slow) k *= std::sqrt(result.peak_after) * kStretchOvershoot;
+        }
+        sampleWarped(plan, nominal, slow, sigmas);
+        ratios = torqueBudgetRatios(plan.samples, budget);
+        result.peak_after = *std::max_element(ratios.begin(), ratios.end());
+        result.iterations++;
+    }
+    result.duration = plan.safe_duration;
+    result.converged = result.peak_after <= 1.0;
+    return result;
+}
+
+// Plan cache planner: planJointSegment, then retimeForTorque; stretched segments are logged
+inline PlanCache::Planner torqueAwarePlanner(const TorqueBudget& budget = TorqueBudget()) {
+    return [budget](const trajectory::ArmVector& q_start, const trajectory::ArmVector& q_target,
+                    double desired_duration, const MoveTiming& timing) {
+        std::shared_ptr<SegmentPlan> plan = planJointSegment(q_start, q_target, desired_duration, timing);
+        RetimeResult result = retimeForTorque(*plan, budget);
+        if (result.duration > result.original_duration) {
+            std::cout << "Torque retiming: " << result.original_duration << "s -> " << result.duration
+                      << "s (predicted peak " << std::round(100.0 * result.peak_before) << "% of the torque budget on joint "
+                      << result.worst_joint + 1 << (result.converged ? ")" : ", budget NOT met)") << std::endl;
+        }
+        return plan;
+    };
+}
+
+// Feasibility check (dance_optimizer.h) for the optimizer: the segment, played in `timing`'s
+// time scaling at duration / velocity_scale as the runner plays it, stays within the torque
+// budget without retiming. Thread-safe, so it can be used for SegmentCostMatrix.
+inline FeasibilityCheck torqueBudgetCheck(const TorqueBudget& budget = TorqueBudget(),
+                                          const MoveTiming& timing = MoveTiming()) {
+    return [budget, timing](const trajectory::ArmVector& q_start, const trajectory::ArmVector& q_end,
+                            double duration) {
+        SegmentPlan plan;
+        plan.q_start = q_start;
+        plan.q_target = q_end;
+        plan.desired_duration = plan.safe_duration = duration / timing.velocity_scale;
+        plan.scaling = timing.scaling;
+        samplePlan(plan, scalingFunction(timing.scaling));
+        std::vector<double> ratios = torqueBudgetRatios(plan.samples, budget);
+        return *std::max_element(ratios.begin(), ratios.end()) <= 1.0;
+    };
+}
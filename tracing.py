@@ -0,0 +1,113 @@
+"""
+End-to-end latency tracing for AR teleop targets.
+
+Each target carries its timestamps through the pipeline (AR sample arrival in
+mujocoar_teleop.py, client send, server receive, Polymetis call start/return,
+and with upsampling the first 1 kHz output tick that uses it). The server turns
+them into per-stage deltas, records each into a histogram, and keeps recent
+spans that can be exported as a Chrome/Perfetto trace (chrome://tracing or
+ui.perfetto.dev). Timestamps come from different processes, so client and
+server clocks must agree (same host, or chrony/PTP synchronized).
+"""
+
+import json
+import math
+import threading
+from collections import deque
+
+# Pipeline stages in order; a target's spans are laid out on one track per stage
+STAGES = ('ar_to_send', 'network', 'queue', 'apply', 'interp_wait', 'ar_to_robot')
+
+
+class LatencyHistogram:
+    """Log-bucketed latency histogram (10 us .. 10 s, 20 buckets per decade)."""
+
+    MIN_VALUE = 1e-5
+    BUCKETS_PER_DECADE = 20
+    NUM_BUCKETS = 6 * BUCKETS_PER_DECADE + 2  # underflow + 6 decades + overflow
+
+    def __init__(self):
+        self.counts = [0] * self.NUM_BUCKETS
+        self.total = 0
+        self.sum = 0.0
+        self.max = 0.0
+
+    def _bucket(self, value):
+        if value < self.MIN_VALUE:
+            return 0
+        index = int(math.log10(value / self.MIN_VALUE) * self.BUCKETS_PER_DECADE) + 1
+        return min(index, self.NUM_BUCKETS - 1)
+
+    def _bucket_upper(self, index):
+        return self.MIN_VALUE * 10 ** (index / self.BUCKETS_PER_DECADE)
+
+    def record(self, value):
+        self.counts[self._bucket(value)] += 1
+        self.total += 1
+        self.sum += value
+        if value > self.max:
+            self.max = value
+
+    def percentile(self, p):
+        """Upper bound of the bucket holding the p-th percentile (seconds)."""
+        if self.total == 0:
+            return 0.0
+        target = p / 100.0 * self.total
+        running = 0
+        for index, count in enumerate(self.counts):
+            running += count
+            if running >= target:
+                return min(self._bucket_upper(index), self.max)
+        return self.max
+
+    def summary(self):
+        return {
+            'count': self.total,
+            'mean_ms': self.sum / self.total * 1000 if self.total else 0.0,
+            'p50_ms': self.percentile(50) * 1000,
+            'p95_ms': self.percentile(95) * 1000,
+            'p99_ms': self.percentile(99) * 1000,
+            'max_ms': self.max * 1000,
+        }
+
+
+class LatencyTracer:
+    """Thread-safe per-stage histograms plus a bounded ring of recent spans."""
+
+    def __init__(self, max_spans=200000):
+        self.lock = threading.Lock()
+        self.histograms = {stage: LatencyHistogram() for stage in STAGES}
+        self.spans = deque(maxlen=max_spans)
+
+    def record(self, stage, start, end, seq):
+        """Record one stage of target `seq` from wall-clock `start` to `end` (seconds)."""
+        duration = end - start
+        with self.lock:
+            self.histograms[stage].record(max(duration, 0.0))
+            self.spans.append((stage, start, duration, seq))
+
+    def summary(self):
+        with self.lock:
+            return {stage: h.summary() for stage, h in self.histograms.items() if h.total > 0}
+
+    def print_summary(self):
+        print(f"{'stage':>12} | {'count':>7} | {'mean ms':>8} | {'p50 ms':>7} | {'p95 ms':>7} | "
+              f"{'p99 ms':>7} | {'max ms':>7}")
+        print("-" * 74)
+        for stage, s in self.summary().items():
+            print(f"{stage:>12} | {s['count']:>7} | {s['mean_ms']:>8.3f} | {s['p50_ms']:>7.3f} | "
+                  f"{s['p95_ms']:>7.3f} | {s['p99_ms']:>7.3f} | {s['max_ms']:>7.3f}")
+
+    def export_chrome_trace(self, path):
+        """Write recent spans as Chrome trace event JSON; returns the number of spans written."""
+        with self.lock:
+            spans = list(self.spans)
+        events = [{'name': 'thread_name', 'ph': 'M', 'pid': 1, 'tid': tid,
+                   'args': {'name': stage}} for tid, stage in enumerate(STAGES)]
+        tids = {stage: tid for tid, stage in enumerate(STAGES)}
+        for stage, start, duration, seq in spans:
+            events.append({'name': stage, 'cat': 'teleop', 'ph': 'X', 'pid': 1, 'tid': tids[stage],
+                           'ts': start * 1e6, 'dur': max(duration, 0.0) * 1e6, 'args': {'seq': seq}})
+        with open(path, 'w') as f:
+            json.dump({'traceEvents': events, 'displayTimeUnit': 'ms'}, f)
+        return len(spans)
@@ -0,0 +1,238 @@
+// Batch evaluation of straight joint segments for offline validation, optimization and dense
+// precompilation: position, velocity and acceleration of many segments at a common set of
+// sample times, in one time scaling (time_scaling.h). Segments are stored structure-of-arrays,
+// 8 lanes each (the 7 joints and a zero padding lane), so one sample of one segment is two
+// 4-wide AVX2 registers. The AVX2/FMA kernel is compiled with a target attribute and selected
+// at runtime with __builtin_cpu_supports, so the tools need no -march flag and fall back to the
+// scalar kernel on CPUs (or architectures) without it.
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+#include "time_scaling.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TRAJECTORY_BATCH_AVX2 1
+#else
+#define TRAJECTORY_BATCH_AVX2 0
+#endif
+
+// One value per joint, padded to 8 lanes and aligned for vector loads
+struct alignas(64) JointLanes {
+    double lane[8];
+};
+
+// Straight segments q_start -> q_target over their durations, structure-of-arrays
+struct SegmentBatch {
+    std::vector<JointLanes> start;
+    std::vector<JointLanes> delta;
+    std::vector<double> inv_duration;
+
+    void add(const std::array<double, 7>& q_start, const std::array<double, 7>& q_target, double duration) {
+        JointLanes s{}, d{};
+        for (size_t i = 0; i < 7; i++) {
+            s.lane[i] = q_start[i];
+            d.lane[i] = q_target[i] - q_start[i];
+        }
+        start.push_back(s);
+        delta.push_back(d);
+        inv_duration.push_back(1.0 / duration);
+    }
+
+    size_t size() const { return inv_duration.size(); }
+};
+
+// Joint positions, velocities and accelerations, [segment][sample] row-major. Leave dq and ddq
+// empty to evaluate positions only.
+struct BatchSamples {
+    std::vector<JointLanes> q;
+    std::vector<JointLanes> dq;
+    std::vector<JointLanes> ddq;
+
+    void resize(size_t segments, size_t samples, bool derivatives = true) {
+        q.resize(segments * samples);
+        dq.resize(derivatives ? segments * samples : 0);
+        ddq.resize(derivatives ? segments * samples : 0);
+    }
+};
+
+// Evaluates segments [first, first + count) of batch at the times t[0..samples) (s since each
+// segment's start; past its duration a segment holds its target) into out, which must be sized
+// for count x samples
+using BatchKernel = void (*)(const SegmentBatch& batch, size_t first, size_t count, TimeScaling scaling,
+                             const double* t, size_t samples, BatchSamples& out);
+
+namespace trajectory_batch_detail {
+
+// Scaling value and (with derivatives) its time derivatives of one segment at every sample
+// time, written to the three scratch rows
+inline void scalingRows(TimeScaling scaling, double inv_duration, const double* t, size_t samples, bool derivatives,
+                        double* s, double* ds, double* dds) {
+    if (!derivatives) {
+        ScalingFunction path = scalingFunction(scaling);
+        for (size_t k = 0; k < samples; k++) s[k] = path(t[k] * inv_duration, 1.0);
+        return;
+    }
+    for (size_t k = 0; k < samples; k++) {
+        ScalingSample sample = scalingSample(scaling, t[k] * inv_duration);
+        s[k] = sample.s;
+        ds[k] = sample.ds * inv_duration;
+        dds[k] = sample.dds * inv_duration * inv_duration;
+    }
+}
+
+#if TRAJECTORY_BATCH_AVX2
+
+// x^shift (c[0] x^(n-1) + ... + c[n-1]), the expanded Horner form of a time_scaling.h polynomial
+struct Polynomial {
+    int shift;
+    int n;
+    double c[4];
+};
+
+// s, ds and dds of the polynomial scalings; false for the piecewise ones
+inline bool scalingPolynomials(TimeScaling scaling, Polynomial (&p)[3]) {
+    switch (scaling) {
+        case TimeScaling::kQuintic:
+            p[0] = {3, 3, {6.0, -15.0, 10.0}};
+            p[1] = {2, 3, {30.0, -60.0, 30.0}};
+            p[2] = {1, 3, {120.0, -180.0, 60.0}};
+            return true;
+        case TimeScaling::kSeptic:
+            p[0] = {4, 4, {-20.0, 70.0, -84.0, 35.0}};
+            p[1] = {3, 4, {-140.0, 420.0, -420.0, 140.0}};
+            p[2] = {2, 4, {-840.0, 2100.0, -1680.0, 420.0}};
+            return true;
+        case TimeScaling::kCubic:
+            p[0] = {2, 2, {-2.0, 3.0}};
+            p[1] = {1, 2, {-6.0, 6.0}};
+            p[2] = {0, 2, {-12.0, 6.0}};
+            return true;
+        default:
+            return false;
+    }
+}
+
+__attribute__((target("avx2,fma"))) inline __m256d evaluatePolynomial(const Polynomial& p, __m256d x) {
+    __m256d r = _mm256_set1_pd(p.c[0]);
+    for (int i = 1; i < p.n; i++) r = _mm256_fmadd_pd(r, x, _mm256_set1_pd(p.c[i]));
+    for (int i = 0; i < p.shift; i++) r = _mm256_mul_pd(r, x);
+    return r;
+}
+
+// scalingRows for a polynomial scaling p (see scalingPolynomials), four samples per iteration
+__attribute__((target("avx2,fma"))) inline void polynomialRows(TimeScaling scaling, const Polynomial (&p)[3],
+                                                                 double inv_duration, const double* t, size_t samples,
+                                                                 bool derivatives, double* s, double* ds, double* dds) {
+    const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+    const __m256d inv = _mm256_set1_pd(inv_duration), inv2 = _mm256_set1_pd(inv_duration * inv_duration);
+    size_t k = 0;
+    for (; k + 4 <= samples; k += 4) {
+        __m256d tau = _mm256_mul_pd(_mm256_loadu_pd(t + k), inv);
+        // Outside the segment: s clamps to 0 or 1 and the derivatives are zero, as in scalingSample
+        __m256d inside = _mm256_and_pd(_mm256_cmp_pd(tau, zero, _CMP_GT_OQ), _mm256_cmp_pd(tau, one, _CMP_LT_OQ));
+        __m256d x = _mm256_min_pd(_mm256_max_pd(tau, zero), one);
+        __m256d end = _mm256_and_pd(_mm256_cmp_pd(tau, one, _CMP_GE_OQ), one);
+        _mm256_storeu_pd(s + k, _mm256_blendv_pd(end, evaluatePolynomial(p[0], x), inside));
+        if (!derivatives) continue;
+        _mm256_storeu_pd(ds + k, _mm256_and_pd(_mm256_mul_pd(evaluatePolynomial(p[1], x), inv), inside));
+        _mm256_storeu_pd(dds + k, _mm256_and_pd(_mm256_mul_pd(evaluatePolynomial(p[2], x), inv2), inside));
+    }
+    scalingRows(scaling, inv_duration, t + k, samples - k, derivatives, s + k, ds + k, dds + k);
+}
+
+#endif
+
+}  // namespace trajectory_batch_detail
+
+// Portable kernel
+inline void evaluateBatchScalar(const SegmentBatch& batch, size_t first, size_t count, TimeScaling scaling,
+                                const double* t, size_t samples, BatchSamples& out) {
+    std::vector<double> rows(3 * samples);
+    double *s = rows.data(), *ds = s + samples, *dds = ds + samples;
+    bool derivatives = !out.dq.empty();
+    for (size_t g = 0; g < count; g++) {
+        const JointLanes& start = batch.start[first + g];
+        const JointLanes& delta = batch.delta[first + g];
+        trajectory_batch_detail::scalingRows(scaling, batch.inv_duration[first + g], t, samples, derivatives, s, ds,
+                                             dds);
+        for (size_t k = 0; k < samples; k++) {
+            size_t row = g * samples + k;
+            for (size_t i = 0; i < 8; i++) out.q[row].lane[i] = start.lane[i] + s[k] * delta.lane[i];
+            if (!derivatives) continue;
+            for (size_t i = 0; i < 8; i++) out.dq[row].lane[i] = ds[k] * delta.lane[i];
+            for (size_t i = 0; i < 8; i++) out.ddq[row].lane[i] = dds[k] * delta.lane[i];
+        }
+    }
+}
+
+#if TRAJECTORY_BATCH_AVX2
+
+// AVX2/FMA kernel: the polynomial scalings are evaluated four samples at a time, then every
+// sample is two fused multiply-adds (positions) and four multiplies (derivatives) per segment
+__attribute__((target("avx2,fma"))) inline void evaluateBatchAvx2(const SegmentBatch& batch, size_t first,
+                                                                    size_t count, TimeScaling scaling,
+                                                                    const double* t, size_t samples,
+                                                                    BatchSamples& out) {
+    using namespace trajectory_batch_detail;
+    std::vector<double> rows(3 * samples);
+    double *s = rows.data(), *ds = s + samples, *dds = ds + samples;
+    Polynomial polynomials[3]{};
+    bool polynomial = scalingPolynomials(scaling, polynomials);
+    bool derivatives = !out.dq.empty();
+    for (size_t g = 0; g < count; g++) {
+        const double* start = batch.start[first + g].lane;
+        const double* delta = batch.delta[first + g].lane;
+        double inv_duration = batch.inv_duration[first + g];
+        if (polynomial) {
+            polynomialRows(scaling, polynomials, inv_duration, t, samples, derivatives, s, ds, dds);
+        } else {
+            scalingRows(scaling, inv_duration, t, samples, derivatives, s, ds, dds);
+        }
+        const __m256d start_lo = _mm256_load_pd(start), start_hi = _mm256_load_pd(start + 4);
+        const __m256d delta_lo = _mm256_load_pd(delta), delta_hi = _mm256_load_pd(delta + 4);
+        JointLanes* q = out.q.data() + g * samples;
+        for (size_t k = 0; k < samples; k++) {
+            __m256d sk = _mm256_broadcast_sd(s + k);
+            _mm256_store_pd(q[k].lane, _mm256_fmadd_pd(sk, delta_lo, start_lo));
+            _mm256_store_pd(q[k].lane + 4, _mm256_fmadd_pd(sk, delta_hi, start_hi));
+        }
+        if (!derivatives) continue;
+        JointLanes* dq = out.dq.data() + g * samples;
+        JointLanes* ddq = out.ddq.data() + g * samples;
+        for (size_t k = 0; k < samples; k++) {
+            __m256d dsk = _mm256_broadcast_sd(ds + k), ddsk = _mm256_broadcast_sd(dds + k);
+            _mm256_store_pd(dq[k].lane, _mm256_mul_pd(dsk, delta_lo));
+            _mm256_store_pd(dq[k].lane + 4, _mm256_mul_pd(dsk, delta_hi));
+            _mm256_store_pd(ddq[k].lane, _mm256_mul_pd(ddsk, delta_lo));
+            _mm256_store_pd(ddq[k].lane + 4, _mm256_mul_pd(ddsk, delta_hi));
+        }
+    }
+}
+
+#endif
+
+// The kernel for this CPU: AVX2/FMA where available, scalar otherwise
+inline BatchKernel selectBatchKernel() {
+#if TRAJECTORY_BATCH_AVX2
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return evaluateBatchAvx2;
+#endif
+    return evaluateBatchScalar;
+}
+
+inline const char* batchKernelName(BatchKernel kernel) {
+#if TRAJECTORY_BATCH_AVX2
+    if (kernel == evaluateBatchAvx2) return "avx2+fma";
+#endif
+    return kernel == evaluateBatchScalar ? "scalar" : "unknown";
+}
+
+// Evaluates with the kernel selected once per process (see BatchKernel for the arguments)
+inline void evaluateBatch(const SegmentBatch& batch, size_t first, size_t count, TimeScaling scaling,
+                          const double* t, size_t samples, BatchSamples& out) {
+    static const BatchKernel kernel = selectBatchKernel();
+    kernel(batch, first, count, scaling, t, samples, out);
+}
@@ -0,0 +1,215 @@
+// Trajectory and limit core shared by the joint-space tools, templated on the number of
+// degrees of freedom and the scalar type (double, or float where memory bandwidth matters more
+// than the last digits). The limit tables are constexpr, so with DOF fixed at compile time the
+// per-joint loops unroll and the limits fold into the code. Tables are provided for the 7-DOF
+// arm, the gripper width (1 DOF) and the arm with both fingers (9 DOF, as in the MuJoCo and
+// franka_description models), so a combined arm and gripper dance goes through the same code.
+// The runner's sampled segment plans (plan_cache.h) are SegmentPlan<panda::kJoints>.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "panda_limits.h"
+#include "time_scaling.h"
+
+namespace trajectory {
+
+template <size_t DOF, typename Scalar = double>
+using Vector = std::array<Scalar, DOF>;
+
+// Per-coordinate limits (rad or m, and their time derivatives)
+template <size_t DOF>
+struct Limits {
+    std::array<double, DOF> position_min;
+    std::array<double, DOF> position_max;
+    std::array<double, DOF> velocity;
+    std::array<double, DOF> acceleration;
+    std::array<double, DOF> jerk;
+};
+
+template <size_t DOF>
+constexpr std::array<double, DOF> uniform(double value) {
+    std::array<double, DOF> values{};
+    for (size_t i = 0; i < DOF; i++) values[i] = value;
+    return values;
+}
+
+template <size_t A, size_t B, typename Scalar>
+constexpr Vector<A + B, Scalar> concat(const Vector<A, Scalar>& a, const Vector<B, Scalar>& b) {
+    Vector<A + B, Scalar> joined{};
+    for (size_t i = 0; i < A; i++) joined[i] = a[i];
+    for (size_t i = 0; i < B; i++) joined[A + i] = b[i];
+    return joined;
+}
+
+// Limits of a combined system, a's coordinates first
+template <size_t A, size_t B>
+constexpr Limits<A + B> concat(const Limits<A>& a, const Limits<B>& b) {
+    return {concat(a.position_min, b.position_min), concat(a.position_max, b.position_max),
+            concat(a.velocity, b.velocity), concat(a.acceleration, b.acceleration), concat(a.jerk, b.jerk)};
+}
+
+// Limits with velocity, acceleration and jerk scaled by `scale` (e.g. 0.9 for a 10% safety margin)
+template <size_t DOF>
+constexpr Limits<DOF> scaled(const Limits<DOF>& limits, double scale) {
+    Limits<DOF> result = limits;
+    for (size_t i = 0; i < DOF; i++) {
+        result.velocity[i] *= scale;
+        result.acceleration[i] *= scale;
+        result.jerk[i] *= scale;
+    }
+    return result;
+}
+
+constexpr Limits<panda::kJoints> kPandaArm{panda::kJointPositionMin, panda::kJointPositionMax,
+                                            panda::kJointVelocityMax, panda::kJointAccelerationMax,
+                                            panda::kJointJerkMax};
+
+// One finger of the Franka Hand (m): stroke and speed of franka_description's hand model. The
+// hand publishes no acceleration or jerk limits; these are conservative planning values.
+constexpr Limits<1> kPandaFinger{{{0.0}}, {{0.04}}, {{0.2}}, {{1.0}}, {{100.0}}};
+
+// Gripper opening width: both fingers moving symmetrically, so twice the finger's limits
+constexpr Limits<1> kPandaGripper{{{0.0}}, {{0.08}}, {{0.4}}, {{2.0}}, {{200.0}}};
+
+constexpr Limits<panda::kJoints + 2> kPandaArmWithFingers = concat(kPandaArm, concat(kPandaFinger, kPandaFinger));
+
+// Joint vector of the arm
+using ArmVector = Vector<panda::kJoints>;
+
+static_assert(kPandaArmWithFingers.velocity[6] == panda::kJointVelocityMax[6], "arm coordinates come first");
+static_assert(kPandaArmWithFingers.position_max[8] == kPandaFinger.position_max[0], "fingers follow the arm");
+static_assert(kPandaGripper.velocity[0] == 2.0 * kPandaFinger.velocity[0], "width moves with both fingers");
+
+// Shortest duration for q_start -> q_end with coordinate i moving at no more than speed[i] on
+// average; critical receives the index that needs it, or -1 if nothing moves
+template <size_t DOF, typename Scalar>
+Scalar minTravelTime(const Vector<DOF, Scalar>& q_start, const Vector<DOF, Scalar>& q_end,
+                     const std::array<double, DOF>& speed, int* critical = nullptr) {
+    Scalar time = 0;
+    int index = -1;
+    for (size_t i = 0; i < DOF; i++) {
+        Scalar t = std::abs(q_end[i] - q_start[i]) / static_cast<Scalar>(speed[i]);
+        if (t > time) {
+            time = t;
+            index = static_cast<int>(i);
+        }
+    }
+    if (critical != nullptr) *critical = index;
+    return time;
+}
+
+// out = q_start + s (q_end - q_start)
+template <size_t DOF, typename Scalar>
+void interpolate(const Vector<DOF, Scalar>& q_start, const Vector<DOF, Scalar>& q_end, Scalar s,
+                 Vector<DOF, Scalar>& out) {
+    for (size_t i = 0; i < DOF; i++) out[i] = q_start[i] + s * (q_end[i] - q_start[i]);
+}
+
+template <size_t DOF, typename Scalar>
+Scalar maxAbsDifference(const Vector<DOF, Scalar>& a, const Vector<DOF, Scalar>& b) {
+    Scalar result = 0;
+    for (size_t i = 0; i < DOF; i++) result = std::max(result, std::abs(a[i] - b[i]));
+    return result;
+}
+
+// Peak velocity, acceleration and jerk of every coordinate on a straight segment over T seconds
+// in a time scaling with the given peak factors (see peakJerk for the jerk)
+template <size_t DOF, typename Scalar>
+struct SegmentPeaks {
+    Vector<DOF, Scalar> velocity;
+    Vector<DOF, Scalar> acceleration;
+    Vector<DOF, Scalar> jerk;
+};
+
+template <size_t DOF, typename Scalar>
+SegmentPeaks<DOF, Scalar> segmentPeaks(const Vector<DOF, Scalar>& q_start, const Vector<DOF, Scalar>& q_end,
+                                       Scalar T, const ScalingPeaks& peaks) {
+    SegmentPeaks<DOF, Scalar> result;
+    for (size_t i = 0; i < DOF; i++) {
+        Scalar delta = std::abs(q_end[i] - q_start[i]);
+        result.velocity[i] = static_cast<Scalar>(peaks.velocity) * delta / T;
+        result.acceleration[i] = static_cast<Scalar>(peaks.acceleration) * delta / (T * T);
+        result.jerk[i] = static_cast<Scalar>(peakJerk(peaks, delta, T));
+    }
+    return result;
+}
+
+// Shortest duration of a straight segment within the limits, and what determines it
+template <typename Scalar>
+struct TimeBound {
+    Scalar duration = 0;
+    int derivative = 0;  // 1 velocity, 2 acceleration, 3 jerk; 0 if nothing moves
+    int joint = -1;
+};
+
+// Peaks scale as delta/T, delta/T^2 and delta/T^3 (an acceleration step's jerk as delta/T^2,
+// see peakJerk), so each limit gives a closed-form bound
+template <size_t DOF, typename Scalar>
+TimeBound<Scalar> minScaledTime(const Vector<DOF, Scalar>& q_start, const Vector<DOF, Scalar>& q_end,
+                                const Limits<DOF>& limits, const ScalingPeaks& peaks) {
+    TimeBound<Scalar> bound;
+    auto consider = [&](Scalar duration, int derivative, size_t joint) {
+        if (duration > bound.duration) {
+            bound.duration = duration;
+            bound.derivative = derivative;
+            bound.joint = static_cast<int>(joint);
+        }
+    };
+    for (size_t i = 0; i < DOF; i++) {
+        Scalar delta = std::abs(q_end[i] - q_start[i]);
+        if (delta == 0) continue;
+        consider(static_cast<Scalar>(peaks.velocity / limits.velocity[i]) * delta, 1, i);
+        consider(std::sqrt(static_cast<Scalar>(peaks.acceleration / limits.acceleration[i]) * delta), 2, i);
+        consider(std::cbrt(static_cast<Scalar>(peaks.jerk / limits.jerk[i]) * delta), 3, i);
+        // An acceleration step is commanded as jerk over one 1 ms tick
+        consider(std::sqrt(static_cast<Scalar>(peaks.acceleration_step * 1000.0 / limits.jerk[i]) * delta), 3, i);
+    }
+    return bound;
+}
+
+// A planned straight segment: the durations plus the path sampled every control tick (1 ms)
+template <size_t DOF, typename Scalar = double>
+struct SegmentPlan {
+    Vector<DOF, Scalar> q_start{};
+    Vector<DOF, Scalar> q_target{};
+    double desired_duration = 0.0;
+    double safe_duration = 0.0;                   // Session ends at 1.01 x safe_duration
+    TimeScaling scaling = TimeScaling::kQuintic;
+    std::vector<Vector<DOF, Scalar>> samples;     // Path at t = k ms
+    std::vector<Scalar> progress;                 // Path parameter in [0, 1] at t = k ms
+};
+
+// Samples a straight path with time scaling `scaling(t, T)` in [0, 1] at 1 kHz, through the
+// end of the session (1.01 x safe_duration)
+template <size_t DOF, typename Scalar, typename Scaling>
+void samplePlan(SegmentPlan<DOF, Scalar>& plan, Scaling&& scaling) {
+    size_t count = static_cast<size_t>(std::ceil(plan.safe_duration * 1.01 * 1000.0)) + 1;
+    plan.samples.resize(count);
+    plan.progress.resize(count);
+    for (size_t k = 0; k < count; k++) {
+        Scalar s = static_cast<Scalar>(scaling(k / 1000.0, plan.safe_duration));
+        plan.progress[k] = s;
+        interpolate(plan.q_start, plan.q_target, s, plan.samples[k]);
+    }
+}
+
+// Smallest distance of q to its position limits; joint receives the coordinate
+template <size_t DOF, typename Scalar>
+Scalar limitMargin(const Vector<DOF, Scalar>& q, const Limits<DOF>& limits, int* joint = nullptr) {
+    Scalar margin = INFINITY;
+    for (size_t i = 0; i < DOF; i++) {
+        Scalar m = std::min(q[i] - static_cast<Scalar>(limits.position_min[i]),
+                            static_cast<Scalar>(limits.position_max[i]) - q[i]);
+        if (m < margin) {
+            margin = m;
+            if (joint != nullptr) *joint = static_cast<int>(i);
+        }
+    }
+    return margin;
+}
+
+}  // namespace trajectory
@@ -0,0 +1,108 @@
+"""
+Server-side upsampling of sparse AR pose targets.
+
+The phone delivers poses at ARKit rate (~60 Hz). Instead of the client re-sending
+the latest sample at the control rate, it sends each AR sample once with its
+timestamp; the server feeds them into the native PoseInterpolator and drives the
+impedance target from a fixed-rate (1 kHz) loop.
+"""
+
+import threading
+import time
+from collections import deque
+from scipy.spatial.transform import Rotation as R
+from franka_ar_native import PoseInterpolator
+
+
+class TargetUpsampler:
+    def __init__(self, apply_pose, rate=1000, playout_delay=0.02, max_extrapolation=0.05,
+                 max_extrapolation_distance=0.03, offset_window=2.0, tracer=None):
+        # apply_pose(position, quat_xyzw) is called at `rate` Hz once targets arrive
+        self.apply_pose = apply_pose
+        self.period = 1.0 / rate
+        self.playout_delay = playout_delay
+        self.offset_window = offset_window
+        self.interpolator = PoseInterpolator(max_extrapolation, max_extrapolation_distance)
+
+        # Optional tracing.LatencyTracer: records when the first output tick uses each target
+        self.tracer = tracer
+        self._pending_traces = deque()
+
+        # Sliding minimum of (receive time - sample stamp): maps client stamps onto the
+        # server clock, absorbing clock offset plus the minimum network delay.
+        self._offsets = deque()
+        self.offset = None
+
+        self.running = False
+        self.thread = None
+        self.pushed = 0
+        self.rejected = 0
+        self.overruns = 0
+        self.status_counts = {PoseInterpolator.INTERPOLATED: 0,
+                              PoseInterpolator.EXTRAPOLATED: 0,
+                              PoseInterpolator.HELD: 0}
+
+    def _update_offset(self, now, offset):
+        # Monotonic deque: front is always the minimum inside the window
+        while self._offsets and self._offsets[-1][1] >= offset:
+            self._offsets.pop()
+        self._offsets.append((now, offset))
+        while self._offsets[0][0] < now - self.offset_window:
+            self._offsets.popleft()
+        self.offset = self._offsets[0][1]
+
+    def push(self, pose, stamp, seq=None):
+        """Add a sparse target: pose = [x, y, z, rx, ry, rz], stamp = client sample time."""
+        now = time.time()
+        self._update_offset(now, now - stamp)
+        quat = R.from_rotvec(pose[3:]).as_quat()
+        if self.interpolator.push(stamp + self.offset, pose[:3], quat):
+            self.pushed += 1
+            if self.tracer is not None:
+                # (server time the reference reaches this target, push time, sample stamp, seq)
+                self._pending_traces.append((stamp + self.offset, now, stamp, seq))
+        else:
+            self.rejected += 1
+
+    def start(self):
+        if self.running:
+            return
+        self.running = True
+        self.thread = threading.Thread(target=self._run, daemon=True)
+        self.thread.start()
+
+    def stop(self):
+        self.running = False
+        if self.thread:
+            self.thread.join()
+            self.thread = None
+
+    def _trace_ticks(self, eval_time):
+        """Record targets whose time the reference has just reached (first tick using them)."""
+        tick = time.time()
+        while self._pending_traces and self._pending_traces[0][0] <= eval_time:
+            _, pushed, stamp, seq = self._pending_traces.popleft()
+            self.tracer.record('interp_wait', pushed, tick, seq)
+            self.tracer.record('ar_to_robot', stamp, tick, seq)
+
+    def _run(self):
+        next_deadline = time.perf_counter()
+        while self.running:
+            eval_time = time.time() - self.playout_delay
+            status, pose = self.interpolator.sample(eval_time)
+            if status != PoseInterpolator.EMPTY:
+                self.status_counts[status] += 1
+                try:
+                    self.apply_pose(pose[:3], pose[3:])
+                except Exception as e:
+                    print(f"Upsampler apply error: {e}")
+                if self.tracer is not None:
+                    self._trace_ticks(eval_time)
+
+            next_deadline += self.period
+            delay = next_deadline - time.perf_counter()
+            if delay > 0:
+                time.sleep(delay)
+            else:
+                self.overruns += 1
+                next_deadline = time.perf_counter()
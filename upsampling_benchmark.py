@@ -0,0 +1,111 @@
+#!/usr/bin/env python3
+"""
+Offline comparison of the two ways of feeding sparse AR poses to the robot:
+  - hold:      client re-sends the latest AR sample at CONTROL_FREQUENCY (current behaviour)
+  - upsample:  client sends each AR sample once, server interpolates to 1 kHz
+A synthetic phone trajectory is sampled at ARKit rate with timestamp jitter and
+network delay, and the 1 kHz reference seen by the robot is compared against the
+ground truth for tracking error and smoothness (RMS jerk).
+"""
+
+import argparse
+import time
+import numpy as np
+from scipy.spatial.transform import Rotation as R
+import config
+from franka_ar_native import PoseInterpolator
+
+
+def ground_truth(t):
+    """Smooth hand-like motion: position (m) and rotation vector (rad)."""
+    pos = np.stack([0.05 * np.sin(1.3 * t), 0.12 * np.sin(0.9 * t + 0.4), 0.08 * np.sin(1.7 * t)], axis=-1)
+    rot = np.stack([0.3 * np.sin(0.8 * t), 0.2 * np.sin(1.1 * t + 1.0), 0.25 * np.sin(0.6 * t)], axis=-1)
+    return pos, rot
+
+
+def simulate(duration, ar_rate, jitter, delay, delay_jitter, seed):
+    rng = np.random.default_rng(seed)
+    n = int(duration * ar_rate)
+    sample_t = np.arange(n) / ar_rate + rng.uniform(-jitter, jitter, n)
+    sample_t.sort()
+    arrive_t = sample_t + delay + rng.uniform(0, delay_jitter, n)
+    arrive_t = np.maximum.accumulate(arrive_t)
+    pos, rot = ground_truth(sample_t)
+    return sample_t, arrive_t, pos, rot
+
+
+def reference_hold(sample_t, arrive_t, pos, control_rate, robot_t):
+    """Robot-side reference when the client re-sends the latest sample at control_rate."""
+    send_t = np.arange(robot_t[0], robot_t[-1], 1.0 / control_rate)
+    idx = np.searchsorted(arrive_t, send_t, side='right') - 1
+    valid = idx >= 0
+    sends = int(valid.sum())
+    held = np.searchsorted(send_t, robot_t, side='right') - 1
+    ref = pos[np.clip(idx[np.clip(held, 0, None)], 0, None)]
+    return ref, sends
+
+
+def reference_upsample(sample_t, arrive_t, pos, rot, robot_t, playout_delay, delay):
+    interpolator = PoseInterpolator(config.UPSAMPLING_MAX_EXTRAPOLATION,
+                                    config.UPSAMPLING_MAX_EXTRAPOLATION_DISTANCE)
+    quats = R.from_rotvec(rot).as_quat()
+    ref = np.zeros((len(robot_t), 3))
+    j = 0
+    for k, t in enumerate(robot_t):
+        while j < len(arrive_t) and arrive_t[j] <= t:
+            # Server maps client stamps with the minimum observed delay
+            interpolator.push(sample_t[j] + delay, pos[j], quats[j])
+            j += 1
+        status, pose = interpolator.sample(t - playout_delay)
+        ref[k] = pose[:3] if status != PoseInterpolator.EMPTY else pos[0]
+    sends = int(((arrive_t >= robot_t[0]) & (arrive_t <= robot_t[-1])).sum())
+    return ref, sends
+
+
+def metrics(ref, robot_t, lag):
+    truth, _ = ground_truth(robot_t - lag)
+    err = np.linalg.norm(ref - truth, axis=1) * 1000
+    dt = robot_t[1] - robot_t[0]
+    jerk = np.diff(ref, n=3, axis=0) / dt ** 3
+    return err.mean(), np.percentile(err, 99), np.sqrt((np.linalg.norm(jerk, axis=1) ** 2).mean())
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Hold-and-resend vs server-side upsampling')
+    parser.add_argument('--duration', type=float, default=20.0)
+    parser.add_argument('--ar-rate', type=float, default=60.0)
+    parser.add_argument('--jitter', type=float, default=0.003, help='AR timestamp jitter (s)')
+    parser.add_argument('--delay', type=float, default=0.010, help='Minimum network delay (s)')
+    parser.add_argument('--delay-jitter', type=float, default=0.005, help='Network delay jitter (s)')
+    parser.add_argument('--seed', type=int, default=0)
+    args = parser.parse_args()
+
+    sample_t, arrive_t, pos, rot = simulate(args.duration, args.ar_rate, args.jitter,
+                                            args.delay, args.delay_jitter, args.seed)
+    robot_t = np.arange(1.0, args.duration - 1.0, 1.0 / config.UPSAMPLING_RATE)
+
+    hold_ref, hold_sends = reference_hold(sample_t, arrive_t, pos, config.CONTROL_FREQUENCY, robot_t)
+    start = time.perf_counter()
+    up_ref, up_sends = reference_upsample(sample_t, arrive_t, pos, rot, robot_t,
+                                          config.UPSAMPLING_PLAYOUT_DELAY, args.delay)
+    per_sample = (time.perf_counter() - start) / len(robot_t) * 1e6
+
+    # Compare each reference against the ground truth at its best-fitting constant lag
+    print(f"AR {args.ar_rate:.0f} Hz -> robot reference {config.UPSAMPLING_RATE} Hz")
+    print("=" * 78)
+    print(f"{'mode':>9} | {'msgs/s':>7} | {'lag ms':>6} | {'mean err mm':>11} | {'p99 err mm':>10} | {'RMS jerk':>10}")
+    print("-" * 78)
+    window = robot_t[-1] - robot_t[0]
+    for name, ref, sends in (("hold", hold_ref, hold_sends), ("upsample", up_ref, up_sends)):
+        lags = np.arange(0.0, 0.08, 0.001)
+        best = min(lags, key=lambda lag: metrics(ref, robot_t, lag)[0])
+        mean_err, p99_err, jerk = metrics(ref, robot_t, best)
+        print(f"{name:>9} | {sends / window:>7.1f} | {best * 1000:>6.1f} | {mean_err:>11.3f} | "
+              f"{p99_err:>10.3f} | {jerk:>10.1f}")
+    print("-" * 78)
+    print(f"Upsampler cost incl. Python/ctypes overhead: {per_sample:.2f} us/sample")
+    print("=" * 78)
+
+
+if __name__ == "__main__":
+    main()
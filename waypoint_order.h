@@ -0,0 +1,402 @@
+// Waypoint reordering for dances where the set of poses matters but not their order
+// (calibration, data collection). Visiting the waypoints in the cycle that minimizes the sum
+// of minimum feasible segment times is a symmetric TSP over joint space. The segment times are
+// precomputed into a dense matrix; the tour is built by nearest neighbour and improved by 2-opt
+// and Or-opt moves (neighbour lists, don't-look bits), iterated with double-bridge kicks. Several
+// independently seeded restarts run in parallel and the best tour wins. Results depend only on
+// the seed and the number of restarts, not on the thread count.
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <map>
+#include <ostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "dance_optimizer.h"
+
+// Dense symmetric matrix of minimum feasible segment times between waypoints
+class SegmentCostMatrix {
+public:
+    // checks are called concurrently from `threads` threads and must be thread-safe
+    SegmentCostMatrix(const std::vector<std::array<double, 7>>& points, const JointLimits& limits,
+                      const std::vector<FeasibilityCheck>& checks = {},
+                      unsigned threads = std::thread::hardware_concurrency())
+        : n_(points.size()), costs_(n_ * n_, 0.0f) {
+        parallelFor(n_, threads, [&](size_t i) {
+            for (size_t j = i + 1; j < n_; j++) {
+                float cost = static_cast<float>(minQuinticTime(points[i], points[j], limits, checks).duration);
+                costs_[i * n_ + j] = cost;
+                costs_[j * n_ + i] = cost;
+            }
+        });
+    }
+
+    // Waypoints with their own move settings: the segment into waypoint j is timed in
+    // timings[j]'s time scaling with checks[j] (one list per waypoint, or none), and costs its
+    // played time, duration / velocity_scale. The tour search is symmetric, so an edge costs the
+    // slower of its two directions; both are only computed when the two ends' timings differ,
+    // so checks must be direction-independent for equal timings (torqueBudgetCheck is).
+    SegmentCostMatrix(const std::vector<std::array<double, 7>>& points, const std::vector<MoveTiming>& timings,
+                      const JointLimits& limits, const std::vector<std::vector<FeasibilityCheck>>& checks,
+                      unsigned threads = std::thread::hardware_concurrency())
+        : n_(points.size()), costs_(n_ * n_, 0.0f) {
+        auto played = [&](size_t from, size_t to) {
+            return moveTime(points, timings, limits, checks, from, to) / timings[to].velocity_scale;
+        };
+        parallelFor(n_, threads, [&](size_t i) {
+            for (size_t j = i + 1; j < n_; j++) {
+                double cost = played(i, j);
+                if (timings[i].scaling != timings[j].scaling ||
+                    timings[i].velocity_scale != timings[j].velocity_scale) {
+                    cost = std::max(cost, played(j, i));
+                }
+                costs_[i * n_ + j] = static_cast<float>(cost);
+                costs_[j * n_ + i] = static_cast<float>(cost);
+            }
+        });
+    }
+
+    // Minimum feasible move time (before the velocity scale) from waypoint `from` to `to`, as the
+    // per-waypoint constructor computes it
+    static double moveTime(const std::vector<std::array<double, 7>>& points, const std::vector<MoveTiming>& timings,
+                           const JointLimits& limits, const std::vector<std::vector<FeasibilityCheck>>& checks,
+                           size_t from, size_t to) {
+        static const std::vector<FeasibilityCheck> kNoChecks;
+        return minQuinticTime(points[from], points[to], limits, checks.empty() ? kNoChecks : checks[to], 1e-3,
+                              timings[to].scaling)
+            .duration;
+    }
+
+    size_t size() const { return n_; }
+    float operator()(size_t i, size_t j) const { return costs_[i * n_ + j]; }
+
+    // Runs body(i) for i in [0, n) on up to `threads` threads, rows interleaved
+    template <typename Body>
+    static void parallelFor(size_t n, unsigned threads, Body&& body) {
+        threads = std::max(1u, std::min<unsigned>(threads, static_cast<unsigned>(std::max<size_t>(n, 1))));
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++) {
+            workers.emplace_back([&, t] {
+                for (size_t i = t; i < n; i += threads) body(i);
+            });
+        }
+        for (size_t i = 0; i < n; i += threads) body(i);
+        for (std::thread& worker : workers) worker.join();
+    }
+
+private:
+    size_t n_;
+    std::vector<float> costs_;
+};
+
+// Sum of segment costs around the closed tour
+inline double tourCost(const SegmentCostMatrix& costs, const std::vector<int>& order) {
+    double total = 0.0;
+    for (size_t k = 0; k < order.size(); k++) {
+        total += costs(order[k], order[(k + 1) % order.size()]);
+    }
+    return total;
+}
+
+struct TourOptions {
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned restarts = 8;   // Independent seeded searches; restart 0 starts from the file-order NN tour
+    size_t kicks = 0;        // Double-bridge kicks per restart (0 = 2 x points, at most 5000)
+    size_t neighbors = 12;   // Candidate list length per waypoint
+    uint64_t seed = 1;
+};
+
+struct TourResult {
+    std::vector<int> order;       // Waypoint indices, starting with 0
+    double cost = 0.0;            // Tour cost of order
+    double identity_cost = 0.0;   // Tour cost of the file order
+    double nearest_neighbor_cost = 0.0;
+    double seconds = 0.0;         // Solve time (neighbour lists + search), excluding the matrix
+};
+
+namespace waypoint_order_detail {
+
+constexpr double kEpsilon = 1e-7;
+
+// Local search state for one restart: tour as an array plus each node's position
+class TourSearch {
+public:
+    TourSearch(const SegmentCostMatrix& costs, const std::vector<std::vector<int>>& neighbors)
+        : costs_(costs), neighbors_(neighbors), n_(costs.size()), pos_(n_), queued_(n_, false) {}
+
+    // With locally_optimal, no node is queued (e.g. when restoring the best tour after a kick)
+    void setTour(std::vector<int> tour, bool locally_optimal = false) {
+        tour_ = std::move(tour);
+        for (size_t k = 0; k < n_; k++) pos_[tour_[k]] = static_cast<int>(k);
+        if (locally_optimal) return;
+        for (size_t k = 0; k < n_; k++) enqueue(tour_[k]);
+    }
+
+    const std::vector<int>& tour() const { return tour_; }
+
+    // 2-opt and Or-opt until no queued node has an improving move
+    void improve() {
+        while (!queue_.empty()) {
+            int a = queue_.front();
+            queue_.pop_front();
+            queued_[a] = false;
+            if (twoOpt(a) || orOpt(a)) enqueue(a);
+        }
+    }
+
+    // Double-bridge: A B C D -> A C B D with random cut points
+    template <typename Rng>
+    void kick(Rng& rng) {
+        std::uniform_int_distribution<size_t> cut(1, n_ - 1);
+        std::array<size_t, 3> cuts;
+        do {
+            cuts = {cut(rng), cut(rng), cut(rng)};
+            std::sort(cuts.begin(), cuts.end());
+        } while (cuts[0] == cuts[1] || cuts[1] == cuts[2]);
+        std::vector<int> kicked;
+        kicked.reserve(n_);
+        kicked.insert(kicked.end(), tour_.begin(), tour_.begin() + cuts[0]);
+        kicked.insert(kicked.end(), tour_.begin() + cuts[1], tour_.begin() + cuts[2]);
+        kicked.insert(kicked.end(), tour_.begin() + cuts[0], tour_.begin() + cuts[1]);
+        kicked.insert(kicked.end(), tour_.begin() + cuts[2], tour_.end());
+        tour_ = std::move(kicked);
+        for (size_t k = 0; k < n_; k++) pos_[tour_[k]] = static_cast<int>(k);
+        for (size_t c : {size_t(0), cuts[0], cuts[1], cuts[2]}) {
+            enqueue(tour_[c]);
+            enqueue(tour_[(c + n_ - 1) % n_]);
+        }
+    }
+
+private:
+    double cost(int a, int b) const { return costs_(a, b); }
+    int next(int a) const { return tour_[(pos_[a] + 1) % n_]; }
+    int prev(int a) const { return tour_[(pos_[a] + n_ - 1) % n_]; }
+
+    void enqueue(int a) {
+        if (!queued_[a]) {
+            queued_[a] = true;
+            queue_.push_back(a);
+        }
+    }
+
+    // Reverses the tour path from node `from` forward to node `to` (or, equivalently for a
+    // symmetric tour, the shorter complementary path)
+    void reverse(int from, int to) {
+        size_t i = pos_[from], j = pos_[to];
+        size_t length = (j + n_ - i) % n_ + 1;
+        if (2 * length > n_) {
+            std::swap(i, j);
+            i = (i + 1) % n_;
+            j = (j + n_ - 1) % n_;
+            length = n_ - length;
+        }
+        for (size_t k = 0; k < length / 2; k++) {
+            size_t p = (i + k) % n_, q = (j + n_ - k) % n_;
+            std::swap(tour_[p], tour_[q]);
+            pos_[tour_[p]] = static_cast<int>(p);
+            pos_[tour_[q]] = static_cast<int>(q);
+        }
+    }
+
+    // Replaces edges (a, succ a) and (c, succ c) by (a, c) and (succ a, succ c), or the same
+    // with predecessors, for c among a's neighbours
+    bool twoOpt(int a) {
+        if (n_ < 4) return false;
+        for (bool forward : {true, false}) {
+            int b = forward ? next(a) : prev(a);
+            double ab = cost(a, b);
+            for (int c : neighbors_[a]) {
+                double gain = ab - cost(a, c);
+                if (gain <= kEpsilon) break;
+                int d = forward ? next(c) : prev(c);
+                if (c == b || d == a) continue;
+                if (gain + cost(c, d) - cost(b, d) > kEpsilon) {
+                    if (forward) {
+                        reverse(b, c);
+                    } else {
+                        reverse(a, d);
+                    }
+                    for (int node : {a, b, c, d}) enqueue(node);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Moves the path of 1-3 nodes starting at a (forward) between a neighbour c and one of its
+    // tour neighbours, in either orientation
+    bool orOpt(int a) {
+        for (size_t length = 1; length <= 3 && n_ >= length + 3; length++) {
+            std::array<int, 3> segment{};
+            segment[0] = a;
+            for (size_t k = 1; k < length; k++) segment[k] = next(segment[k - 1]);
+            int first = a, last = segment[length - 1];
+            int p = prev(first), q = next(last);
+            double removal_gain = cost(p, first) + cost(last, q) - cost(p, q);
+            if (removal_gain <= kEpsilon) continue;
+            auto inSegment = [&](int node) {
+                return std::find(segment.begin(), segment.begin() + length, node) != segment.begin() + length;
+            };
+            for (int end : {first, last}) {
+                for (int c : neighbors_[end]) {
+                    if (cost(end, c) >= removal_gain) break;
+                    if (inSegment(c)) continue;
+                    for (int d : {next(c), prev(c)}) {
+                        if (inSegment(d)) continue;
+                        // Insert between u and v = next(u)
+                        int u = d == next(c) ? c : d, v = d == next(c) ? d : c;
+                        if (u == p && v == q) continue;
+                        double plain = cost(u, first) + cost(last, v) - cost(u, v);
+                        double flipped = cost(u, last) + cost(first, v) - cost(u, v);
+                        bool flip = flipped < plain;
+                        if (removal_gain - std::min(plain, flipped) > kEpsilon) {
+                            moveSegment(segment, length, u, flip);
+                            for (int node : {p, q, u, v, first, last}) enqueue(node);
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    void moveSegment(const std::array<int, 3>& segment, size_t length, int u, bool flip) {
+        std::vector<int> moved;
+        moved.reserve(n_);
+        int node = next(segment[length - 1]);
+        for (size_t k = 0; k < n_ - length; k++, node = next(node)) {
+            moved.push_back(node);
+            if (node == u) {
+                for (size_t s = 0; s < length; s++) moved.push_back(segment[flip ? length - 1 - s : s]);
+            }
+        }
+        tour_ = std::move(moved);
+        for (size_t k = 0; k < n_; k++) pos_[tour_[k]] = static_cast<int>(k);
+    }
+
+    const SegmentCostMatrix& costs_;
+    const std::vector<std::vector<int>>& neighbors_;
+    size_t n_;
+    std::vector<int> tour_;
+    std::vector<int> pos_;
+    std::vector<bool> queued_;
+    std::deque<int> queue_;
+};
+
+inline std::vector<int> nearestNeighborTour(const SegmentCostMatrix& costs, int start) {
+    size_t n = costs.size();
+    std::vector<int> tour{start};
+    std::vector<bool> visited(n, false);
+    visited[start] = true;
+    for (size_t k = 1; k < n; k++) {
+        int current = tour.back(), best = -1;
+        for (size_t j = 0; j < n; j++) {
+            if (!visited[j] && (best < 0 || costs(current, j) < costs(current, best))) best = static_cast<int>(j);
+        }
+        visited[best] = true;
+        tour.push_back(best);
+    }
+    return tour;
+}
+
+}  // namespace waypoint_order_detail
+
+// Finds a short closed tour through all waypoints; the returned order starts at waypoint 0
+inline TourResult optimizeWaypointOrder(const SegmentCostMatrix& costs, const TourOptions& options = {}) {
+    using namespace waypoint_order_detail;
+    auto start = std::chrono::steady_clock::now();
+    size_t n = costs.size();
+    TourResult result;
+    result.order.resize(n);
+    for (size_t k = 0; k < n; k++) result.order[k] = static_cast<int>(k);
+    result.identity_cost = result.cost = tourCost(costs, result.order);
+    if (n < 4) {
+        result.nearest_neighbor_cost = result.cost;
+        return result;
+    }
+
+    // Candidate lists: the closest waypoints by segment time
+    size_t k_neighbors = std::min(options.neighbors, n - 1);
+    std::vector<std::vector<int>> neighbors(n);
+    SegmentCostMatrix::parallelFor(n, options.threads, [&](size_t i) {
+        std::vector<int> others;
+        for (size_t j = 0; j < n; j++) {
+            if (j != i) others.push_back(static_cast<int>(j));
+        }
+        std::partial_sort(others.begin(), others.begin() + k_neighbors, others.end(),
+                          [&](int a, int b) { return costs(i, a) < costs(i, b); });
+        others.resize(k_neighbors);
+        neighbors[i] = std::move(others);
+    });
+
+    size_t kicks = options.kicks ? options.kicks : std::min<size_t>(2 * n, 5000);
+    unsigned restarts = std::max(1u, options.restarts);
+    std::vector<std::vector<int>> tours(restarts);
+    std::vector<double> tour_costs(restarts);
+    SegmentCostMatrix::parallelFor(restarts, options.threads, [&](size_t r) {
+        std::mt19937_64 rng(options.seed + r);
+        int first = r == 0 ? 0 : static_cast<int>(std::uniform_int_distribution<size_t>(0, n - 1)(rng));
+        TourSearch search(costs, neighbors);
+        search.setTour(nearestNeighborTour(costs, first));
+        search.improve();
+        std::vector<int> best = search.tour();
+        double best_cost = tourCost(costs, best);
+        for (size_t kick = 0; n >= 8 && kick < kicks; kick++) {
+            search.kick(rng);
+            search.improve();
+            double kicked_cost = tourCost(costs, search.tour());
+            if (kicked_cost < best_cost - kEpsilon) {
+                best = search.tour();
+                best_cost = kicked_cost;
+            } else {
+                search.setTour(best, true);
+            }
+        }
+        tours[r] = std::move(best);
+        tour_costs[r] = best_cost;
+    });
+    result.nearest_neighbor_cost = tourCost(costs, nearestNeighborTour(costs, 0));
+
+    size_t best = std::min_element(tour_costs.begin(), tour_costs.end()) - tour_costs.begin();
+    if (tour_costs[best] < result.cost) {
+        const std::vector<int>& tour = tours[best];
+        size_t zero = std::find(tour.begin(), tour.end(), 0) - tour.begin();
+        std::rotate_copy(tour.begin(), tour.begin() + zero, tour.end(), result.order.begin());
+        result.cost = tourCost(costs, result.order);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+// Writes a dance config with its moves in `order` (move indices), renumbered from 1, with
+// times[k] as the time of the k-th move. Each move keeps its line (and trailing comment); the
+// comment lines before the first move are kept as the header, other comment lines are dropped.
+inline void writeReorderedMoves(std::istream& in, std::ostream& out, const std::vector<int>& order,
+                                const std::vector<double>& times, int precision = 3) {
+    std::map<int, std::string> move_lines;
+    std::string line;
+    std::array<std::pair<size_t, size_t>, 9> tokens;
+    while (std::getline(in, line)) {
+        if (moveLineTokens(line, tokens)) {
+            move_lines[std::atoi(line.c_str() + tokens[0].first)] = line;
+        } else if (move_lines.empty()) {
+            out << line << '\n';
+        }
+    }
+    for (size_t k = 0; k < order.size(); k++) {
+        line = move_lines.at(order[k]);
+        moveLineTokens(line, tokens);
+        replaceMoveToken(line, tokens, 8, formatMoveTime(times[k], precision));
+        replaceMoveToken(line, tokens, 0, std::to_string(k + 1));
+        out << line << '\n';
+    }
+}